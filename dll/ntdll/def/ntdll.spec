@@ -330,6 +330,7 @@
 @ stdcall NtReleaseMutant(long ptr)
 @ stdcall NtReleaseSemaphore(long long ptr)
 @ stdcall NtRemoveIoCompletion(ptr ptr ptr ptr ptr)
+@ stdcall NtRemoveIoCompletionEx(ptr ptr long ptr ptr long)
 @ stdcall NtRemoveProcessDebug(ptr ptr)
 @ stdcall NtRenameKey(ptr ptr)
 @ stdcall NtReplaceKey(ptr long ptr)
@@ -1175,6 +1176,7 @@
 @ stdcall ZwReleaseMutant(long ptr) NtReleaseMutant
 @ stdcall ZwReleaseSemaphore(long long ptr) NtReleaseSemaphore
 @ stdcall ZwRemoveIoCompletion(ptr ptr ptr ptr ptr) NtRemoveIoCompletion
+@ stdcall ZwRemoveIoCompletionEx(ptr ptr long ptr ptr long) NtRemoveIoCompletionEx
 @ stdcall ZwRemoveProcessDebug(ptr ptr) NtRemoveProcessDebug
 @ stdcall ZwRenameKey(ptr ptr) NtRenameKey
 @ stdcall ZwReplaceKey(ptr long ptr) NtReplaceKey
@@ -70,6 +70,14 @@ RtlpGetMode()
    return UserMode;
 }
 
+ULONG
+NTAPI
+RtlpGetAffinityHint(VOID)
+{
+    /* Querying the current processor needs a system call, use the thread id instead */
+    return HandleToUlong(NtCurrentTeb()->ClientId.UniqueThread) >> 2;
+}
+
 /*
  * @implemented
  */
@@ -6,6 +6,8 @@
 #include <windef.h>
 #include <winbase.h>
 
+#include <ndk/iofuncs.h>
 #include <ndk/kefuncs.h>
 #include <ndk/psfuncs.h>
+#include <ndk/rtlfuncs.h>
 
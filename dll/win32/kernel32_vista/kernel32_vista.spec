@@ -1,2 +1,3 @@
-
+@ stdcall GetQueuedCompletionStatusEx(ptr ptr long ptr long long)
 @ stdcall -ret64 GetTickCount64()
+@ stdcall SetFileCompletionNotificationModes(ptr long)
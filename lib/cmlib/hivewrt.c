@@ -9,6 +9,101 @@
 #define NDEBUG
 #include <debug.h>
 
+/*
+ * Maximum number of blocks copied into the gather buffer for one write,
+ * used for dirty runs whose blocks live in separately allocated bins.
+ */
+#define HV_WRITE_GATHER_BLOCKS 16
+
+static ULONG CMAPI
+HvpFindDirtyRun(
+   PHHIVE RegistryHive,
+   ULONG HintIndex,
+   PULONG RunLength)
+{
+   ULONG BlockIndex;
+   ULONG EndIndex;
+   ULONG Length = RegistryHive->Storage[Stable].Length;
+
+   *RunLength = 0;
+   if (HintIndex >= Length)
+   {
+      return ~0U;
+   }
+
+   BlockIndex = RtlFindSetBits(&RegistryHive->DirtyVector, 1, HintIndex);
+   if (BlockIndex == ~0U || BlockIndex < HintIndex)
+   {
+      return ~0U;
+   }
+
+   /* Extend the run over all following dirty blocks */
+   EndIndex = BlockIndex + 1;
+   while (EndIndex < Length && RtlCheckBit(&RegistryHive->DirtyVector, EndIndex))
+   {
+      EndIndex++;
+   }
+
+   *RunLength = EndIndex - BlockIndex;
+   return BlockIndex;
+}
+
+static BOOLEAN CMAPI
+HvpWriteBlockRun(
+   PHHIVE RegistryHive,
+   ULONG FileType,
+   ULONG FileOffset,
+   ULONG BlockIndex,
+   ULONG BlockCount,
+   PUCHAR GatherBuffer)
+{
+   PHMAP_ENTRY BlockList = RegistryHive->Storage[Stable].BlockList;
+   PUCHAR RunPtr;
+   ULONG RunCount;
+   ULONG GatherCount;
+   ULONG i;
+
+   while (BlockCount != 0)
+   {
+      /* Find how many of the blocks are contiguous in memory as well */
+      RunPtr = (PUCHAR)BlockList[BlockIndex].BlockAddress;
+      RunCount = 1;
+      while (RunCount < BlockCount &&
+             BlockList[BlockIndex + RunCount].BlockAddress ==
+             (ULONG_PTR)(RunPtr + RunCount * HV_BLOCK_SIZE))
+      {
+         RunCount++;
+      }
+
+      /* If the bins break the run up early, gather the blocks into one write */
+      GatherCount = min(BlockCount, HV_WRITE_GATHER_BLOCKS);
+      if (GatherBuffer != NULL && RunCount < GatherCount)
+      {
+         for (i = 0; i < GatherCount; i++)
+         {
+            RtlCopyMemory(GatherBuffer + i * HV_BLOCK_SIZE,
+                          (PVOID)BlockList[BlockIndex + i].BlockAddress,
+                          HV_BLOCK_SIZE);
+         }
+
+         RunPtr = GatherBuffer;
+         RunCount = GatherCount;
+      }
+
+      if (!RegistryHive->FileWrite(RegistryHive, FileType, &FileOffset,
+                                   RunPtr, RunCount * HV_BLOCK_SIZE))
+      {
+         return FALSE;
+      }
+
+      FileOffset += RunCount * HV_BLOCK_SIZE;
+      BlockIndex += RunCount;
+      BlockCount -= RunCount;
+   }
+
+   return TRUE;
+}
+
 static BOOLEAN CMAPI
 HvpWriteLog(
    PHHIVE RegistryHive)
@@ -18,9 +113,9 @@ HvpWriteLog(
    UINT32 BitmapSize;
    PUCHAR Buffer;
    PUCHAR Ptr;
+   PUCHAR GatherBuffer;
    ULONG BlockIndex;
-   ULONG LastIndex;
-   PVOID BlockPtr;
+   ULONG RunLength;
    BOOLEAN Success;
    static ULONG PrintCount = 0;
 
@@ -78,32 +173,33 @@ HvpWriteLog(
       return FALSE;
    }
 
-   /* Write dirty blocks */
+   /* Write dirty blocks, packed one after another in the log */
+   GatherBuffer = RegistryHive->Allocate(HV_WRITE_GATHER_BLOCKS * HV_BLOCK_SIZE,
+                                         TRUE, TAG_CM);
    FileOffset = BufferSize;
-   BlockIndex = 0;
-   while (BlockIndex < RegistryHive->Storage[Stable].Length)
+   BlockIndex = HvpFindDirtyRun(RegistryHive, 0, &RunLength);
+   while (BlockIndex != ~0U)
    {
-      LastIndex = BlockIndex;
-      BlockIndex = RtlFindSetBits(&RegistryHive->DirtyVector, 1, BlockIndex);
-      if (BlockIndex == ~0U || BlockIndex < LastIndex)
+      Success = HvpWriteBlockRun(RegistryHive, HFILE_TYPE_LOG, FileOffset,
+                                 BlockIndex, RunLength, GatherBuffer);
+      if (!Success)
       {
          break;
       }
 
-      BlockPtr = (PVOID)RegistryHive->Storage[Stable].BlockList[BlockIndex].BlockAddress;
+      FileOffset += RunLength * HV_BLOCK_SIZE;
+      BlockIndex = HvpFindDirtyRun(RegistryHive, BlockIndex + RunLength, &RunLength);
+   }
 
-      /* Write hive block */
-      Success = RegistryHive->FileWrite(RegistryHive, HFILE_TYPE_LOG,
-                                        &FileOffset, BlockPtr,
-                                        HV_BLOCK_SIZE);
-      if (!Success)
-      {
-         return FALSE;
-      }
+   if (GatherBuffer != NULL)
+   {
+      RegistryHive->Free(GatherBuffer, 0);
+   }
 
-      BlockIndex++;
-      FileOffset += HV_BLOCK_SIZE;
-    }
+   if (!Success)
+   {
+      return FALSE;
+   }
 
    Success = RegistryHive->FileSetSize(RegistryHive, HFILE_TYPE_LOG, FileOffset, FileOffset);
    if (!Success)
@@ -151,8 +247,8 @@ HvpWriteHive(
 {
    ULONG FileOffset;
    ULONG BlockIndex;
-   ULONG LastIndex;
-   PVOID BlockPtr;
+   ULONG RunLength;
+   PUCHAR GatherBuffer;
    BOOLEAN Success;
 
    ASSERT(RegistryHive->ReadOnly == FALSE);
@@ -183,32 +279,43 @@ HvpWriteHive(
       return FALSE;
    }
 
-   BlockIndex = 0;
-   while (BlockIndex < RegistryHive->Storage[Stable].Length)
+   /* The gather buffer is optional, without it runs are split at bin boundaries */
+   GatherBuffer = RegistryHive->Allocate(HV_WRITE_GATHER_BLOCKS * HV_BLOCK_SIZE,
+                                         TRUE, TAG_CM);
+
+   /* Write hive blocks, one write per run of dirty blocks */
+   if (OnlyDirty)
    {
-      if (OnlyDirty)
-      {
-         LastIndex = BlockIndex;
-         BlockIndex = RtlFindSetBits(&RegistryHive->DirtyVector, 1, BlockIndex);
-         if (BlockIndex == ~0U || BlockIndex < LastIndex)
-         {
-            break;
-         }
-      }
+      BlockIndex = HvpFindDirtyRun(RegistryHive, 0, &RunLength);
+   }
+   else
+   {
+      BlockIndex = 0;
+      RunLength = RegistryHive->Storage[Stable].Length;
+      if (RunLength == 0) BlockIndex = ~0U;
+   }
 
-      BlockPtr = (PVOID)RegistryHive->Storage[Stable].BlockList[BlockIndex].BlockAddress;
+   while (BlockIndex != ~0U)
+   {
       FileOffset = (BlockIndex + 1) * HV_BLOCK_SIZE;
-
-      /* Write hive block */
-      Success = RegistryHive->FileWrite(RegistryHive, HFILE_TYPE_PRIMARY,
-                                        &FileOffset, BlockPtr,
-                                        HV_BLOCK_SIZE);
-      if (!Success)
+      Success = HvpWriteBlockRun(RegistryHive, HFILE_TYPE_PRIMARY, FileOffset,
+                                 BlockIndex, RunLength, GatherBuffer);
+      if (!Success || !OnlyDirty)
       {
-         return FALSE;
+         break;
       }
 
-      BlockIndex++;
+      BlockIndex = HvpFindDirtyRun(RegistryHive, BlockIndex + RunLength, &RunLength);
+   }
+
+   if (GatherBuffer != NULL)
+   {
+      RegistryHive->Free(GatherBuffer, 0);
+   }
+
+   if (!Success)
+   {
+      return FALSE;
    }
 
    Success = RegistryHive->FileFlush(RegistryHive, HFILE_TYPE_PRIMARY, NULL, 0);
@@ -82,36 +82,64 @@ static const parser_state_func parser_funcs[NB_PARSER_STATES] =
 
 /* PRIVATE FUNCTIONS ********************************************************/
 
-static PINFCACHELINE
-InfpFreeLine (PINFCACHELINE Line)
+#define INF_POOL_MIN_SIZE   512
+#define INF_POOL_MAX_SIZE   16384
+#define INF_POOL_ALIGN(x)   (((x) + sizeof(PVOID) - 1) & ~(ULONG)(sizeof(PVOID) - 1))
+
+/* case insensitive, to match the strcmpiW compares */
+static ULONG
+InfpHashName(PCWSTR Name)
 {
-  PINFCACHELINE Next;
-  PINFCACHEFIELD Field;
+  ULONG Hash = 0;
 
-  if (Line == NULL)
+  while (*Name)
     {
-      return NULL;
+      Hash = (Hash * 31) + tolowerW(*Name);
+      Name++;
     }
 
-  Next = Line->Next;
-  if (Line->Key != NULL)
-    {
-      FREE (Line->Key);
-      Line->Key = NULL;
-    }
+  return Hash;
+}
+
+
+/* allocate zeroed memory which lives as long as the section */
+static PVOID
+InfpPoolAllocate(PINFCACHESECTION Section,
+                 ULONG Size)
+{
+  PINFCACHEPOOL Pool = Section->Pool;
+  ULONG PoolSize;
+  PVOID Ptr;
 
-  /* Remove data fields */
-  while (Line->FirstField != NULL)
+  Size = INF_POOL_ALIGN(Size);
+
+  if (Pool == NULL || Pool->Size - Pool->Used < Size)
     {
-      Field = Line->FirstField->Next;
-      FREE (Line->FirstField);
-      Line->FirstField = Field;
+      /* Each new chunk is twice as big as the last, so small sections stay small */
+      PoolSize = (Pool != NULL) ? Pool->Size * 2 : INF_POOL_MIN_SIZE;
+      if (PoolSize > INF_POOL_MAX_SIZE)
+        PoolSize = INF_POOL_MAX_SIZE;
+      if (PoolSize < Size)
+        PoolSize = Size;
+
+      Pool = (PINFCACHEPOOL)MALLOC(INF_POOL_ALIGN(sizeof(INFCACHEPOOL)) + PoolSize);
+      if (Pool == NULL)
+        {
+          DPRINT("MALLOC() failed\n");
+          return NULL;
+        }
+
+      Pool->Size = PoolSize;
+      Pool->Used = 0;
+      Pool->Next = Section->Pool;
+      Section->Pool = Pool;
     }
-  Line->LastField = NULL;
 
-  FREE (Line);
+  Ptr = (PUCHAR)Pool + INF_POOL_ALIGN(sizeof(INFCACHEPOOL)) + Pool->Used;
+  Pool->Used += Size;
+  ZEROMEMORY(Ptr, Size);
 
-  return Next;
+  return Ptr;
 }
 
 
@@ -119,20 +147,29 @@ PINFCACHESECTION
 InfpFreeSection (PINFCACHESECTION Section)
 {
   PINFCACHESECTION Next;
+  PINFCACHEPOOL Pool;
 
   if (Section == NULL)
     {
       return NULL;
     }
 
-  /* Release all keys */
+  /* Release all lines, keys and fields at once */
   Next = Section->Next;
-  while (Section->FirstLine != NULL)
+  while (Section->Pool != NULL)
     {
-      Section->FirstLine = InfpFreeLine (Section->FirstLine);
+      Pool = Section->Pool->Next;
+      FREE (Section->Pool);
+      Section->Pool = Pool;
     }
+  Section->FirstLine = NULL;
   Section->LastLine = NULL;
 
+  if (Section->KeyHash != NULL)
+    {
+      FREE (Section->KeyHash);
+    }
+
   FREE (Section);
 
   return Next;
@@ -150,8 +187,8 @@ InfpFindSection(PINFCACHE Cache,
       return NULL;
     }
 
-  /* iterate through list of sections */
-  Section = Cache->FirstSection;
+  /* iterate through the sections with the same hash */
+  Section = Cache->SectionHash[InfpHashName(Name) % INF_SECTION_HASH_SIZE];
   while (Section != NULL)
     {
       if (strcmpiW(Section->Name, Name) == 0)
@@ -160,7 +197,7 @@ InfpFindSection(PINFCACHE Cache,
         }
 
       /* get the next section*/
-      Section = Section->Next;
+      Section = Section->HashNext;
     }
 
   return NULL;
@@ -173,6 +210,7 @@ InfpAddSection(PINFCACHE Cache,
 {
   PINFCACHESECTION Section = NULL;
   ULONG Size;
+  ULONG Index;
 
   if (Cache == NULL || Name == NULL)
     {
@@ -195,6 +233,11 @@ InfpAddSection(PINFCACHE Cache,
   /* Copy section name */
   strcpyW(Section->Name, Name);
 
+  /* Hash it */
+  Index = InfpHashName(Name) % INF_SECTION_HASH_SIZE;
+  Section->HashNext = Cache->SectionHash[Index];
+  Cache->SectionHash[Index] = Section;
+
   /* Append section */
   if (Cache->FirstSection == NULL)
     {
@@ -223,14 +266,13 @@ InfpAddLine(PINFCACHESECTION Section)
       return NULL;
     }
 
-  Line = (PINFCACHELINE)MALLOC(sizeof(INFCACHELINE));
+  Line = (PINFCACHELINE)InfpPoolAllocate(Section, sizeof(INFCACHELINE));
   if (Line == NULL)
     {
-      DPRINT("MALLOC() failed\n");
+      DPRINT("InfpPoolAllocate() failed\n");
       return NULL;
     }
-  ZEROMEMORY(Line,
-             sizeof(INFCACHELINE));
+  Line->Section = Section;
 
   /* Append line */
   if (Section->FirstLine == NULL)
@@ -266,10 +308,11 @@ InfpAddKeyToLine(PINFCACHELINE Line,
       return NULL;
     }
 
-  Line->Key = (PWCHAR)MALLOC((strlenW(Key) + 1) * sizeof(WCHAR));
+  Line->Key = (PWCHAR)InfpPoolAllocate(Line->Section,
+                                       (ULONG)((strlenW(Key) + 1) * sizeof(WCHAR)));
   if (Line->Key == NULL)
     {
-      DPRINT1("MALLOC() failed\n");
+      DPRINT1("InfpPoolAllocate() failed\n");
       return NULL;
     }
 
@@ -288,14 +331,12 @@ InfpAddFieldToLine(PINFCACHELINE Line,
 
   Size = (ULONG)FIELD_OFFSET(INFCACHEFIELD,
                              Data[strlenW(Data) + 1]);
-  Field = (PINFCACHEFIELD)MALLOC(Size);
+  Field = (PINFCACHEFIELD)InfpPoolAllocate(Line->Section, Size);
   if (Field == NULL)
     {
-      DPRINT1("MALLOC() failed\n");
+      DPRINT1("InfpPoolAllocate() failed\n");
       return NULL;
     }
-  ZEROMEMORY (Field,
-              Size);
   strcpyW(Field->Data, Data);
 
   /* Append key */
@@ -316,12 +357,82 @@ InfpAddFieldToLine(PINFCACHELINE Line,
 }
 
 
+/* add the lines appended since the last lookup to the key table */
+static BOOLEAN
+InfpUpdateKeyHash(PINFCACHESECTION Section)
+{
+  PINFCACHELINE Line, Other;
+  PINFCACHELINE *Bucket;
+  ULONG Size;
+
+  /* Keep at most two lines per bucket, rebuilding the table as it grows */
+  if (Section->KeyHashSize < (ULONG)Section->LineCount / 2)
+    {
+      Size = 64;
+      while (Size < (ULONG)Section->LineCount)
+        Size *= 2;
+
+      Bucket = (PINFCACHELINE *)MALLOC(Size * sizeof(PINFCACHELINE));
+      if (Bucket == NULL)
+        return FALSE;
+      ZEROMEMORY(Bucket, Size * sizeof(PINFCACHELINE));
+
+      if (Section->KeyHash != NULL)
+        FREE(Section->KeyHash);
+      Section->KeyHash = Bucket;
+      Section->KeyHashSize = Size;
+      Section->LastHashedLine = NULL;
+    }
+
+  Line = (Section->LastHashedLine != NULL) ? Section->LastHashedLine->Next
+                                           : Section->FirstLine;
+  for (; Line != NULL; Line = Line->Next)
+    {
+      Section->LastHashedLine = Line;
+      if (Line->Key == NULL)
+        continue;
+
+      /* The first line with a given key wins, like in the list */
+      Bucket = &Section->KeyHash[InfpHashName(Line->Key) & (Section->KeyHashSize - 1)];
+      for (Other = *Bucket; Other != NULL; Other = Other->HashNext)
+        {
+          if (strcmpiW(Other->Key, Line->Key) == 0)
+            break;
+        }
+
+      if (Other == NULL)
+        {
+          Line->HashNext = *Bucket;
+          *Bucket = Line;
+        }
+    }
+
+  return TRUE;
+}
+
+
 PINFCACHELINE
 InfpFindKeyLine(PINFCACHESECTION Section,
                 PCWSTR Key)
 {
   PINFCACHELINE Line;
 
+  if (Section->LineCount >= INF_KEY_HASH_THRESHOLD && InfpUpdateKeyHash(Section))
+    {
+      Line = Section->KeyHash[InfpHashName(Key) & (Section->KeyHashSize - 1)];
+      while (Line != NULL)
+        {
+          if (strcmpiW(Line->Key, Key) == 0)
+            {
+              return Line;
+            }
+
+          Line = Line->HashNext;
+        }
+
+      return NULL;
+    }
+
   Line = Section->FirstLine;
   while (Line != NULL)
     {
@@ -18,6 +18,16 @@
 #define INF_STATUS_WRONG_INF_STYLE         ((INFSTATUS)0xC0700003)
 #define INF_STATUS_NOT_ENOUGH_MEMORY       ((INFSTATUS)0xC0700004)
 
+#define INF_SECTION_HASH_SIZE   128  /* buckets in the per-file section table */
+#define INF_KEY_HASH_THRESHOLD  16   /* smaller sections are just scanned */
+
+typedef struct _INFCACHEPOOL
+{
+  struct _INFCACHEPOOL *Next;
+  ULONG Size;
+  ULONG Used;
+} INFCACHEPOOL, *PINFCACHEPOOL;
+
 typedef struct _INFCACHEFIELD
 {
   struct _INFCACHEFIELD *Next;
@@ -30,6 +40,8 @@ typedef struct _INFCACHELINE
 {
   struct _INFCACHELINE *Next;
   struct _INFCACHELINE *Prev;
+  struct _INFCACHELINE *HashNext;
+  struct _INFCACHESECTION *Section;
 
   LONG FieldCount;
 
@@ -45,11 +57,21 @@ typedef struct _INFCACHESECTION
   struct _INFCACHESECTION *Next;
   struct _INFCACHESECTION *Prev;
 
+  struct _INFCACHESECTION *HashNext;
+
   PINFCACHELINE FirstLine;
   PINFCACHELINE LastLine;
 
   LONG LineCount;
 
+  /* Lines, keys and fields are carved out of these */
+  PINFCACHEPOOL Pool;
+
+  /* Key lookup table, built on the first lookup in a big section */
+  PINFCACHELINE *KeyHash;
+  ULONG KeyHashSize;
+  PINFCACHELINE LastHashedLine;
+
   WCHAR Name[1];
 } INFCACHESECTION, *PINFCACHESECTION;
 
@@ -60,6 +82,8 @@ typedef struct _INFCACHE
   PINFCACHESECTION LastSection;
 
   PINFCACHESECTION StringsSection;
+
+  PINFCACHESECTION SectionHash[INF_SECTION_HASH_SIZE];
 } INFCACHE, *PINFCACHE;
 
 typedef struct _INFCONTEXT
@@ -18,11 +18,212 @@
 #define COMPRESSION_FORMAT_MASK  0x00FF
 #define COMPRESSION_ENGINE_MASK  0xFF00
 
+/* LZNT1 always works on 4KB chunks, each preceded by a 16-bit header */
+#define LZNT1_CHUNK_SIZE         0x1000
+#define LZNT1_CHUNK_SIZE_MASK    0x0FFF
+#define LZNT1_CHUNK_SIGNATURE    0x3000
+#define LZNT1_CHUNK_COMPRESSED   0x8000
+#define LZNT1_MIN_MATCH          3
+
+/* The standard engine keeps hash chains in the workspace */
+#define LZNT1_HASH_BITS          12
+#define LZNT1_HASH_SIZE          (1 << LZNT1_HASH_BITS)
+#define LZNT1_HASH_NONE          0xFFFF
+#define LZNT1_STANDARD_DEPTH     16
+
+typedef struct _LZNT1_WORKSPACE
+{
+    USHORT Head[LZNT1_HASH_SIZE];
+    USHORT Prev[LZNT1_CHUNK_SIZE];
+} LZNT1_WORKSPACE, *PLZNT1_WORKSPACE;
 
+C_ASSERT(sizeof(LZNT1_WORKSPACE) <= 0x8010);
 
 
 /* FUNCTIONS ****************************************************************/
 
+static USHORT
+RtlpDisplacementBitsLZNT1(ULONG Position)
+{
+    USHORT Bits = 4;
+
+    /* The further into the chunk, the more bits are spent on the displacement */
+    for (Position--; Position >= 0x10; Position >>= 1)
+        Bits++;
+
+    return Bits;
+}
+
+static ULONG
+RtlpHashLZNT1(PUCHAR Data)
+{
+    return ((Data[0] << 8) ^ (Data[1] << 4) ^ Data[2]) & (LZNT1_HASH_SIZE - 1);
+}
+
+static ULONG
+RtlpMatchLengthLZNT1(PUCHAR Data,
+                     PUCHAR Candidate,
+                     ULONG MaxLength)
+{
+    ULONG Length = 0;
+
+    while (Length < MaxLength && Data[Length] == Candidate[Length])
+        Length++;
+
+    return Length;
+}
+
+static VOID
+RtlpInsertHashLZNT1(PLZNT1_WORKSPACE WorkSpace,
+                    PUCHAR Chunk,
+                    ULONG ChunkSize,
+                    ULONG Position)
+{
+    ULONG Hash;
+
+    if (Position + LZNT1_MIN_MATCH > ChunkSize)
+        return;
+
+    Hash = RtlpHashLZNT1(Chunk + Position);
+    WorkSpace->Prev[Position] = WorkSpace->Head[Hash];
+    WorkSpace->Head[Hash] = (USHORT)Position;
+}
+
+static ULONG
+RtlpFindMatchLZNT1(USHORT Engine,
+                   PLZNT1_WORKSPACE WorkSpace,
+                   PUCHAR Chunk,
+                   ULONG Position,
+                   ULONG MaxLength,
+                   PULONG Displacement)
+{
+    ULONG BestLength = 0, Length, Candidate, Depth;
+
+    if (Engine == COMPRESSION_ENGINE_MAXIMUM)
+    {
+        /* Look at every earlier position in the chunk, nearest first */
+        for (Candidate = Position; Candidate-- > 0; )
+        {
+            Length = RtlpMatchLengthLZNT1(Chunk + Position, Chunk + Candidate, MaxLength);
+            if (Length > BestLength)
+            {
+                BestLength = Length;
+                *Displacement = Position - Candidate;
+                if (Length == MaxLength) break;
+            }
+        }
+
+        return BestLength;
+    }
+
+    /* Follow the hash chain of this position, up to a fixed depth */
+    Candidate = WorkSpace->Head[RtlpHashLZNT1(Chunk + Position)];
+    for (Depth = 0;
+         Candidate != LZNT1_HASH_NONE && Depth < LZNT1_STANDARD_DEPTH;
+         Candidate = WorkSpace->Prev[Candidate], Depth++)
+    {
+        ASSERT(Candidate < Position);
+
+        /* Cheap check on the byte that would extend the best match */
+        if (Chunk[Candidate + BestLength] != Chunk[Position + BestLength])
+            continue;
+
+        Length = RtlpMatchLengthLZNT1(Chunk + Position, Chunk + Candidate, MaxLength);
+        if (Length > BestLength)
+        {
+            BestLength = Length;
+            *Displacement = Position - Candidate;
+            if (Length == MaxLength) break;
+        }
+    }
+
+    return BestLength;
+}
+
+/* Returns the size of the compressed chunk with its header, or 0 if it
+   doesn't fit in MaxSize bytes */
+static ULONG
+RtlpCompressChunkLZNT1(USHORT Engine,
+                       PUCHAR Chunk,
+                       ULONG ChunkSize,
+                       PUCHAR CompressedChunk,
+                       ULONG MaxSize,
+                       PLZNT1_WORKSPACE WorkSpace)
+{
+    ULONG Position = 0, Output = 2, FlagOffset = 0, Length, Displacement = 0, MaxLength, i;
+    USHORT DisplacementBits, Token;
+    UCHAR FlagBit = 8;
+
+    ASSERT(ChunkSize <= LZNT1_CHUNK_SIZE);
+
+    if (Engine == COMPRESSION_ENGINE_STANDARD)
+        RtlFillMemory(WorkSpace->Head, sizeof(WorkSpace->Head), 0xFF);
+
+    while (Position < ChunkSize)
+    {
+        /* Start a new group of 8 tokens */
+        if (FlagBit == 8)
+        {
+            if (Output >= MaxSize) return 0;
+            FlagOffset = Output++;
+            CompressedChunk[FlagOffset] = 0;
+            FlagBit = 0;
+        }
+
+        Length = 0;
+        if (Position > 0 && Position + LZNT1_MIN_MATCH <= ChunkSize)
+        {
+            DisplacementBits = RtlpDisplacementBitsLZNT1(Position);
+            MaxLength = (1 << (16 - DisplacementBits)) - 1 + LZNT1_MIN_MATCH;
+            MaxLength = min(MaxLength, ChunkSize - Position);
+
+            Length = RtlpFindMatchLZNT1(Engine,
+                                        WorkSpace,
+                                        Chunk,
+                                        Position,
+                                        MaxLength,
+                                        &Displacement);
+        }
+
+        if (Length >= LZNT1_MIN_MATCH)
+        {
+            /* Emit a back reference */
+            if (Output + 2 > MaxSize) return 0;
+
+            DisplacementBits = RtlpDisplacementBitsLZNT1(Position);
+            Token = (USHORT)(((Displacement - 1) << (16 - DisplacementBits)) |
+                             (Length - LZNT1_MIN_MATCH));
+            CompressedChunk[Output++] = LOBYTE(Token);
+            CompressedChunk[Output++] = HIBYTE(Token);
+            CompressedChunk[FlagOffset] |= 1 << FlagBit;
+        }
+        else
+        {
+            /* Emit a literal */
+            if (Output >= MaxSize) return 0;
+
+            CompressedChunk[Output++] = Chunk[Position];
+            Length = 1;
+        }
+
+        if (Engine == COMPRESSION_ENGINE_STANDARD)
+        {
+            for (i = 0; i < Length; i++)
+                RtlpInsertHashLZNT1(WorkSpace, Chunk, ChunkSize, Position + i);
+        }
+
+        Position += Length;
+        FlagBit++;
+    }
+
+    /* Write the chunk header */
+    Token = (USHORT)(LZNT1_CHUNK_COMPRESSED | LZNT1_CHUNK_SIGNATURE | ((Output - 3) & LZNT1_CHUNK_SIZE_MASK));
+    CompressedChunk[0] = LOBYTE(Token);
+    CompressedChunk[1] = HIBYTE(Token);
+
+    return Output;
+}
+
 
 static NTSTATUS
 RtlpCompressBufferLZNT1(USHORT Engine,
@@ -34,8 +235,66 @@ RtlpCompressBufferLZNT1(USHORT Engine,
                         PULONG FinalCompressedSize,
                         PVOID WorkSpace)
 {
-    UNIMPLEMENTED;
-    return STATUS_NOT_IMPLEMENTED;
+    PUCHAR Source = UncompressedBuffer, SourceEnd = UncompressedBuffer + UncompressedBufferSize;
+    PUCHAR Destination = CompressedBuffer, DestinationEnd = CompressedBuffer + CompressedBufferSize;
+    ULONG ChunkSize, CompressedSize, MaxSize, i;
+    BOOLEAN AllZeros = TRUE;
+    USHORT Header;
+
+    /* LZNT1 chunks are always 4KB, whatever the caller asked for */
+    UNREFERENCED_PARAMETER(UncompressedChunkSize);
+
+    if (Engine != COMPRESSION_ENGINE_STANDARD &&
+        Engine != COMPRESSION_ENGINE_MAXIMUM)
+    {
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    while (Source < SourceEnd)
+    {
+        ChunkSize = (ULONG)min(SourceEnd - Source, LZNT1_CHUNK_SIZE);
+
+        /* Keep track of whether the whole buffer is zeroed */
+        for (i = 0; AllZeros && i < ChunkSize; i++)
+        {
+            if (Source[i]) AllZeros = FALSE;
+        }
+
+        /* A compressed chunk must be smaller than a stored one */
+        MaxSize = (ULONG)min(DestinationEnd - Destination, ChunkSize + 1);
+        CompressedSize = RtlpCompressChunkLZNT1(Engine,
+                                                Source,
+                                                ChunkSize,
+                                                Destination,
+                                                MaxSize,
+                                                WorkSpace);
+        if (!CompressedSize)
+        {
+            /* Store it uncompressed */
+            if ((ULONG)(DestinationEnd - Destination) < ChunkSize + 2)
+                return STATUS_BUFFER_TOO_SMALL;
+
+            Header = (USHORT)(LZNT1_CHUNK_SIGNATURE | (ChunkSize - 1));
+            Destination[0] = LOBYTE(Header);
+            Destination[1] = HIBYTE(Header);
+            RtlCopyMemory(Destination + 2, Source, ChunkSize);
+            CompressedSize = ChunkSize + 2;
+        }
+
+        Destination += CompressedSize;
+        Source += ChunkSize;
+    }
+
+    /* Terminate the chunk list if there is room, it isn't part of the size */
+    if (DestinationEnd - Destination >= 2)
+    {
+        Destination[0] = 0;
+        Destination[1] = 0;
+    }
+
+    *FinalCompressedSize = (ULONG)(Destination - CompressedBuffer);
+
+    return AllZeros ? STATUS_BUFFER_ALL_ZEROS : STATUS_SUCCESS;
 }
 
 
@@ -1561,6 +1561,9 @@ RtlDestroyHeap(HANDLE HeapPtr) /* [in] Handle of heap */
                             MEM_RELEASE);
     }
 
+    /* Release the front end heap */
+    RtlpDestroyLowFragHeap(Heap);
+
     /* Delete tags and remove heap from the process heaps list in user mode */
     if (RtlpGetMode() == UserMode)
     {
@@ -1912,6 +1915,7 @@ RtlAllocateHeap(IN PVOID HeapPtr,
     BOOLEAN HeapLocked = FALSE;
     PHEAP_VIRTUAL_ALLOC_ENTRY VirtualBlock = NULL;
     PHEAP_ENTRY_EXTRA Extra;
+    PVOID UserBlock;
     NTSTATUS Status;
 
     /* Force flags */
@@ -1962,6 +1966,17 @@ RtlAllocateHeap(IN PVOID HeapPtr,
 
     Index = AllocationSize >>  HEAP_ENTRY_SHIFT;
 
+    /* Small blocks without extra stuff come from the front end heap, which needs no lock */
+    if (Heap->FrontEndHeap &&
+        Index <= HEAP_LFH_BUCKETS &&
+        !(EntryFlags & HEAP_ENTRY_EXTRA_PRESENT))
+    {
+        UserBlock = RtlpLowFragHeapAlloc(Heap, Flags, Size, Index, EntryFlags);
+        if (UserBlock) return UserBlock;
+
+        /* Fall back to the back end if it couldn't grow */
+    }
+
     /* Acquire the lock if necessary */
     if (!(Flags & HEAP_NO_SERIALIZE))
     {
@@ -2164,6 +2179,13 @@ BOOLEAN NTAPI RtlFreeHeap(
     if (RtlpHeapIsSpecial(Flags))
         return RtlDebugFreeHeap(Heap, Flags, Ptr);
 
+    /* Get pointer to the heap entry */
+    HeapEntry = (PHEAP_ENTRY)Ptr - 1;
+
+    /* Front end heap blocks are freed without the heap lock */
+    if (RtlpIsLowFragHeapEntry(Heap, HeapEntry))
+        return RtlpLowFragHeapFree(Heap, HeapEntry);
+
     /* Lock if necessary */
     if (!(Flags & HEAP_NO_SERIALIZE))
     {
@@ -2171,9 +2193,6 @@ BOOLEAN NTAPI RtlFreeHeap(
         Locked = TRUE;
     }
 
-    /* Get pointer to the heap entry */
-    HeapEntry = (PHEAP_ENTRY)Ptr - 1;
-
     /* Check this entry, fail if it's invalid */
     if (!(HeapEntry->Flags & HEAP_ENTRY_BUSY) ||
         (((ULONG_PTR)Ptr & 0x7) != 0) ||
@@ -2589,6 +2608,16 @@ RtlReAllocateHeap(HANDLE HeapPtr,
         AllocationSize += sizeof(HEAP_ENTRY_EXTRA);
     }
 
+    /* Front end heap blocks are handled without the heap lock */
+    if (RtlpIsLowFragHeapEntry(Heap, (PHEAP_ENTRY)Ptr - 1))
+    {
+        return RtlpLowFragHeapReAlloc(Heap,
+                                      Flags,
+                                      (PHEAP_ENTRY)Ptr - 1,
+                                      Size,
+                                      AllocationSize >> HEAP_ENTRY_SHIFT);
+    }
+
     /* Acquire the lock if necessary */
     if (!(Flags & HEAP_NO_SERIALIZE))
     {
@@ -3061,8 +3090,12 @@ RtlSizeHeap(
         return (SIZE_T)-1;
     }
 
-    /* Get size of this block depending if it's a usual or a big one */
-    if (HeapEntry->Flags & HEAP_ENTRY_VIRTUAL_ALLOC)
+    /* Get size of this block depending if it's a usual, a front end or a big one */
+    if (RtlpIsLowFragHeapEntry(Heap, HeapEntry))
+    {
+        EntrySize = RtlpLowFragHeapSize(HeapEntry);
+    }
+    else if (HeapEntry->Flags & HEAP_ENTRY_VIRTUAL_ALLOC)
     {
         EntrySize = RtlpGetSizeOfBigBlock(HeapEntry);
     }
@@ -3129,6 +3162,13 @@ RtlpValidateHeapEntry(
     if ((ULONG_PTR)HeapEntry & (HEAP_ENTRY_SIZE - 1)) goto invalid_entry;
     if (!(HeapEntry->Flags & HEAP_ENTRY_BUSY)) goto invalid_entry;
 
+    /* Front end heap blocks live inside busy back end blocks */
+    if (RtlpIsLowFragHeapEntry(Heap, HeapEntry))
+    {
+        if (!RtlpValidateLowFragHeapEntry(Heap, HeapEntry)) goto invalid_entry;
+        return TRUE;
+    }
+
     BigAllocation = HeapEntry->Flags & HEAP_ENTRY_VIRTUAL_ALLOC;
     Segment = Heap->Segments[HeapEntry->SegmentOffset];
 
@@ -3898,8 +3938,10 @@ RtlSetHeapInformation(IN HANDLE HeapHandle OPTIONAL,
             return STATUS_UNSUCCESSFUL;
         }
 
-        DPRINT1("RtlSetHeapInformation() needs to enable LFH\n");
-        return STATUS_SUCCESS;
+        /* There is no default heap to fall back to */
+        if (!HeapHandle) return STATUS_INVALID_PARAMETER;
+
+        return RtlpActivateLowFragHeap((PHEAP)HeapHandle);
     }
 
     return STATUS_SUCCESS;
@@ -55,6 +55,16 @@
 /* Segment flags */
 #define HEAP_USER_ALLOCATED    0x1
 
+/* Low fragmentation front end heap */
+#define HEAP_FRONT_END_LFH       2
+#define HEAP_LFH_BUCKETS         128
+#define HEAP_LFH_AFFINITY_SLOTS  4
+#define HEAP_LFH_MIN_SUBSEGMENT  0x1000
+#define HEAP_LFH_MAX_SUBSEGMENT  0x10000
+
+/* LFHFlags value marking a block owned by the front end heap */
+#define HEAP_ENTRY_LFH_BLOCK     0x80
+
 /* A handy inline to distinguis normal heap, special "debug heap" and special "page heap" */
 FORCEINLINE BOOLEAN
 RtlpHeapIsSpecial(ULONG Flags)
@@ -327,6 +337,35 @@ typedef struct _HEAP_VIRTUAL_ALLOC_ENTRY
     HEAP_ENTRY BusyBlock;
 } HEAP_VIRTUAL_ALLOC_ENTRY, *PHEAP_VIRTUAL_ALLOC_ENTRY;
 
+/* One free list per affinity slot, each on its own cache line */
+typedef struct _HEAP_LFH_SLOT
+{
+    DECLSPEC_CACHEALIGN SLIST_HEADER FreeList;
+} HEAP_LFH_SLOT, *PHEAP_LFH_SLOT;
+
+typedef struct _HEAP_LFH_BUCKET
+{
+    HEAP_LFH_SLOT Slots[HEAP_LFH_AFFINITY_SLOTS];
+    ULONG SubSegmentSize;
+    ULONG SubSegments;
+    ULONG TotalBlocks;
+} HEAP_LFH_BUCKET, *PHEAP_LFH_BUCKET;
+
+typedef struct _HEAP_LFH
+{
+    HEAP_LFH_BUCKET Buckets[HEAP_LFH_BUCKETS];
+} HEAP_LFH, *PHEAP_LFH;
+
+/* Largest front end block must be served by a single subsegment */
+C_ASSERT((HEAP_LFH_BUCKETS << HEAP_ENTRY_SHIFT) < HEAP_LFH_MIN_SUBSEGMENT);
+
+FORCEINLINE BOOLEAN
+RtlpIsLowFragHeapEntry(PHEAP Heap, PHEAP_ENTRY HeapEntry)
+{
+    return (Heap->FrontEndHeap != NULL) &&
+           (HeapEntry->LFHFlags == HEAP_ENTRY_LFH_BLOCK);
+}
+
 /* Global variables */
 extern RTL_CRITICAL_SECTION RtlpProcessHeapsListLock;
 extern BOOLEAN RtlpPageHeapEnabled;
@@ -352,6 +391,38 @@ RtlpValidateHeapEntry(PHEAP Heap, PHEAP_ENTRY HeapEntry);
 BOOLEAN NTAPI
 RtlpValidateHeapHeaders(PHEAP Heap, BOOLEAN Recalculate);
 
+/* heaplfh.c */
+NTSTATUS NTAPI
+RtlpActivateLowFragHeap(PHEAP Heap);
+
+VOID NTAPI
+RtlpDestroyLowFragHeap(PHEAP Heap);
+
+PVOID NTAPI
+RtlpLowFragHeapAlloc(PHEAP Heap,
+                     ULONG Flags,
+                     SIZE_T Size,
+                     SIZE_T Index,
+                     UCHAR EntryFlags);
+
+BOOLEAN NTAPI
+RtlpLowFragHeapFree(PHEAP Heap,
+                    PHEAP_ENTRY HeapEntry);
+
+PVOID NTAPI
+RtlpLowFragHeapReAlloc(PHEAP Heap,
+                       ULONG Flags,
+                       PHEAP_ENTRY InUseEntry,
+                       SIZE_T Size,
+                       SIZE_T Index);
+
+SIZE_T NTAPI
+RtlpLowFragHeapSize(PHEAP_ENTRY HeapEntry);
+
+BOOLEAN NTAPI
+RtlpValidateLowFragHeapEntry(PHEAP Heap,
+                             PHEAP_ENTRY HeapEntry);
+
 /* heapdbg.c */
 HANDLE NTAPI
 RtlDebugCreateHeap(ULONG Flags,
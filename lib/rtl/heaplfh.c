@@ -0,0 +1,323 @@
+/*
+ * PROJECT:         ReactOS Runtime Library
+ * LICENSE:         GPL - See COPYING in the top level directory
+ * FILE:            lib/rtl/heaplfh.c
+ * PURPOSE:         Low fragmentation front end heap
+ */
+
+/* Small blocks are grouped into buckets of one size each (in heap entry
+   units). Each bucket carves its blocks out of subsegments, which are
+   ordinary busy blocks of the back end heap, and keeps the free ones in
+   interlocked singly linked lists, one per affinity slot. Allocating and
+   freeing a block therefore never takes the heap lock, only refilling a
+   bucket with a new subsegment does. Subsegments stay allocated until the
+   heap is destroyed, so a block can never be popped from a free list while
+   its memory is being released. */
+
+/* INCLUDES ******************************************************************/
+
+#include <rtl.h>
+#include <heap.h>
+
+#define NDEBUG
+#include <debug.h>
+
+/* FUNCTIONS ******************************************************************/
+
+FORCEINLINE
+PHEAP_LFH_SLOT
+RtlpGetLowFragHeapSlot(PHEAP_LFH_BUCKET Bucket, ULONG Index)
+{
+    return &Bucket->Slots[Index & (HEAP_LFH_AFFINITY_SLOTS - 1)];
+}
+
+NTSTATUS NTAPI
+RtlpActivateLowFragHeap(PHEAP Heap)
+{
+    PHEAP_LFH FrontEndHeap = NULL;
+    SIZE_T Size = sizeof(HEAP_LFH);
+    ULONG Bucket, Slot;
+    NTSTATUS Status;
+
+    /* The front end heap can't keep tail, fill or alignment guarantees */
+    if ((Heap->Flags & (HEAP_NO_SERIALIZE |
+                        HEAP_TAIL_CHECKING_ENABLED |
+                        HEAP_FREE_CHECKING_ENABLED |
+                        HEAP_CREATE_ALIGN_16)) ||
+        RtlpHeapIsSpecial(Heap->Flags))
+    {
+        return STATUS_UNSUCCESSFUL;
+    }
+
+    /* Nothing to do if it's already there */
+    if (Heap->FrontEndHeap) return STATUS_SUCCESS;
+
+    /* Reserve and commit memory for the buckets */
+    Status = ZwAllocateVirtualMemory(NtCurrentProcess(),
+                                     (PVOID *)&FrontEndHeap,
+                                     0,
+                                     &Size,
+                                     MEM_RESERVE | MEM_COMMIT,
+                                     PAGE_READWRITE);
+    if (!NT_SUCCESS(Status))
+    {
+        DPRINT1("HEAP: Failed to allocate the front end heap with status 0x%08x\n", Status);
+        return Status;
+    }
+
+    /* Initialize the buckets */
+    for (Bucket = 0; Bucket < HEAP_LFH_BUCKETS; Bucket++)
+    {
+        for (Slot = 0; Slot < HEAP_LFH_AFFINITY_SLOTS; Slot++)
+            RtlInitializeSListHead(&FrontEndHeap->Buckets[Bucket].Slots[Slot].FreeList);
+
+        FrontEndHeap->Buckets[Bucket].SubSegmentSize = HEAP_LFH_MIN_SUBSEGMENT;
+    }
+
+    /* Publish it, unless somebody else was faster */
+    if (InterlockedCompareExchangePointer(&Heap->FrontEndHeap, FrontEndHeap, NULL) != NULL)
+    {
+        Size = 0;
+        ZwFreeVirtualMemory(NtCurrentProcess(),
+                            (PVOID *)&FrontEndHeap,
+                            &Size,
+                            MEM_RELEASE);
+        return STATUS_SUCCESS;
+    }
+
+    Heap->FrontEndHeapType = HEAP_FRONT_END_LFH;
+
+    DPRINT("Activated the low fragmentation heap %p for heap %p\n", FrontEndHeap, Heap);
+    return STATUS_SUCCESS;
+}
+
+VOID NTAPI
+RtlpDestroyLowFragHeap(PHEAP Heap)
+{
+    PVOID BaseAddress = Heap->FrontEndHeap;
+    SIZE_T Size = 0;
+
+    if (!BaseAddress) return;
+
+    /* Subsegments live in the heap segments, only the buckets need to go */
+    Heap->FrontEndHeap = NULL;
+    Heap->FrontEndHeapType = 0;
+
+    ZwFreeVirtualMemory(NtCurrentProcess(),
+                        &BaseAddress,
+                        &Size,
+                        MEM_RELEASE);
+}
+
+static
+PHEAP_ENTRY
+RtlpLowFragHeapRefill(PHEAP Heap,
+                      ULONG Flags,
+                      PHEAP_LFH_BUCKET Bucket,
+                      PHEAP_LFH_SLOT Slot,
+                      SIZE_T Index)
+{
+    SIZE_T BlockSize = Index << HEAP_ENTRY_SHIFT;
+    ULONG SubSegmentSize, BlockCount, i;
+    PHEAP_ENTRY SubSegment, Block;
+
+    /* Grab a new subsegment from the back end heap */
+    SubSegmentSize = Bucket->SubSegmentSize;
+    SubSegment = RtlAllocateHeap(Heap, Flags & HEAP_NO_SERIALIZE, SubSegmentSize);
+    if (!SubSegment) return NULL;
+
+    /* Let the next one be bigger if this bucket is busy */
+    if (SubSegmentSize < HEAP_LFH_MAX_SUBSEGMENT)
+        Bucket->SubSegmentSize = SubSegmentSize * 2;
+
+    BlockCount = (ULONG)(SubSegmentSize / BlockSize);
+    InterlockedIncrement((PLONG)&Bucket->SubSegments);
+    InterlockedExchangeAdd((PLONG)&Bucket->TotalBlocks, BlockCount);
+
+    /* Carve it into free blocks, keep the first one for the caller */
+    for (i = 0; i < BlockCount; i++)
+    {
+        Block = (PHEAP_ENTRY)((ULONG_PTR)SubSegment + i * BlockSize);
+
+        Block->Size = (USHORT)Index;
+        Block->Flags = 0;
+        Block->SmallTagIndex = 0;
+        Block->UnusedBytesLength = 0;
+        Block->LFHFlags = HEAP_ENTRY_LFH_BLOCK;
+        Block->UnusedBytes = 0;
+
+        if (i) RtlInterlockedPushEntrySList(&Slot->FreeList, (PSLIST_ENTRY)(Block + 1));
+    }
+
+    return SubSegment;
+}
+
+PVOID NTAPI
+RtlpLowFragHeapAlloc(PHEAP Heap,
+                     ULONG Flags,
+                     SIZE_T Size,
+                     SIZE_T Index,
+                     UCHAR EntryFlags)
+{
+    PHEAP_LFH FrontEndHeap = Heap->FrontEndHeap;
+    PHEAP_LFH_BUCKET Bucket;
+    PSLIST_ENTRY ListEntry = NULL;
+    PHEAP_ENTRY InUseEntry;
+    ULONG Hint, i;
+
+    ASSERT(Index > 0 && Index <= HEAP_LFH_BUCKETS);
+    Bucket = &FrontEndHeap->Buckets[Index - 1];
+
+    /* Try our own slot first, then steal from the others */
+    Hint = RtlpGetAffinityHint();
+    for (i = 0; i < HEAP_LFH_AFFINITY_SLOTS && !ListEntry; i++)
+        ListEntry = RtlInterlockedPopEntrySList(&RtlpGetLowFragHeapSlot(Bucket, Hint + i)->FreeList);
+
+    if (ListEntry)
+    {
+        InUseEntry = (PHEAP_ENTRY)ListEntry - 1;
+    }
+    else
+    {
+        /* All slots are empty, refill ours */
+        InUseEntry = RtlpLowFragHeapRefill(Heap,
+                                           Flags,
+                                           Bucket,
+                                           RtlpGetLowFragHeapSlot(Bucket, Hint),
+                                           Index);
+        if (!InUseEntry) return NULL;
+    }
+
+    ASSERT(!(InUseEntry->Flags & HEAP_ENTRY_BUSY));
+    ASSERT(InUseEntry->Size == Index);
+
+    /* Initialize this block */
+    InUseEntry->Flags = EntryFlags;
+    InUseEntry->UnusedBytesLength = (USHORT)((Index << HEAP_ENTRY_SHIFT) - Size);
+
+    /* Zero memory if that was requested */
+    if (Flags & HEAP_ZERO_MEMORY)
+        RtlZeroMemory(InUseEntry + 1, Size);
+
+    /* User data starts right after the entry's header */
+    return InUseEntry + 1;
+}
+
+BOOLEAN NTAPI
+RtlpLowFragHeapFree(PHEAP Heap,
+                    PHEAP_ENTRY HeapEntry)
+{
+    PHEAP_LFH FrontEndHeap = Heap->FrontEndHeap;
+    PHEAP_LFH_BUCKET Bucket;
+
+    /* Check this entry, fail if it's invalid */
+    if (!RtlpValidateLowFragHeapEntry(Heap, HeapEntry))
+    {
+        DPRINT1("HEAP: Trying to free an invalid address %p!\n", HeapEntry + 1);
+        RtlSetLastWin32ErrorAndNtStatusFromNtStatus(STATUS_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    /* Mark it free and put it on the current slot */
+    HeapEntry->Flags = 0;
+    Bucket = &FrontEndHeap->Buckets[HeapEntry->Size - 1];
+    RtlInterlockedPushEntrySList(&RtlpGetLowFragHeapSlot(Bucket, RtlpGetAffinityHint())->FreeList,
+                                 (PSLIST_ENTRY)(HeapEntry + 1));
+
+    return TRUE;
+}
+
+PVOID NTAPI
+RtlpLowFragHeapReAlloc(PHEAP Heap,
+                       ULONG Flags,
+                       PHEAP_ENTRY InUseEntry,
+                       SIZE_T Size,
+                       SIZE_T Index)
+{
+    PVOID Ptr = InUseEntry + 1;
+    PVOID NewBaseAddress;
+    SIZE_T OldSize;
+    EXCEPTION_RECORD ExceptionRecord;
+
+    if (!RtlpValidateLowFragHeapEntry(Heap, InUseEntry))
+    {
+        RtlSetLastWin32ErrorAndNtStatusFromNtStatus(STATUS_INVALID_PARAMETER);
+        return Ptr;
+    }
+
+    OldSize = RtlpLowFragHeapSize(InUseEntry);
+
+    /* Stay in the same block if it's big enough and needs no extra stuff */
+    if (Index <= InUseEntry->Size && !(Flags & HEAP_EXTRA_FLAGS_MASK))
+    {
+        if (Size > OldSize && (Flags & HEAP_ZERO_MEMORY))
+            RtlZeroMemory((PCHAR)Ptr + OldSize, Size - OldSize);
+
+        InUseEntry->UnusedBytesLength = (USHORT)((InUseEntry->Size << HEAP_ENTRY_SHIFT) - Size);
+        return Ptr;
+    }
+
+    if (Flags & HEAP_REALLOC_IN_PLACE_ONLY)
+    {
+        DPRINT1("Realloc in place failed, but it was the only option\n");
+
+        if (Flags & HEAP_GENERATE_EXCEPTIONS)
+        {
+            ExceptionRecord.ExceptionCode = STATUS_NO_MEMORY;
+            ExceptionRecord.ExceptionRecord = NULL;
+            ExceptionRecord.NumberParameters = 1;
+            ExceptionRecord.ExceptionFlags = 0;
+            ExceptionRecord.ExceptionInformation[0] = Index << HEAP_ENTRY_SHIFT;
+
+            RtlRaiseException(&ExceptionRecord);
+        }
+
+        return NULL;
+    }
+
+    /* Preserve user settable flags */
+    Flags &= ~HEAP_SETTABLE_USER_FLAGS;
+    Flags |= (InUseEntry->Flags & HEAP_ENTRY_SETTABLE_FLAGS) << 4;
+
+    /* Move it to a new block, which may come from the back end */
+    NewBaseAddress = RtlAllocateHeap(Heap, Flags & ~HEAP_ZERO_MEMORY, Size);
+    if (!NewBaseAddress) return NULL;
+
+    RtlCopyMemory(NewBaseAddress, Ptr, min(Size, OldSize));
+
+    /* Zero remaining part if required */
+    if (Size > OldSize && (Flags & HEAP_ZERO_MEMORY))
+        RtlZeroMemory((PCHAR)NewBaseAddress + OldSize, Size - OldSize);
+
+    RtlpLowFragHeapFree(Heap, InUseEntry);
+    return NewBaseAddress;
+}
+
+SIZE_T NTAPI
+RtlpLowFragHeapSize(PHEAP_ENTRY HeapEntry)
+{
+    return ((SIZE_T)HeapEntry->Size << HEAP_ENTRY_SHIFT) - HeapEntry->UnusedBytesLength;
+}
+
+BOOLEAN NTAPI
+RtlpValidateLowFragHeapEntry(PHEAP Heap,
+                             PHEAP_ENTRY HeapEntry)
+{
+    UNREFERENCED_PARAMETER(Heap);
+
+    if ((ULONG_PTR)HeapEntry & (HEAP_ENTRY_SIZE - 1)) return FALSE;
+    if (!(HeapEntry->Flags & HEAP_ENTRY_BUSY)) return FALSE;
+    if (HeapEntry->LFHFlags != HEAP_ENTRY_LFH_BLOCK) return FALSE;
+    if (!HeapEntry->Size || HeapEntry->Size > HEAP_LFH_BUCKETS) return FALSE;
+
+    /* The user part must not cross into the next block */
+    if (HeapEntry->UnusedBytesLength < HEAP_ENTRY_SIZE ||
+        HeapEntry->UnusedBytesLength > ((ULONG)HeapEntry->Size << HEAP_ENTRY_SHIFT))
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* EOF */
@@ -15,6 +15,9 @@
 
 PFSN_PREFETCHER_GLOBALS CcPfGlobals;
 
+ULONG CcReadAheadIos;
+ULONG CcReadAheadHits;
+
 /* FUNCTIONS *****************************************************************/
 
 VOID
@@ -76,22 +79,163 @@ CcRemapBcb (
     return 0;
 }
 
+static
+BOOLEAN
+CcIsReadSequential (
+    _In_ LONGLONG FileOffset,
+    _In_ LONGLONG BeyondLastByte)
+{
+    /* Accept reads that restart within the page where the last one ended */
+    return (FileOffset >= ROUND_DOWN(BeyondLastByte, PAGE_SIZE) &&
+            FileOffset <= ROUND_UP(BeyondLastByte, PAGE_SIZE));
+}
+
+static
+VOID
+NTAPI
+CcPerformReadAhead (
+    IN PVOID Context)
+{
+    PROS_SHARED_CACHE_MAP SharedCacheMap = Context;
+    PFILE_OBJECT FileObject = SharedCacheMap->FileObject;
+    LONGLONG CurrentOffset, EndOffset;
+    PVOID BaseAddress;
+    PROS_VACB Vacb;
+    BOOLEAN Valid;
+    NTSTATUS Status;
+
+    CurrentOffset = SharedCacheMap->ReadAheadOffset.QuadPart;
+    EndOffset = CurrentOffset + SharedCacheMap->ReadAheadLength;
+
+    DPRINT("CcPerformReadAhead(SharedCacheMap 0x%p, %I64x-%I64x)\n",
+           SharedCacheMap, CurrentOffset, EndOffset);
+
+    if (SharedCacheMap->Callbacks->AcquireForReadAhead(SharedCacheMap->LazyWriteContext, TRUE))
+    {
+        while (CurrentOffset < EndOffset &&
+               CurrentOffset < SharedCacheMap->FileSize.QuadPart)
+        {
+            Status = CcRosRequestVacb(SharedCacheMap,
+                                      CurrentOffset,
+                                      &BaseAddress,
+                                      &Valid,
+                                      &Vacb);
+            if (!NT_SUCCESS(Status))
+                break;
+
+            if (!Valid)
+            {
+                Status = CcReadVirtualAddress(Vacb);
+                if (!NT_SUCCESS(Status))
+                {
+                    CcRosReleaseVacb(SharedCacheMap, Vacb, FALSE, FALSE, FALSE);
+                    break;
+                }
+                Vacb->ReadAhead = TRUE;
+                CcReadAheadIos++;
+            }
+            CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, FALSE, FALSE);
+
+            CurrentOffset += VACB_MAPPING_GRANULARITY;
+        }
+
+        SharedCacheMap->Callbacks->ReleaseFromReadAhead(SharedCacheMap->LazyWriteContext);
+    }
+
+    /* Allow the next request, then drop the reference taken when queuing */
+    InterlockedExchange(&SharedCacheMap->ReadAheadActive, FALSE);
+    CcRosDereferenceCache(FileObject);
+}
+
 /*
- * @unimplemented
+ * @implemented
  */
 VOID
 NTAPI
 CcScheduleReadAhead (
-	IN	PFILE_OBJECT		FileObject,
-	IN	PLARGE_INTEGER		FileOffset,
-	IN	ULONG			Length
-	)
+    IN PFILE_OBJECT FileObject,
+    IN PLARGE_INTEGER FileOffset,
+    IN ULONG Length)
 {
-	UNIMPLEMENTED;
+    PROS_SHARED_CACHE_MAP SharedCacheMap;
+    PROS_PRIVATE_CACHE_MAP PrivateMap;
+    LONGLONG BeyondLastByte, ReadAheadStart, ReadAheadEnd;
+    ULONG ReadAheadLength;
+    BOOLEAN Sequential;
+    KIRQL OldIrql;
+
+    CCTRACE(CC_API_DEBUG, "FileObject=%p FileOffset=%I64d Length=%lu\n",
+        FileObject, FileOffset->QuadPart, Length);
+
+    SharedCacheMap = FileObject->SectionObjectPointer->SharedCacheMap;
+    PrivateMap = FileObject->PrivateCacheMap;
+    if (SharedCacheMap == NULL || PrivateMap == NULL || Length == 0)
+    {
+        return;
+    }
+
+    BeyondLastByte = FileOffset->QuadPart + Length;
+
+    /* Record the access and check whether it continues the last two */
+    KeAcquireSpinLock(&PrivateMap->ReadAheadSpinLock, &OldIrql);
+    Sequential = BooleanFlagOn(FileObject->Flags, FO_SEQUENTIAL_ONLY) ||
+                 (CcIsReadSequential(FileOffset->QuadPart,
+                                     PrivateMap->BeyondLastByte1.QuadPart) &&
+                  CcIsReadSequential(PrivateMap->FileOffset1.QuadPart,
+                                     PrivateMap->BeyondLastByte2.QuadPart));
+    PrivateMap->FileOffset2 = PrivateMap->FileOffset1;
+    PrivateMap->BeyondLastByte2 = PrivateMap->BeyondLastByte1;
+    PrivateMap->FileOffset1.QuadPart = FileOffset->QuadPart;
+    PrivateMap->BeyondLastByte1.QuadPart = BeyondLastByte;
+    if (!Sequential)
+    {
+        /* A seek starts a new stream */
+        PrivateMap->ReadAheadOffset.QuadPart = 0;
+    }
+    ReadAheadStart = max(BeyondLastByte, PrivateMap->ReadAheadOffset.QuadPart);
+    KeReleaseSpinLock(&PrivateMap->ReadAheadSpinLock, OldIrql);
+
+    if (!Sequential || (SharedCacheMap->Flags & READAHEAD_DISABLED))
+    {
+        return;
+    }
+
+    /* Stay at least one view ahead of the reader, twice as far as it reads */
+    ReadAheadLength = ROUND_UP(Length, SharedCacheMap->ReadAheadGranularity) * 2;
+    ReadAheadLength = max(ReadAheadLength, VACB_MAPPING_GRANULARITY);
+    ReadAheadLength = min(ReadAheadLength, CC_MAXIMUM_READ_AHEAD);
+
+    ReadAheadStart = ROUND_DOWN(ReadAheadStart, VACB_MAPPING_GRANULARITY);
+    ReadAheadEnd = ROUND_UP(BeyondLastByte + ReadAheadLength, VACB_MAPPING_GRANULARITY);
+    ReadAheadEnd = min(ReadAheadEnd, ROUND_UP(SharedCacheMap->FileSize.QuadPart,
+                                              VACB_MAPPING_GRANULARITY));
+    if (ReadAheadStart >= ReadAheadEnd)
+    {
+        return;
+    }
+
+    /* One request per shared cache map is in flight at any time */
+    if (InterlockedCompareExchange(&SharedCacheMap->ReadAheadActive, TRUE, FALSE))
+    {
+        return;
+    }
+
+    KeAcquireSpinLock(&PrivateMap->ReadAheadSpinLock, &OldIrql);
+    PrivateMap->ReadAheadOffset.QuadPart = ReadAheadEnd;
+    KeReleaseSpinLock(&PrivateMap->ReadAheadSpinLock, OldIrql);
+
+    /* Keep the cache map alive until the worker is done with it */
+    CcRosReferenceCache(FileObject);
+    SharedCacheMap->ReadAheadOffset.QuadPart = ReadAheadStart;
+    SharedCacheMap->ReadAheadLength = (ULONG)(ReadAheadEnd - ReadAheadStart);
+    ExInitializeWorkItem(&SharedCacheMap->ReadAheadWorkItem,
+                         CcPerformReadAhead,
+                         SharedCacheMap);
+    ExQueueWorkItem(&SharedCacheMap->ReadAheadWorkItem, DelayedWorkQueue);
 }
 
 /*
- * @unimplemented
+ * @implemented
  */
 VOID
 NTAPI
@@ -101,10 +245,27 @@ CcSetAdditionalCacheAttributes (
 	IN	BOOLEAN		DisableWriteBehind
 	)
 {
+    PROS_SHARED_CACHE_MAP SharedCacheMap;
+
     CCTRACE(CC_API_DEBUG, "FileObject=%p DisableReadAhead=%d DisableWriteBehind=%d\n",
         FileObject, DisableReadAhead, DisableWriteBehind);
 
-	UNIMPLEMENTED;
+    SharedCacheMap = FileObject->SectionObjectPointer->SharedCacheMap;
+    if (SharedCacheMap == NULL)
+    {
+        return;
+    }
+
+    if (DisableReadAhead)
+    {
+        SharedCacheMap->Flags |= READAHEAD_DISABLED;
+    }
+    else
+    {
+        SharedCacheMap->Flags &= ~READAHEAD_DISABLED;
+    }
+
+    /* FIXME: There is no write behind to disable yet */
 }
 
 /*
@@ -140,7 +301,7 @@ CcSetDirtyPageThreshold (
 }
 
 /*
- * @unimplemented
+ * @implemented
  */
 VOID
 NTAPI
@@ -149,8 +310,33 @@ CcSetReadAheadGranularity (
 	IN	ULONG		Granularity
 	)
 {
+    PROS_SHARED_CACHE_MAP SharedCacheMap;
+
     CCTRACE(CC_API_DEBUG, "FileObject=%p Granularity=%lu\n",
         FileObject, Granularity);
 
-	UNIMPLEMENTED;
+    /* The granularity must be a power of two, and at least a page */
+    ASSERT(Granularity >= PAGE_SIZE && (Granularity & (Granularity - 1)) == 0);
+
+    SharedCacheMap = FileObject->SectionObjectPointer->SharedCacheMap;
+    if (SharedCacheMap != NULL)
+    {
+        SharedCacheMap->ReadAheadGranularity = Granularity;
+    }
+}
+
+#if DBG && KDBG
+BOOLEAN
+CcKdbgExtCache(
+    ULONG Argc,
+    PCHAR Argv[])
+{
+    KdbpPrint("CcCopyRead: %lu wait (%lu miss), %lu no wait (%lu miss)\n",
+              CcCopyReadWait, CcCopyReadWaitMiss,
+              CcCopyReadNoWait, CcCopyReadNoWaitMiss);
+    KdbpPrint("Read ahead: %lu I/Os, %lu views hit before being read\n",
+              CcReadAheadIos, CcReadAheadHits);
+
+    return TRUE;
 }
+#endif // DBG && KDBG
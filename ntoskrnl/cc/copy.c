@@ -33,6 +33,10 @@ ULONG CcFastReadNotPossible;
 ULONG CcFastReadWait;
 ULONG CcFastReadNoWait;
 ULONG CcFastReadResourceMiss;
+ULONG CcCopyReadWait;
+ULONG CcCopyReadNoWait;
+ULONG CcCopyReadWaitMiss;
+ULONG CcCopyReadNoWaitMiss;
 
 /* FUNCTIONS *****************************************************************/
 
@@ -211,7 +215,7 @@ CcCopyData (
     ULONG BytesCopied;
     KIRQL OldIrql;
     PROS_SHARED_CACHE_MAP SharedCacheMap;
-    PLIST_ENTRY ListEntry;
+    LONGLONG ViewOffset;
     PROS_VACB Vacb;
     ULONG PartialLength;
     PVOID BaseAddress;
@@ -226,25 +230,20 @@ CcCopyData (
         /* test if the requested data is available */
         KeAcquireSpinLock(&SharedCacheMap->CacheMapLock, &OldIrql);
         /* FIXME: this loop doesn't take into account areas that don't have
-         * a VACB in the list yet */
-        ListEntry = SharedCacheMap->CacheMapVacbListHead.Flink;
-        while (ListEntry != &SharedCacheMap->CacheMapVacbListHead)
+         * a VACB in the index yet */
+        for (ViewOffset = ROUND_DOWN(CurrentOffset, VACB_MAPPING_GRANULARITY);
+             ViewOffset < CurrentOffset + Length;
+             ViewOffset += VACB_MAPPING_GRANULARITY)
         {
-            Vacb = CONTAINING_RECORD(ListEntry,
-                                     ROS_VACB,
-                                     CacheMapVacbListEntry);
-            ListEntry = ListEntry->Flink;
-            if (!Vacb->Valid &&
-                DoRangesIntersect(Vacb->FileOffset.QuadPart,
-                                  VACB_MAPPING_GRANULARITY,
-                                  CurrentOffset, Length))
+            Vacb = CcRosGetVacbFromIndex(SharedCacheMap, ViewOffset);
+            if (Vacb != NULL && !Vacb->Valid)
             {
                 KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, OldIrql);
                 /* data not available */
+                if (Operation == CcOperationRead)
+                    CcCopyReadNoWaitMiss++;
                 return FALSE;
             }
-            if (Vacb->FileOffset.QuadPart >= CurrentOffset + Length)
-                break;
         }
         KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, OldIrql);
     }
@@ -263,6 +262,8 @@ CcCopyData (
             ExRaiseStatus(Status);
         if (!Valid)
         {
+            if (Operation == CcOperationRead)
+                CcCopyReadWaitMiss++;
             Status = CcReadVirtualAddress(Vacb);
             if (!NT_SUCCESS(Status))
             {
@@ -270,6 +271,11 @@ CcCopyData (
                 ExRaiseStatus(Status);
             }
         }
+        else if (Vacb->ReadAhead && Operation == CcOperationRead)
+        {
+            Vacb->ReadAhead = FALSE;
+            CcReadAheadHits++;
+        }
         Status = ReadWriteOrZero((PUCHAR)BaseAddress + CurrentOffset % VACB_MAPPING_GRANULARITY,
                                  Buffer,
                                  PartialLength,
@@ -303,6 +309,8 @@ CcCopyData (
             (Operation == CcOperationRead ||
              PartialLength < VACB_MAPPING_GRANULARITY))
         {
+            if (Operation == CcOperationRead)
+                CcCopyReadWaitMiss++;
             Status = CcReadVirtualAddress(Vacb);
             if (!NT_SUCCESS(Status))
             {
@@ -310,6 +318,11 @@ CcCopyData (
                 ExRaiseStatus(Status);
             }
         }
+        else if (Valid && Vacb->ReadAhead && Operation == CcOperationRead)
+        {
+            Vacb->ReadAhead = FALSE;
+            CcReadAheadHits++;
+        }
         Status = ReadWriteOrZero(BaseAddress, Buffer, PartialLength, Operation);
 
         CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, Operation != CcOperationRead, FALSE);
@@ -359,6 +372,8 @@ CcCopyRead (
     OUT PVOID Buffer,
     OUT PIO_STATUS_BLOCK IoStatus)
 {
+    BOOLEAN Success;
+
     CCTRACE(CC_API_DEBUG, "FileObject=%p FileOffset=%I64d Length=%lu Wait=%d\n",
         FileObject, FileOffset->QuadPart, Length, Wait);
 
@@ -367,13 +382,26 @@ CcCopyRead (
            FileObject, FileOffset->QuadPart, Length, Wait,
            Buffer, IoStatus);
 
-    return CcCopyData(FileObject,
-                      FileOffset->QuadPart,
-                      Buffer,
-                      Length,
-                      CcOperationRead,
-                      Wait,
-                      IoStatus);
+    if (Wait)
+        CcCopyReadWait++;
+    else
+        CcCopyReadNoWait++;
+
+    Success = CcCopyData(FileObject,
+                         FileOffset->QuadPart,
+                         Buffer,
+                         Length,
+                         CcOperationRead,
+                         Wait,
+                         IoStatus);
+
+    /* Track the access pattern and fetch the next views if it is sequential */
+    if (Success)
+    {
+        CcScheduleReadAhead(FileObject, FileOffset, Length);
+    }
+
+    return Success;
 }
 
 /*
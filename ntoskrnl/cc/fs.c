@@ -189,6 +189,7 @@ CcSetFileSizes (
             {
                 if ((current->ReferenceCount == 0) || ((current->ReferenceCount == 1) && current->Dirty))
                 {
+                    CcRosRemoveVacbFromIndex(SharedCacheMap, current);
                     RemoveEntryList(&current->CacheMapVacbListEntry);
                     RemoveEntryList(&current->VacbLruListEntry);
                     if (current->Dirty)
@@ -13,8 +13,189 @@
 #define NDEBUG
 #include <debug.h>
 
+/* TYPES *********************************************************************/
+
+/* MDL handed out by the MDL interfaces. The file offset of the view it
+   describes lets the VACB be found through the offset index on release. */
+typedef struct _CC_MDL
+{
+    LONGLONG FileOffset;
+    MDL Mdl;
+} CC_MDL, *PCC_MDL;
+
 /* FUNCTIONS *****************************************************************/
 
+static
+PMDL
+CcpAllocateMdl (
+    IN PVOID VirtualAddress,
+    IN ULONG Length,
+    IN LONGLONG FileOffset)
+{
+    PCC_MDL CcMdl;
+
+    CcMdl = ExAllocatePoolWithTag(NonPagedPool,
+                                  FIELD_OFFSET(CC_MDL, Mdl) + MmSizeOfMdl(VirtualAddress, Length),
+                                  TAG_CC_MDL);
+    if (CcMdl == NULL)
+        return NULL;
+
+    CcMdl->FileOffset = FileOffset;
+    MmInitializeMdl(&CcMdl->Mdl, VirtualAddress, Length);
+    return &CcMdl->Mdl;
+}
+
+static
+VOID
+CcpFreeMdl (
+    IN PMDL Mdl)
+{
+    ExFreePoolWithTag(CONTAINING_RECORD(Mdl, CC_MDL, Mdl), TAG_CC_MDL);
+}
+
+static
+VOID
+CcpReleaseMdlChain (
+    IN PFILE_OBJECT FileObject,
+    IN PMDL MdlChain,
+    IN BOOLEAN Dirty)
+{
+    PROS_SHARED_CACHE_MAP SharedCacheMap;
+    PMDL Mdl;
+
+    if (MdlChain == NULL)
+        return;
+
+    SharedCacheMap = FileObject->SectionObjectPointer->SharedCacheMap;
+    ASSERT(SharedCacheMap);
+
+    while ((Mdl = MdlChain))
+    {
+        MdlChain = Mdl->Next;
+
+        /* Drop the page locks, then the VACB that owns the pages */
+        MmUnlockPages(Mdl);
+        CcRosReleaseVacbByOffset(SharedCacheMap,
+                                 CONTAINING_RECORD(Mdl, CC_MDL, Mdl)->FileOffset,
+                                 Dirty);
+        CcpFreeMdl(Mdl);
+    }
+
+    /* Drop the reference taken when the chain was built */
+    CcRosDereferenceCache(FileObject);
+}
+
+static
+NTSTATUS
+CcpBuildMdlChain (
+    IN PFILE_OBJECT FileObject,
+    IN PLARGE_INTEGER FileOffset,
+    IN ULONG Length,
+    IN LOCK_OPERATION Operation,
+    OUT PMDL *MdlChain)
+/*
+ * FUNCTION: Builds a chain of MDLs describing the cached pages for a file
+ * range, one MDL per view. Each view stays referenced until the chain is
+ * released with CcpReleaseMdlChain.
+ */
+{
+    PROS_SHARED_CACHE_MAP SharedCacheMap;
+    LONGLONG CurrentOffset;
+    ULONG PartialLength;
+    PVOID BaseAddress;
+    PROS_VACB Vacb;
+    BOOLEAN Valid;
+    PMDL Mdl, *NextMdl;
+    NTSTATUS Status;
+
+    *MdlChain = NULL;
+    if (Length == 0)
+        return STATUS_SUCCESS;
+
+    SharedCacheMap = FileObject->SectionObjectPointer->SharedCacheMap;
+    ASSERT(SharedCacheMap);
+
+    CcRosReferenceCache(FileObject);
+
+    NextMdl = MdlChain;
+    CurrentOffset = FileOffset->QuadPart;
+    Status = STATUS_SUCCESS;
+
+    while (Length > 0)
+    {
+        PartialLength = VACB_MAPPING_GRANULARITY - (ULONG)(CurrentOffset % VACB_MAPPING_GRANULARITY);
+        PartialLength = min(PartialLength, Length);
+
+        Status = CcRosRequestVacb(SharedCacheMap,
+                                  ROUND_DOWN(CurrentOffset, VACB_MAPPING_GRANULARITY),
+                                  &BaseAddress,
+                                  &Valid,
+                                  &Vacb);
+        if (!NT_SUCCESS(Status))
+            break;
+
+        /* Both readers and writers need the current contents of the view */
+        if (!Valid)
+        {
+            Status = CcReadVirtualAddress(Vacb);
+            if (!NT_SUCCESS(Status))
+            {
+                CcRosReleaseVacb(SharedCacheMap, Vacb, FALSE, FALSE, FALSE);
+                break;
+            }
+        }
+
+        Mdl = CcpAllocateMdl((PUCHAR)BaseAddress + CurrentOffset % VACB_MAPPING_GRANULARITY,
+                             PartialLength,
+                             ROUND_DOWN(CurrentOffset, VACB_MAPPING_GRANULARITY));
+        if (Mdl == NULL)
+        {
+            CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, FALSE, FALSE);
+            Status = STATUS_INSUFFICIENT_RESOURCES;
+            break;
+        }
+
+        _SEH2_TRY
+        {
+            MmProbeAndLockPages(Mdl, KernelMode, Operation);
+        }
+        _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
+        {
+            Status = _SEH2_GetExceptionCode();
+        }
+        _SEH2_END;
+
+        if (!NT_SUCCESS(Status))
+        {
+            CcpFreeMdl(Mdl);
+            CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, FALSE, FALSE);
+            break;
+        }
+
+        /* The MDL keeps the view alive once the VACB lock is dropped */
+        CcRosReferenceVacb(Vacb);
+        CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, FALSE, FALSE);
+
+        *NextMdl = Mdl;
+        NextMdl = &Mdl->Next;
+
+        CurrentOffset += PartialLength;
+        Length -= PartialLength;
+    }
+
+    if (!NT_SUCCESS(Status))
+    {
+        /* Undo the part of the chain that was built */
+        if (*MdlChain != NULL)
+            CcpReleaseMdlChain(FileObject, *MdlChain, FALSE);
+        else
+            CcRosDereferenceCache(FileObject);
+        *MdlChain = NULL;
+    }
+
+    return Status;
+}
+
 /*
  * @implemented
  */
@@ -28,10 +209,25 @@ CcMdlRead (
     OUT PIO_STATUS_BLOCK IoStatus
     )
 {
+    NTSTATUS Status;
+
     CCTRACE(CC_API_DEBUG, "FileObject=%p FileOffset=%I64d Length=%lu\n",
         FileObject, FileOffset->QuadPart, Length);
 
-    UNIMPLEMENTED;
+    Status = CcpBuildMdlChain(FileObject,
+                              FileOffset,
+                              Length,
+                              IoReadAccess,
+                              MdlChain);
+    if (!NT_SUCCESS(Status))
+    {
+        ExRaiseStatus(Status);
+    }
+
+    CcScheduleReadAhead(FileObject, FileOffset, Length);
+
+    IoStatus->Status = STATUS_SUCCESS;
+    IoStatus->Information = Length;
 }
 
 /*
@@ -58,15 +254,8 @@ CcMdlReadComplete2 (
     IN PMDL MemoryDescriptorList
 )
 {
-    PMDL Mdl;
-
-    /* Free MDLs */
-    while ((Mdl = MemoryDescriptorList))
-    {
-        MemoryDescriptorList = Mdl->Next;
-        MmUnlockPages(Mdl);
-        IoFreeMdl(Mdl);
-    }
+    /* Unlock and free the MDLs, the cached data wasn't modified */
+    CcpReleaseMdlChain(FileObject, MemoryDescriptorList, FALSE);
 }
 
 /*
@@ -102,9 +291,12 @@ CcMdlReadComplete (
     if (FastDispatch && FastDispatch->MdlReadComplete)
     {
          /* Use the fast path */
-        FastDispatch->MdlReadComplete(FileObject,
-                                      MdlChain,
-                                      DeviceObject);
+        if (FastDispatch->MdlReadComplete(FileObject,
+                                          MdlChain,
+                                          DeviceObject))
+        {
+            return;
+        }
     }
 
     /* Use slow path */
@@ -132,14 +324,17 @@ CcMdlWriteComplete (
     if (FastDispatch && FastDispatch->MdlWriteComplete)
     {
          /* Use the fast path */
-        FastDispatch->MdlWriteComplete(FileObject,
-                                       FileOffset,
-                                       MdlChain,
-                                       DeviceObject);
+        if (FastDispatch->MdlWriteComplete(FileObject,
+                                           FileOffset,
+                                           MdlChain,
+                                           DeviceObject))
+        {
+            return;
+        }
     }
 
     /* Use slow path */
-    CcMdlWriteComplete2(FileObject,FileOffset, MdlChain);
+    CcMdlWriteComplete2(FileObject, FileOffset, MdlChain);
 }
 
 VOID
@@ -149,11 +344,15 @@ CcMdlWriteComplete2 (
     IN PLARGE_INTEGER FileOffset,
     IN PMDL MdlChain)
 {
-    UNIMPLEMENTED;
+    CCTRACE(CC_API_DEBUG, "FileObject=%p FileOffset=%I64d MdlChain=%p\n",
+        FileObject, FileOffset->QuadPart, MdlChain);
+
+    /* The caller filled the pages, hand them to the lazy writer */
+    CcpReleaseMdlChain(FileObject, MdlChain, TRUE);
 }
 
 /*
- * @unimplemented
+ * @implemented
  */
 VOID
 NTAPI
@@ -161,11 +360,15 @@ CcMdlWriteAbort (
     IN PFILE_OBJECT FileObject,
     IN PMDL MdlChain)
 {
-    UNIMPLEMENTED;
+    CCTRACE(CC_API_DEBUG, "FileObject=%p MdlChain=%p\n",
+        FileObject, MdlChain);
+
+    /* The views were read before the chain was built, so they are still valid */
+    CcpReleaseMdlChain(FileObject, MdlChain, FALSE);
 }
 
 /*
- * @unimplemented
+ * @implemented
  */
 VOID
 NTAPI
@@ -176,8 +379,21 @@ CcPrepareMdlWrite (
     OUT PMDL * MdlChain,
     OUT PIO_STATUS_BLOCK IoStatus)
 {
+    NTSTATUS Status;
+
     CCTRACE(CC_API_DEBUG, "FileObject=%p FileOffset=%I64d Length=%lu\n",
         FileObject, FileOffset->QuadPart, Length);
 
-    UNIMPLEMENTED;
+    Status = CcpBuildMdlChain(FileObject,
+                              FileOffset,
+                              Length,
+                              IoWriteAccess,
+                              MdlChain);
+    if (!NT_SUCCESS(Status))
+    {
+        ExRaiseStatus(Status);
+    }
+
+    IoStatus->Status = STATUS_SUCCESS;
+    IoStatus->Information = Length;
 }
@@ -49,6 +49,7 @@ KGUARDED_MUTEX ViewLock;
 
 NPAGED_LOOKASIDE_LIST iBcbLookasideList;
 static NPAGED_LOOKASIDE_LIST SharedCacheMapLookasideList;
+static NPAGED_LOOKASIDE_LIST PrivateCacheMapLookasideList;
 static NPAGED_LOOKASIDE_LIST VacbLookasideList;
 
 #if DBG
@@ -129,6 +130,108 @@ CcRosTraceCacheMap (
 #endif
 }
 
+static
+NTSTATUS
+CcRosAddVacbToIndex (
+    PROS_SHARED_CACHE_MAP SharedCacheMap,
+    PROS_VACB Vacb)
+/*
+ * FUNCTION: Makes a VACB findable by its file offset
+ * NOTE: Must be called with the cache map lock held
+ */
+{
+    ULONGLONG View = Vacb->FileOffset.QuadPart / VACB_MAPPING_GRANULARITY;
+    ULONGLONG Leaf = View >> VACB_INDEX_LEAF_SHIFT;
+    PROS_VACB **NewIndex;
+    ULONG NewSize;
+
+    if (Leaf >= SharedCacheMap->VacbIndexSize)
+    {
+        /* Grow the top level, doubling so large files need few copies */
+        NewSize = max(SharedCacheMap->VacbIndexSize, 1);
+        while (NewSize <= Leaf)
+        {
+            NewSize *= 2;
+        }
+
+        NewIndex = ExAllocatePoolWithTag(NonPagedPool,
+                                         NewSize * sizeof(PROS_VACB *),
+                                         TAG_VACB_INDEX);
+        if (NewIndex == NULL)
+        {
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+        RtlZeroMemory(NewIndex, NewSize * sizeof(PROS_VACB *));
+
+        if (SharedCacheMap->VacbIndex != NULL)
+        {
+            RtlCopyMemory(NewIndex,
+                          SharedCacheMap->VacbIndex,
+                          SharedCacheMap->VacbIndexSize * sizeof(PROS_VACB *));
+            ExFreePoolWithTag(SharedCacheMap->VacbIndex, TAG_VACB_INDEX);
+        }
+        SharedCacheMap->VacbIndex = NewIndex;
+        SharedCacheMap->VacbIndexSize = NewSize;
+    }
+
+    if (SharedCacheMap->VacbIndex[Leaf] == NULL)
+    {
+        SharedCacheMap->VacbIndex[Leaf] = ExAllocatePoolWithTag(NonPagedPool,
+                                                                VACB_INDEX_LEAF_SIZE * sizeof(PROS_VACB),
+                                                                TAG_VACB_INDEX);
+        if (SharedCacheMap->VacbIndex[Leaf] == NULL)
+        {
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+        RtlZeroMemory(SharedCacheMap->VacbIndex[Leaf],
+                      VACB_INDEX_LEAF_SIZE * sizeof(PROS_VACB));
+    }
+
+    ASSERT(SharedCacheMap->VacbIndex[Leaf][View & (VACB_INDEX_LEAF_SIZE - 1)] == NULL);
+    SharedCacheMap->VacbIndex[Leaf][View & (VACB_INDEX_LEAF_SIZE - 1)] = Vacb;
+    return STATUS_SUCCESS;
+}
+
+VOID
+NTAPI
+CcRosRemoveVacbFromIndex (
+    PROS_SHARED_CACHE_MAP SharedCacheMap,
+    PROS_VACB Vacb)
+/*
+ * NOTE: Must be called with the cache map lock held
+ */
+{
+    ULONGLONG View = Vacb->FileOffset.QuadPart / VACB_MAPPING_GRANULARITY;
+    ULONGLONG Leaf = View >> VACB_INDEX_LEAF_SHIFT;
+
+    ASSERT(CcRosGetVacbFromIndex(SharedCacheMap, Vacb->FileOffset.QuadPart) == Vacb);
+    SharedCacheMap->VacbIndex[Leaf][View & (VACB_INDEX_LEAF_SIZE - 1)] = NULL;
+}
+
+static
+VOID
+CcRosFreeVacbIndex (
+    PROS_SHARED_CACHE_MAP SharedCacheMap)
+{
+    ULONG i;
+
+    if (SharedCacheMap->VacbIndex == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < SharedCacheMap->VacbIndexSize; i++)
+    {
+        if (SharedCacheMap->VacbIndex[i] != NULL)
+        {
+            ExFreePoolWithTag(SharedCacheMap->VacbIndex[i], TAG_VACB_INDEX);
+        }
+    }
+    ExFreePoolWithTag(SharedCacheMap->VacbIndex, TAG_VACB_INDEX);
+    SharedCacheMap->VacbIndex = NULL;
+    SharedCacheMap->VacbIndexSize = 0;
+}
+
 NTSTATUS
 NTAPI
 CcRosFlushVacb (
@@ -329,6 +432,7 @@ retry:
             ASSERT(!current->Dirty);
             ASSERT(!current->MappedCount);
 
+            CcRosRemoveVacbFromIndex(current->SharedCacheMap, current);
             RemoveEntryList(&current->CacheMapVacbListEntry);
             RemoveEntryList(&current->VacbLruListEntry);
             InsertHeadList(&FreeList, &current->CacheMapVacbListEntry);
@@ -429,6 +533,65 @@ CcRosReleaseVacb (
     return STATUS_SUCCESS;
 }
 
+VOID
+NTAPI
+CcRosReferenceVacb (
+    PROS_VACB Vacb)
+/*
+ * FUNCTION: Keeps a VACB from being freed while its pages are described
+ * by an MDL handed out to a caller. The VACB lock doesn't need to be held.
+ */
+{
+    KIRQL oldIrql;
+
+    KeAcquireGuardedMutex(&ViewLock);
+    KeAcquireSpinLock(&Vacb->SharedCacheMap->CacheMapLock, &oldIrql);
+    CcRosVacbIncRefCount(Vacb);
+    KeReleaseSpinLock(&Vacb->SharedCacheMap->CacheMapLock, oldIrql);
+    KeReleaseGuardedMutex(&ViewLock);
+}
+
+VOID
+NTAPI
+CcRosReleaseVacbByOffset (
+    PROS_SHARED_CACHE_MAP SharedCacheMap,
+    LONGLONG FileOffset,
+    BOOLEAN Dirty)
+/*
+ * FUNCTION: Drops the reference taken by CcRosReferenceVacb on the VACB
+ * mapping FileOffset, marking it dirty if its contents were modified
+ */
+{
+    PROS_VACB current;
+    KIRQL oldIrql;
+
+    KeAcquireGuardedMutex(&ViewLock);
+    KeAcquireSpinLock(&SharedCacheMap->CacheMapLock, &oldIrql);
+
+    current = CcRosGetVacbFromIndex(SharedCacheMap, FileOffset);
+    if (current == NULL)
+    {
+        KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
+        KeReleaseGuardedMutex(&ViewLock);
+
+        /* A referenced VACB can't go away */
+        DPRINT1("No VACB maps offset %I64d\n", FileOffset);
+        KeBugCheck(CACHE_MANAGER);
+    }
+
+    if (Dirty && !current->Dirty)
+    {
+        current->Dirty = TRUE;
+        InsertTailList(&DirtyVacbListHead, &current->DirtyVacbListEntry);
+        DirtyPageCount += VACB_MAPPING_GRANULARITY / PAGE_SIZE;
+        CcRosVacbIncRefCount(current);
+    }
+    CcRosVacbDecRefCount(current);
+
+    KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
+    KeReleaseGuardedMutex(&ViewLock);
+}
+
 /* Returns with VACB Lock Held! */
 PROS_VACB
 NTAPI
@@ -436,7 +599,6 @@ CcRosLookupVacb (
     PROS_SHARED_CACHE_MAP SharedCacheMap,
     LONGLONG FileOffset)
 {
-    PLIST_ENTRY current_entry;
     PROS_VACB current;
     KIRQL oldIrql;
 
@@ -448,35 +610,28 @@ CcRosLookupVacb (
     KeAcquireGuardedMutex(&ViewLock);
     KeAcquireSpinLock(&SharedCacheMap->CacheMapLock, &oldIrql);
 
-    current_entry = SharedCacheMap->CacheMapVacbListHead.Flink;
-    while (current_entry != &SharedCacheMap->CacheMapVacbListHead)
+    current = CcRosGetVacbFromIndex(SharedCacheMap, FileOffset);
+    if (current != NULL)
     {
-        current = CONTAINING_RECORD(current_entry,
-                                    ROS_VACB,
-                                    CacheMapVacbListEntry);
-        if (IsPointInRange(current->FileOffset.QuadPart,
-                           VACB_MAPPING_GRANULARITY,
-                           FileOffset))
-        {
-            CcRosVacbIncRefCount(current);
-            KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
-            KeReleaseGuardedMutex(&ViewLock);
-            KeWaitForSingleObject(&current->Mutex,
-                                  Executive,
-                                  KernelMode,
-                                  FALSE,
-                                  NULL);
-            return current;
-        }
-        if (current->FileOffset.QuadPart > FileOffset)
-            break;
-        current_entry = current_entry->Flink;
+        ASSERT(IsPointInRange(current->FileOffset.QuadPart,
+                              VACB_MAPPING_GRANULARITY,
+                              FileOffset));
+        CcRosVacbIncRefCount(current);
     }
 
     KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
     KeReleaseGuardedMutex(&ViewLock);
 
-    return NULL;
+    if (current != NULL)
+    {
+        KeWaitForSingleObject(&current->Mutex,
+                              Executive,
+                              KernelMode,
+                              FALSE,
+                              NULL);
+    }
+
+    return current;
 }
 
 NTSTATUS
@@ -643,8 +798,6 @@ CcRosCreateVacb (
     PROS_VACB *Vacb)
 {
     PROS_VACB current;
-    PROS_VACB previous;
-    PLIST_ENTRY current_entry;
     NTSTATUS Status;
     KIRQL oldIrql;
 
@@ -663,6 +816,7 @@ CcRosCreateVacb (
     current->Valid = FALSE;
     current->Dirty = FALSE;
     current->PageOut = FALSE;
+    current->ReadAhead = FALSE;
     current->FileOffset.QuadPart = ROUND_DOWN(FileOffset, VACB_MAPPING_GRANULARITY);
     current->SharedCacheMap = SharedCacheMap;
 #if DBG
@@ -690,59 +844,44 @@ CcRosCreateVacb (
      * our newly created VACB and return the existing one.
      */
     KeAcquireSpinLock(&SharedCacheMap->CacheMapLock, &oldIrql);
-    current_entry = SharedCacheMap->CacheMapVacbListHead.Flink;
-    previous = NULL;
-    while (current_entry != &SharedCacheMap->CacheMapVacbListHead)
+    current = CcRosGetVacbFromIndex(SharedCacheMap, FileOffset);
+    if (current != NULL)
     {
-        current = CONTAINING_RECORD(current_entry,
-                                    ROS_VACB,
-                                    CacheMapVacbListEntry);
-        if (IsPointInRange(current->FileOffset.QuadPart,
-                           VACB_MAPPING_GRANULARITY,
-                           FileOffset))
-        {
-            CcRosVacbIncRefCount(current);
-            KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
+        CcRosVacbIncRefCount(current);
+        KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
 #if DBG
-            if (SharedCacheMap->Trace)
-            {
-                DPRINT1("CacheMap 0x%p: deleting newly created VACB 0x%p ( found existing one 0x%p )\n",
-                        SharedCacheMap,
-                        (*Vacb),
-                        current);
-            }
-#endif
-            KeReleaseMutex(&(*Vacb)->Mutex, FALSE);
-            KeReleaseGuardedMutex(&ViewLock);
-            ExFreeToNPagedLookasideList(&VacbLookasideList, *Vacb);
-            *Vacb = current;
-            KeWaitForSingleObject(&current->Mutex,
-                                  Executive,
-                                  KernelMode,
-                                  FALSE,
-                                  NULL);
-            return STATUS_SUCCESS;
-        }
-        if (current->FileOffset.QuadPart < FileOffset)
+        if (SharedCacheMap->Trace)
         {
-            ASSERT(previous == NULL ||
-                   previous->FileOffset.QuadPart < current->FileOffset.QuadPart);
-            previous = current;
+            DPRINT1("CacheMap 0x%p: deleting newly created VACB 0x%p ( found existing one 0x%p )\n",
+                    SharedCacheMap,
+                    (*Vacb),
+                    current);
         }
-        if (current->FileOffset.QuadPart > FileOffset)
-            break;
-        current_entry = current_entry->Flink;
+#endif
+        KeReleaseMutex(&(*Vacb)->Mutex, FALSE);
+        KeReleaseGuardedMutex(&ViewLock);
+        ExFreeToNPagedLookasideList(&VacbLookasideList, *Vacb);
+        *Vacb = current;
+        KeWaitForSingleObject(&current->Mutex,
+                              Executive,
+                              KernelMode,
+                              FALSE,
+                              NULL);
+        return STATUS_SUCCESS;
     }
     /* There was no existing VACB. */
     current = *Vacb;
-    if (previous)
-    {
-        InsertHeadList(&previous->CacheMapVacbListEntry, &current->CacheMapVacbListEntry);
-    }
-    else
+    Status = CcRosAddVacbToIndex(SharedCacheMap, current);
+    if (!NT_SUCCESS(Status))
     {
-        InsertHeadList(&SharedCacheMap->CacheMapVacbListHead, &current->CacheMapVacbListEntry);
+        KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
+        KeReleaseMutex(&current->Mutex, FALSE);
+        KeReleaseGuardedMutex(&ViewLock);
+        ExFreeToNPagedLookasideList(&VacbLookasideList, current);
+        *Vacb = NULL;
+        return Status;
     }
+    InsertTailList(&SharedCacheMap->CacheMapVacbListHead, &current->CacheMapVacbListEntry);
     KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
     InsertTailList(&VacbLruListHead, &current->VacbLruListEntry);
     KeReleaseGuardedMutex(&ViewLock);
@@ -1030,6 +1169,7 @@ CcRosDeleteFileCache (
             current = CONTAINING_RECORD(current_entry, ROS_VACB, CacheMapVacbListEntry);
             CcRosInternalFreeVacb(current);
         }
+        CcRosFreeVacbIndex(SharedCacheMap);
         ExFreeToNPagedLookasideList(&SharedCacheMapLookasideList, SharedCacheMap);
         KeAcquireGuardedMutex(&ViewLock);
     }
@@ -1106,6 +1246,8 @@ CcRosReleaseFileCache (
         SharedCacheMap = FileObject->SectionObjectPointer->SharedCacheMap;
         if (FileObject->PrivateCacheMap != NULL)
         {
+            ExFreeToNPagedLookasideList(&PrivateCacheMapLookasideList,
+                                        FileObject->PrivateCacheMap);
             FileObject->PrivateCacheMap = NULL;
             if (SharedCacheMap->RefCount > 0)
             {
@@ -1122,6 +1264,34 @@ CcRosReleaseFileCache (
     return STATUS_SUCCESS;
 }
 
+static
+NTSTATUS
+CcRosCreatePrivateCacheMap (
+    PFILE_OBJECT FileObject,
+    PROS_SHARED_CACHE_MAP SharedCacheMap)
+/*
+ * FUNCTION: Attaches a file object to a shared cache map, the private
+ * cache map keeps the access history used for read ahead
+ * NOTE: Must be called with the view lock held
+ */
+{
+    PROS_PRIVATE_CACHE_MAP PrivateMap;
+
+    PrivateMap = ExAllocateFromNPagedLookasideList(&PrivateCacheMapLookasideList);
+    if (PrivateMap == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+    RtlZeroMemory(PrivateMap, sizeof(*PrivateMap));
+    PrivateMap->FileObject = FileObject;
+    PrivateMap->SharedCacheMap = SharedCacheMap;
+    KeInitializeSpinLock(&PrivateMap->ReadAheadSpinLock);
+
+    FileObject->PrivateCacheMap = PrivateMap;
+    SharedCacheMap->RefCount++;
+    return STATUS_SUCCESS;
+}
+
 NTSTATUS
 NTAPI
 CcTryToInitializeFileCache (
@@ -1140,12 +1310,11 @@ CcTryToInitializeFileCache (
     }
     else
     {
+        Status = STATUS_SUCCESS;
         if (FileObject->PrivateCacheMap == NULL)
         {
-            FileObject->PrivateCacheMap = SharedCacheMap;
-            SharedCacheMap->RefCount++;
+            Status = CcRosCreatePrivateCacheMap(FileObject, SharedCacheMap);
         }
-        Status = STATUS_SUCCESS;
     }
     KeReleaseGuardedMutex(&ViewLock);
 
@@ -1165,6 +1334,7 @@ CcRosInitializeFileCache (
  */
 {
     PROS_SHARED_CACHE_MAP SharedCacheMap;
+    NTSTATUS Status = STATUS_SUCCESS;
 
     SharedCacheMap = FileObject->SectionObjectPointer->SharedCacheMap;
     DPRINT("CcRosInitializeFileCache(FileObject 0x%p, SharedCacheMap 0x%p)\n",
@@ -1189,18 +1359,18 @@ CcRosInitializeFileCache (
         SharedCacheMap->LazyWriteContext = LazyWriterContext;
         SharedCacheMap->SectionSize = FileSizes->AllocationSize;
         SharedCacheMap->FileSize = FileSizes->FileSize;
+        SharedCacheMap->ReadAheadGranularity = PAGE_SIZE;
         KeInitializeSpinLock(&SharedCacheMap->CacheMapLock);
         InitializeListHead(&SharedCacheMap->CacheMapVacbListHead);
         FileObject->SectionObjectPointer->SharedCacheMap = SharedCacheMap;
     }
     if (FileObject->PrivateCacheMap == NULL)
     {
-        FileObject->PrivateCacheMap = SharedCacheMap;
-        SharedCacheMap->RefCount++;
+        Status = CcRosCreatePrivateCacheMap(FileObject, SharedCacheMap);
     }
     KeReleaseGuardedMutex(&ViewLock);
 
-    return STATUS_SUCCESS;
+    return Status;
 }
 
 /*
@@ -1249,6 +1419,13 @@ CcInitView (
                                     sizeof(ROS_SHARED_CACHE_MAP),
                                     TAG_SHARED_CACHE_MAP,
                                     20);
+    ExInitializeNPagedLookasideList(&PrivateCacheMapLookasideList,
+                                    NULL,
+                                    NULL,
+                                    0,
+                                    sizeof(ROS_PRIVATE_CACHE_MAP),
+                                    TAG_PRIVATE_CACHE_MAP,
+                                    20);
     ExInitializeNPagedLookasideList(&VacbLookasideList,
                                     NULL,
                                     NULL,
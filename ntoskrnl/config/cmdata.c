@@ -306,6 +306,14 @@ INIT_FUNCTION CM_SYSTEM_CONTROL_VECTOR CmControlVector[] =
         NULL
     },
 
+    {
+        L"Session Manager\\Memory Management",
+        L"ZeroPageThreads",
+        &MmZeroPageThreadCount,
+        NULL,
+        NULL
+    },
+
     {
         L"Session Manager\\Memory Management",
         L"PagedPoolSize",
@@ -597,7 +605,7 @@ INIT_FUNCTION CM_SYSTEM_CONTROL_VECTOR CmControlVector[] =
     {
         L"Session Manager\\I/O System",
         L"LargeIrpStackLocations",
-        &DummyData,
+        &IopLargeIrpStackLocations,
         NULL,
         NULL
     },
@@ -14,19 +14,56 @@
 
 /* GLOBALS *******************************************************************/
 
-ULONG CmpHashTableSize = 2048;
+ULONG CmpHashTableSize = CMP_MINIMUM_HASH_TABLE_SIZE;
 PCM_KEY_HASH_TABLE_ENTRY CmpCacheTable;
 PCM_NAME_HASH_TABLE_ENTRY CmpNameCacheTable;
+#if DBG
+CM_HASH_TABLE_STATISTICS CmpCacheTableStatistics;
+CM_HASH_TABLE_STATISTICS CmpNameCacheTableStatistics;
+#endif
 
 /* FUNCTIONS *****************************************************************/
 
+#if DBG
+FORCEINLINE
+VOID
+CmpUpdateHashStatistics(IN PCM_HASH_TABLE_STATISTICS Statistics,
+                        IN ULONG ChainLength,
+                        IN BOOLEAN Hit)
+{
+    /* These are only hints, so don't bother with interlocked operations */
+    Statistics->Lookups++;
+    if (Hit) Statistics->Hits++; else Statistics->Misses++;
+    Statistics->ChainEntriesWalked += ChainLength;
+    if (ChainLength > Statistics->LongestChain)
+    {
+        Statistics->LongestChain = ChainLength;
+    }
+}
+#else
+#define CmpUpdateHashStatistics(Statistics, ChainLength, Hit) \
+    UNREFERENCED_PARAMETER(ChainLength)
+#endif
+
 VOID
 NTAPI
 INIT_FUNCTION
 CmpInitializeCache(VOID)
 {
     ULONG Length, i;
-    
+
+    /* Give bigger machines, which cache more keys, a bigger table */
+    while ((CmpHashTableSize < CMP_MAXIMUM_HASH_TABLE_SIZE) &&
+           ((CmpHashTableSize * CMP_PAGES_PER_HASH_BUCKET * 2) <=
+            MmNumberOfPhysicalPages))
+    {
+        CmpHashTableSize *= 2;
+    }
+
+    /* The hash index is masked, so the size must be a power of two */
+    ASSERT((CmpHashTableSize & (CmpHashTableSize - 1)) == 0);
+    DPRINT("Using %lu KCB and NCB hash buckets\n", CmpHashTableSize);
+
     /* Calculate length for the table */
     Length = CmpHashTableSize * sizeof(CM_KEY_HASH_TABLE_ENTRY);
     
@@ -109,7 +146,7 @@ NTAPI
 CmpInsertKeyHash(IN PCM_KEY_HASH KeyHash,
                  IN BOOLEAN IsFake)
 {
-    ULONG i;
+    ULONG i, ChainLength = 0;
     PCM_KEY_HASH Entry;
     ASSERT_VALID_HASH(KeyHash);
 
@@ -130,14 +167,17 @@ CmpInsertKeyHash(IN PCM_KEY_HASH KeyHash,
             (KeyHash->KeyHive == Entry->KeyHive))
         {
             /* Return it */
+            CmpUpdateHashStatistics(&CmpCacheTableStatistics, ChainLength, TRUE);
             return CONTAINING_RECORD(Entry, CM_KEY_CONTROL_BLOCK, KeyHash);
         }
 
         /* Keep looping */
         Entry = Entry->NextHash;
+        ChainLength++;
     }
 
     /* No entry found, add this one and return NULL since none existed */
+    CmpUpdateHashStatistics(&CmpCacheTableStatistics, ChainLength, FALSE);
     KeyHash->NextHash = CmpCacheTable[i].Entry;
     CmpCacheTable[i].Entry = KeyHash;
     return NULL;
@@ -153,7 +193,7 @@ CmpGetNameControlBlock(IN PUNICODE_STRING NodeName)
     ULONG i;
     BOOLEAN IsCompressed = TRUE, Found = FALSE;
     PCM_NAME_HASH HashEntry;
-    ULONG NcbSize;
+    ULONG NcbSize, ChainLength = 0;
     USHORT Length;
 
     /* Loop the name */
@@ -244,8 +284,12 @@ CmpGetNameControlBlock(IN PUNICODE_STRING NodeName)
 
         /* Go to the next hash */
         HashEntry = HashEntry->NextHash;
+        ChainLength++;
     }
 
+    /* Update the statistics while still holding the bucket */
+    CmpUpdateHashStatistics(&CmpNameCacheTableStatistics, ChainLength, Found);
+
     /* Check if we didn't find it */
     if (!Found)
     {
@@ -26,6 +26,7 @@ ULONG CmpLazyFlushIntervalInSeconds = 5;
 static ULONG CmpLazyFlushHiveCount = 7;
 ULONG CmpLazyFlushCount = 1;
 LONG CmpFlushStarveWriters;
+CM_LAZY_FLUSH_STATISTICS CmpLazyFlushStatistics;
 
 /* FUNCTIONS ******************************************************************/
 
@@ -40,6 +41,8 @@ CmpDoFlushNextHive(_In_  BOOLEAN ForceFlush,
     PCMHIVE CmHive;
     BOOLEAN Result;
     ULONG HiveCount = CmpLazyFlushHiveCount;
+    ULONG DirtyBlocks;
+    ULONGLONG StartTime, FlushTime;
 
     /* Set Defaults */
     *Error = FALSE;
@@ -80,17 +83,36 @@ CmpDoFlushNextHive(_In_  BOOLEAN ForceFlush,
                 /* Do the sync */
                 DPRINT("Flushing: %wZ\n", &CmHive->FileFullPath);
                 DPRINT("Handle: %p\n", CmHive->FileHandles[HFILE_TYPE_PRIMARY]);
+                DirtyBlocks = RtlNumberOfSetBits(&CmHive->Hive.DirtyVector);
+                StartTime = KeQueryInterruptTime();
                 Status = HvSyncHive(&CmHive->Hive);
+                FlushTime = KeQueryInterruptTime() - StartTime;
                 if(!NT_SUCCESS(Status))
                 {
                     /* Let them know we failed */
                     DPRINT1("Failed to flush %wZ on handle %p (status 0x%08lx)\n",
                         &CmHive->FileFullPath,  CmHive->FileHandles[HFILE_TYPE_PRIMARY], Status);
+                    CmpLazyFlushStatistics.FlushFailures++;
                     *Error = TRUE;
                     Result = FALSE;
                     break;
                 }
                 CmHive->FlushCount = CmpLazyFlushCount;
+
+                /* Account the dirty blocks and both base block writes */
+                if (DirtyBlocks)
+                {
+                    CmpLazyFlushStatistics.BytesWritten +=
+                        (ULONGLONG)(DirtyBlocks + 2) * HV_BLOCK_SIZE;
+                }
+                CmpLazyFlushStatistics.HivesFlushed++;
+                CmpLazyFlushStatistics.TotalFlushTime += FlushTime;
+                if (FlushTime > CmpLazyFlushStatistics.LongestFlushTime)
+                {
+                    CmpLazyFlushStatistics.LongestFlushTime = FlushTime;
+                }
+                DPRINT("Flushed %lu blocks of %wZ in %I64u us\n",
+                       DirtyBlocks, &CmHive->FileFullPath, FlushTime / 10);
             }
         }
         else if ((CmHive->Hive.DirtyCount) &&
@@ -19,6 +19,9 @@ LIST_ENTRY HandleTableListHead;
 EX_PUSH_LOCK HandleTableListLock;
 #define SizeOfHandle(x) (sizeof(HANDLE) * (x))
 
+/* How many times a locked entry is polled on MP before blocking on it */
+#define EXP_HANDLE_LOCK_SPIN_COUNT 128
+
 /* PRIVATE FUNCTIONS *********************************************************/
 
 VOID
@@ -839,12 +842,29 @@ ExpBlockOnLockedHandleEntry(IN PHANDLE_TABLE HandleTable,
     }
 }
 
+FORCEINLINE
+VOID
+ExpUnblockHandleWaiters(IN PHANDLE_TABLE HandleTable)
+{
+    /*
+     * Only touch the table-wide contention lock if somebody is blocked on it.
+     * Callers changed the entry with an interlocked operation first, and
+     * waiters queue themselves before re-checking the entry, so neither side
+     * can miss the other. This keeps lookups from all writing the same line.
+     */
+    if (*(volatile PVOID *)&HandleTable->HandleContentionEvent.Ptr)
+    {
+        ExfUnblockPushLock(&HandleTable->HandleContentionEvent, NULL);
+    }
+}
+
 BOOLEAN
 NTAPI
 ExpLockHandleTableEntry(IN PHANDLE_TABLE HandleTable,
                         IN PHANDLE_TABLE_ENTRY HandleTableEntry)
 {
     LONG_PTR NewValue, OldValue;
+    ULONG SpinCount;
 
     /* Sanity check */
     ASSERT((KeGetCurrentThread()->CombinedApcDisable != 0) ||
@@ -871,6 +891,20 @@ ExpLockHandleTableEntry(IN PHANDLE_TABLE HandleTable,
         {
             /* We couldn't lock it, bail out if it's been freed */
             if (!OldValue) return FALSE;
+
+            /* Entries are only held for a few instructions, so spin a bit on MP */
+            if (KeNumberProcessors > 1)
+            {
+                for (SpinCount = EXP_HANDLE_LOCK_SPIN_COUNT; SpinCount; SpinCount--)
+                {
+                    YieldProcessor();
+                    OldValue = *(volatile LONG_PTR *)&HandleTableEntry->Object;
+                    if (!(OldValue) || (OldValue & EXHANDLE_TABLE_ENTRY_LOCK_BIT)) break;
+                }
+
+                /* Go try again if it was released or freed meanwhile */
+                if (SpinCount) continue;
+            }
         }
 
         /* It's locked, wait for it to be unlocked */
@@ -896,7 +930,7 @@ ExUnlockHandleTableEntry(IN PHANDLE_TABLE HandleTable,
     ASSERT((OldValue & EXHANDLE_TABLE_ENTRY_LOCK_BIT) == 0);
 
     /* Unblock any waiters */
-    ExfUnblockPushLock(&HandleTable->HandleContentionEvent, NULL);
+    ExpUnblockHandleWaiters(HandleTable);
 }
 
 VOID
@@ -990,8 +1024,8 @@ ExDestroyHandle(IN PHANDLE_TABLE HandleTable,
     ASSERT(Object != NULL);
     ASSERT((((ULONG_PTR)Object) & EXHANDLE_TABLE_ENTRY_LOCK_BIT) == 0);
 
-    /* Unblock the pushlock */
-    ExfUnblockPushLock(&HandleTable->HandleContentionEvent, NULL);
+    /* Unblock any waiters */
+    ExpUnblockHandleWaiters(HandleTable);
 
     /* Free the actual entry */
     ExpFreeHandleTableEntry(HandleTable, ExHandle, HandleTableEntry);
@@ -16,6 +16,12 @@
 #pragma alloc_text(INIT, ExpInitLookasideLists)
 #endif
 
+/* The balancer never takes a list below this depth */
+#define MINIMUM_LOOKASIDE_DEPTH         4
+
+/* Below this many allocations per scan a list is considered idle */
+#define MINIMUM_ALLOCATION_THRESHOLD    25
+
 /* GLOBALS *******************************************************************/
 
 LIST_ENTRY ExpNonPagedLookasideListHead;
@@ -123,6 +129,98 @@ ExpInitLookasideLists()
     }
 }
 
+static
+USHORT
+NTAPI
+ExpComputeLookasideDepth(IN ULONG Allocates,
+                         IN ULONG Misses,
+                         IN USHORT MaximumDepth,
+                         IN USHORT Depth)
+{
+    ULONG Ratio, Target;
+
+    /* Idle lists shrink quickly */
+    if (Allocates < MINIMUM_ALLOCATION_THRESHOLD)
+    {
+        Target = (Depth > MINIMUM_LOOKASIDE_DEPTH + 10) ?
+                 Depth - 10 : MINIMUM_LOOKASIDE_DEPTH;
+        return (USHORT)min(Target, MaximumDepth);
+    }
+
+    /* Get the miss ratio in tenths of a percent */
+    if (Misses > Allocates) Misses = Allocates;
+    Ratio = (Misses * 1000) / Allocates;
+
+    /* Almost everything hits, try to give a little memory back */
+    if (Ratio < 5)
+    {
+        Target = (Depth > MINIMUM_LOOKASIDE_DEPTH) ?
+                 Depth - 1 : MINIMUM_LOOKASIDE_DEPTH;
+        return (USHORT)min(Target, MaximumDepth);
+    }
+
+    /* Grow in proportion to the misses and the room that is left */
+    Target = Depth;
+    if (Depth < MaximumDepth)
+    {
+        Target += ((Ratio * (MaximumDepth - Depth)) / (1000 * 2)) + 5;
+    }
+    return (USHORT)min(Target, MaximumDepth);
+}
+
+static
+VOID
+NTAPI
+ExpScanGeneralLookasideList(IN PLIST_ENTRY ListHead,
+                            IN PKSPIN_LOCK SpinLock OPTIONAL)
+{
+    PLIST_ENTRY ListEntry;
+    PGENERAL_LOOKASIDE Lookaside;
+    ULONG Allocates, Misses;
+    KIRQL OldIrql;
+
+    /* Lock the list if needed */
+    if (SpinLock) KeAcquireSpinLock(SpinLock, &OldIrql);
+
+    /* Loop all the lookaside lists */
+    for (ListEntry = ListHead->Flink;
+         ListEntry != ListHead;
+         ListEntry = ListEntry->Flink)
+    {
+        Lookaside = CONTAINING_RECORD(ListEntry, GENERAL_LOOKASIDE, ListEntry);
+
+        /* Get the activity since the last scan */
+        Allocates = Lookaside->TotalAllocates - Lookaside->LastTotalAllocates;
+        Misses = Lookaside->AllocateMisses - Lookaside->LastAllocateMisses;
+        Lookaside->LastTotalAllocates = Lookaside->TotalAllocates;
+        Lookaside->LastAllocateMisses = Lookaside->AllocateMisses;
+
+        /* And adjust the depth */
+        Lookaside->Depth = ExpComputeLookasideDepth(Allocates,
+                                                    Misses,
+                                                    Lookaside->MaximumDepth,
+                                                    Lookaside->Depth);
+    }
+
+    /* Release the lock */
+    if (SpinLock) KeReleaseSpinLock(SpinLock, OldIrql);
+}
+
+VOID
+ExAdjustLookasideDepth(VOID)
+{
+    /*
+     * Called once a second by the balance set manager. The pool lookaside
+     * lists count hits instead of misses and are left alone. System lists
+     * are only ever added during initialization and need no lock.
+     */
+    ExpScanGeneralLookasideList(&ExSystemLookasideListHead, NULL);
+    ExpScanGeneralLookasideList(&ExpNonPagedLookasideListHead,
+                                &ExpNonPagedLookasideListLock);
+    ExpScanGeneralLookasideList(&ExpPagedLookasideListHead,
+                                &ExpPagedLookasideListLock);
+}
+
 /* PUBLIC FUNCTIONS **********************************************************/
 
 /*
@@ -210,6 +210,53 @@ ExfWakePushLock(PEX_PUSH_LOCK PushLock,
     if (OldIrql != DISPATCH_LEVEL) KeLowerIrql(OldIrql);
 }
 
+#ifdef CONFIG_SMP
+/*++
+ * @name ExpSpinOnPushLock
+ *
+ *     The ExpSpinOnPushLock routine spins for a bounded time on a pushlock
+ *     which is held, in the hope that it gets released before we need to
+ *     queue a wait block and block.
+ *
+ * @param PushLock
+ *        Pointer to the pushlock to spin on.
+ *
+ * @param Shared
+ *        TRUE if the caller wants to acquire the pushlock shared.
+ *
+ * @return The last value of the pushlock read while spinning.
+ *
+ * @remarks The spin is abandoned as soon as the pushlock has waiters, since
+ *          it will then be handed over to them and not to a spinning thread.
+ *          Only reads are done while spinning, to keep the line shared.
+ *
+ *--*/
+FORCEINLINE
+EX_PUSH_LOCK
+ExpSpinOnPushLock(IN PEX_PUSH_LOCK PushLock,
+                  IN BOOLEAN Shared)
+{
+    EX_PUSH_LOCK Value;
+    ULONG i = ExPushLockSpinCount;
+
+    for (;;)
+    {
+        /* Read the current value */
+        Value.Ptr = *(volatile PVOID *)&PushLock->Ptr;
+
+        /* Stop if it can be acquired, or if we'd only be queued behind others */
+        if (!(Value.Locked) || (Value.Waiting)) break;
+        if ((Shared) && (Value.Shared > 0)) break;
+
+        /* Stop when the spin count runs out */
+        if (!--i) break;
+        YieldProcessor();
+    }
+
+    return Value;
+}
+#endif
+
 /*++
  * @name ExpOptimizePushLockList
  *
@@ -472,8 +519,11 @@ ExfAcquirePushLockExclusive(PEX_PUSH_LOCK PushLock)
 {
     EX_PUSH_LOCK OldValue = *PushLock, NewValue, TempValue;
     BOOLEAN NeedWake;
-    EX_PUSH_LOCK_WAIT_BLOCK Block;
+    DECLSPEC_CACHEALIGN EX_PUSH_LOCK_WAIT_BLOCK Block;
     PEX_PUSH_LOCK_WAIT_BLOCK WaitBlock = &Block;
+#ifdef CONFIG_SMP
+    BOOLEAN Spun = FALSE;
+#endif
 
     /* Start main loop */
     for (;;)
@@ -500,6 +550,16 @@ ExfAcquirePushLockExclusive(PEX_PUSH_LOCK PushLock)
         }
         else
         {
+#ifdef CONFIG_SMP
+            /* Spin once for a while before queuing, unless others already wait */
+            if ((ExPushLockSpinCount) && !(Spun) && !(OldValue.Waiting))
+            {
+                Spun = TRUE;
+                OldValue = ExpSpinOnPushLock(PushLock, FALSE);
+                continue;
+            }
+#endif
+
             /* We'll have to create a Waitblock */
             WaitBlock->Flags = EX_PUSH_LOCK_FLAGS_EXCLUSIVE |
                                EX_PUSH_LOCK_FLAGS_WAIT;
@@ -646,8 +706,11 @@ ExfAcquirePushLockShared(PEX_PUSH_LOCK PushLock)
 {
     EX_PUSH_LOCK OldValue = *PushLock, NewValue;
     BOOLEAN NeedWake;
-    EX_PUSH_LOCK_WAIT_BLOCK Block;
+    DECLSPEC_CACHEALIGN EX_PUSH_LOCK_WAIT_BLOCK Block;
     PEX_PUSH_LOCK_WAIT_BLOCK WaitBlock = &Block;
+#ifdef CONFIG_SMP
+    BOOLEAN Spun = FALSE;
+#endif
 
     /* Start main loop */
     for (;;)
@@ -687,6 +750,16 @@ ExfAcquirePushLockShared(PEX_PUSH_LOCK PushLock)
         }
         else
         {
+#ifdef CONFIG_SMP
+            /* Spin once for a while before queuing, unless others already wait */
+            if ((ExPushLockSpinCount) && !(Spun) && !(OldValue.Waiting))
+            {
+                Spun = TRUE;
+                OldValue = ExpSpinOnPushLock(PushLock, TRUE);
+                continue;
+            }
+#endif
+
             /* We'll have to create a Waitblock */
             WaitBlock->Flags = EX_PUSH_LOCK_FLAGS_WAIT;
             WaitBlock->ShareCount = 0;
@@ -691,16 +691,27 @@ QSI_DEF(SystemPerformanceInformation)
     Spi->CcPinReadWait = 0; /* FIXME */
     Spi->CcPinReadNoWaitMiss = 0; /* FIXME */
     Spi->CcPinReadWaitMiss = 0; /* FIXME */
+#ifndef NEWCC
+    Spi->CcCopyReadNoWait = CcCopyReadNoWait;
+    Spi->CcCopyReadWait = CcCopyReadWait;
+    Spi->CcCopyReadNoWaitMiss = CcCopyReadNoWaitMiss;
+    Spi->CcCopyReadWaitMiss = CcCopyReadWaitMiss;
+#else
     Spi->CcCopyReadNoWait = 0; /* FIXME */
     Spi->CcCopyReadWait = 0; /* FIXME */
     Spi->CcCopyReadNoWaitMiss = 0; /* FIXME */
     Spi->CcCopyReadWaitMiss = 0; /* FIXME */
+#endif
 
     Spi->CcMdlReadNoWait = 0; /* FIXME */
     Spi->CcMdlReadWait = 0; /* FIXME */
     Spi->CcMdlReadNoWaitMiss = 0; /* FIXME */
     Spi->CcMdlReadWaitMiss = 0; /* FIXME */
+#ifndef NEWCC
+    Spi->CcReadAheadIos = CcReadAheadIos;
+#else
     Spi->CcReadAheadIos = 0; /* FIXME */
+#endif
     Spi->CcLazyWriteIos = 0; /* FIXME */
     Spi->CcLazyWritePages = 0; /* FIXME */
     Spi->CcDataFlushes = 0; /* FIXME */
@@ -1917,6 +1928,9 @@ ExpCopyLookasideInformation(
             Info->FreeMisses = LookasideList->TotalFrees
                                - LookasideList->FreeHits;
         }
+
+        /* Move on to the next array element */
+        Info++;
     }
 
     /* Return the updated pointer and remaining count */
@@ -40,6 +40,24 @@
 // Global Cc Data
 //
 extern ULONG CcRosTraceLevel;
+extern ULONG CcCopyReadWait;
+extern ULONG CcCopyReadNoWait;
+extern ULONG CcCopyReadWaitMiss;
+extern ULONG CcCopyReadNoWaitMiss;
+extern ULONG CcReadAheadIos;
+extern ULONG CcReadAheadHits;
+
+//
+// Read ahead is done in whole views, and never further than this
+// past the end of the last read
+//
+#define CC_MAXIMUM_READ_AHEAD                           (8 * VACB_MAPPING_GRANULARITY)
+
+//
+// The VACB index is a two level sparse array, each leaf maps 16MB of a file
+//
+#define VACB_INDEX_LEAF_SHIFT                           6
+#define VACB_INDEX_LEAF_SIZE                            (1 << VACB_INDEX_LEAF_SHIFT)
 
 typedef struct _PF_SCENARIO_ID
 {
@@ -142,9 +160,14 @@ typedef struct _PFSN_PREFETCHER_GLOBALS
     LONG ActivePrefetches;
 } PFSN_PREFETCHER_GLOBALS, *PPFSN_PREFETCHER_GLOBALS;
 
+typedef struct _ROS_VACB *PROS_VACB;
+
 typedef struct _ROS_SHARED_CACHE_MAP
 {
     LIST_ENTRY CacheMapVacbListHead;
+    /* VACBs of this cache map by view number, protected by CacheMapLock */
+    PROS_VACB **VacbIndex;
+    ULONG VacbIndexSize;
     ULONG TimeStamp;
     PFILE_OBJECT FileObject;
     LARGE_INTEGER SectionSize;
@@ -153,11 +176,35 @@ typedef struct _ROS_SHARED_CACHE_MAP
     PVOID LazyWriteContext;
     KSPIN_LOCK CacheMapLock;
     ULONG RefCount;
+    ULONG Flags;
+    ULONG ReadAheadGranularity;
+    /* Read ahead request handed to the worker thread, one at a time */
+    LONG ReadAheadActive;
+    LARGE_INTEGER ReadAheadOffset;
+    ULONG ReadAheadLength;
+    WORK_QUEUE_ITEM ReadAheadWorkItem;
 #if DBG
     BOOLEAN Trace; /* enable extra trace output for this cache map and it's VACBs */
 #endif
 } ROS_SHARED_CACHE_MAP, *PROS_SHARED_CACHE_MAP;
 
+#define READAHEAD_DISABLED 0x1
+
+typedef struct _ROS_PRIVATE_CACHE_MAP
+{
+    PFILE_OBJECT FileObject;
+    PROS_SHARED_CACHE_MAP SharedCacheMap;
+    /* Protects the access history below */
+    KSPIN_LOCK ReadAheadSpinLock;
+    /* The last two reads done through this file object */
+    LARGE_INTEGER FileOffset1;
+    LARGE_INTEGER BeyondLastByte1;
+    LARGE_INTEGER FileOffset2;
+    LARGE_INTEGER BeyondLastByte2;
+    /* End of the range already scheduled for read ahead */
+    LARGE_INTEGER ReadAheadOffset;
+} ROS_PRIVATE_CACHE_MAP, *PROS_PRIVATE_CACHE_MAP;
+
 typedef struct _ROS_VACB
 {
     /* Base address of the region where the view's data is mapped. */
@@ -170,6 +217,8 @@ typedef struct _ROS_VACB
     BOOLEAN Dirty;
     /* Page out in progress */
     BOOLEAN PageOut;
+    /* Contents were brought in by read ahead and not read yet. */
+    BOOLEAN ReadAhead;
     ULONG MappedCount;
     /* Entry in the list of VACBs for this shared cache map. */
     LIST_ENTRY CacheMapVacbListEntry;
@@ -186,7 +235,7 @@ typedef struct _ROS_VACB
     /* Pointer to the shared cache map for the file which this view maps data for. */
     PROS_SHARED_CACHE_MAP SharedCacheMap;
     /* Pointer to the next VACB in a chain. */
-} ROS_VACB, *PROS_VACB;
+} ROS_VACB;
 
 typedef struct _INTERNAL_BCB
 {
@@ -304,6 +353,20 @@ CcRosReleaseVacb(
     BOOLEAN Mapped
 );
 
+VOID
+NTAPI
+CcRosReferenceVacb(
+    PROS_VACB Vacb
+);
+
+VOID
+NTAPI
+CcRosReleaseVacbByOffset(
+    PROS_SHARED_CACHE_MAP SharedCacheMap,
+    LONGLONG FileOffset,
+    BOOLEAN Dirty
+);
+
 NTSTATUS
 NTAPI
 CcRosRequestVacb(
@@ -314,6 +377,13 @@ CcRosRequestVacb(
     PROS_VACB *Vacb
 );
 
+VOID
+NTAPI
+CcRosRemoveVacbFromIndex(
+    PROS_SHARED_CACHE_MAP SharedCacheMap,
+    PROS_VACB Vacb
+);
+
 NTSTATUS
 NTAPI
 CcRosInitializeFileCache(
@@ -333,6 +403,24 @@ NTSTATUS
 NTAPI
 CcTryToInitializeFileCache(PFILE_OBJECT FileObject);
 
+/* Must be called with the cache map lock held */
+FORCEINLINE
+PROS_VACB
+CcRosGetVacbFromIndex(
+    _In_ PROS_SHARED_CACHE_MAP SharedCacheMap,
+    _In_ LONGLONG FileOffset)
+{
+    ULONGLONG View = FileOffset / VACB_MAPPING_GRANULARITY;
+    ULONGLONG Leaf = View >> VACB_INDEX_LEAF_SHIFT;
+
+    if (Leaf >= SharedCacheMap->VacbIndexSize ||
+        SharedCacheMap->VacbIndex[Leaf] == NULL)
+    {
+        return NULL;
+    }
+    return SharedCacheMap->VacbIndex[Leaf][View & (VACB_INDEX_LEAF_SIZE - 1)];
+}
+
 FORCEINLINE
 BOOLEAN
 DoRangesIntersect(
@@ -84,6 +84,13 @@
 #define CMP_HASH_IRRATIONAL                             314159269
 #define CMP_HASH_PRIME                                  1000000007
 
+//
+// KCB and NCB Hash Table Sizes (power of two, scaled with physical memory)
+//
+#define CMP_MINIMUM_HASH_TABLE_SIZE                     2048
+#define CMP_MAXIMUM_HASH_TABLE_SIZE                     65536
+#define CMP_PAGES_PER_HASH_BUCKET                       32
+
 //
 // CmpCreateKeyControlBlock Flags
 //
@@ -147,10 +154,20 @@ typedef struct _CM_KEY_HASH
     HCELL_INDEX KeyCell;
 } CM_KEY_HASH, *PCM_KEY_HASH;
 
+//
+// Hash table buckets get their own cache line on MP, so that their locks
+// don't bounce between processors working on unrelated keys
+//
+#ifdef CONFIG_SMP
+#define CM_HASH_ALIGN DECLSPEC_CACHEALIGN
+#else
+#define CM_HASH_ALIGN
+#endif
+
 //
 // Key Hash Table Entry
 //
-typedef struct _CM_KEY_HASH_TABLE_ENTRY
+typedef struct CM_HASH_ALIGN _CM_KEY_HASH_TABLE_ENTRY
 {
     EX_PUSH_LOCK Lock;
     PKTHREAD Owner;
@@ -171,7 +188,7 @@ typedef struct _CM_NAME_HASH
 //
 // Name Hash Table Entry
 //
-typedef struct _CM_NAME_HASH_TABLE_ENTRY
+typedef struct CM_HASH_ALIGN _CM_NAME_HASH_TABLE_ENTRY
 {
     EX_PUSH_LOCK Lock;
     PCM_NAME_HASH Entry;
@@ -512,6 +529,30 @@ typedef struct _CM_SYSTEM_CONTROL_VECTOR
     PULONG Type;
 } CM_SYSTEM_CONTROL_VECTOR, *PCM_SYSTEM_CONTROL_VECTOR;
 
+//
+// KCB and NCB Hash Table Statistics
+//
+typedef struct _CM_HASH_TABLE_STATISTICS
+{
+    ULONG Lookups;
+    ULONG Hits;
+    ULONG Misses;
+    ULONG ChainEntriesWalked;
+    ULONG LongestChain;
+} CM_HASH_TABLE_STATISTICS, *PCM_HASH_TABLE_STATISTICS;
+
+//
+// Lazy Flush Statistics
+//
+typedef struct _CM_LAZY_FLUSH_STATISTICS
+{
+    ULONG HivesFlushed;
+    ULONG FlushFailures;
+    ULONGLONG BytesWritten;
+    ULONGLONG TotalFlushTime;
+    ULONGLONG LongestFlushTime;
+} CM_LAZY_FLUSH_STATISTICS, *PCM_LAZY_FLUSH_STATISTICS;
+
 //
 // Structure for CmpQueryValueDataFromCache
 //
@@ -1665,6 +1706,10 @@ extern POBJECT_TYPE CmpKeyObjectType;
 extern ERESOURCE CmpRegistryLock;
 extern PCM_KEY_HASH_TABLE_ENTRY CmpCacheTable;
 extern PCM_NAME_HASH_TABLE_ENTRY CmpNameCacheTable;
+#if DBG
+extern CM_HASH_TABLE_STATISTICS CmpCacheTableStatistics;
+extern CM_HASH_TABLE_STATISTICS CmpNameCacheTableStatistics;
+#endif
 extern KGUARDED_MUTEX CmpDelayedCloseTableLock;
 extern CMHIVE CmControlHive;
 extern WCHAR CmDefaultLanguageId[];
@@ -1703,6 +1748,7 @@ extern BOOLEAN CmpProfileLoaded;
 extern PCMHIVE CmiVolatileHive;
 extern LIST_ENTRY CmiKeyObjectListHead;
 extern BOOLEAN CmpHoldLazyFlush;
+extern CM_LAZY_FLUSH_STATISTICS CmpLazyFlushStatistics;
 
 //
 // Inlined functions
@@ -51,6 +51,38 @@
 //
 #define ENUM_ROOT L"\\Registry\\Machine\\System\\CurrentControlSet\\Enum"
 
+//
+// Stack depths served by the medium and large IRP lookaside lists. The large
+// one can be raised with the LargeIrpStackLocations value in the registry.
+//
+#define IOP_MEDIUM_IRP_STACK_LOCATIONS                  4
+#define IOP_LARGE_IRP_STACK_LOCATIONS                   8
+#define IOP_MAXIMUM_LARGE_IRP_STACK_LOCATIONS           20
+
+//
+// The NDK keeps the Server 2003 per-processor lookaside numbering, so the
+// medium IRP list takes the first free PPLookasideList slot after it
+//
+#define LookasideMediumIrpList \
+    ((PP_NPAGED_LOOKASIDE_NUMBER)LookasideMaximumList)
+C_ASSERT(LookasideMaximumList <
+         RTL_NUMBER_OF_FIELD(KPRCB, PPLookasideList));
+
+//
+// Maximum number of completion packets NtRemoveIoCompletionEx hands back
+// from a single wait
+//
+#define IOP_MAXIMUM_COMPLETION_BATCH                    64
+
+//
+// Server 2003 SP2 already accepts this information class in
+// NtSetInformationFile, even though the headers only expose it for Vista
+//
+#if (NTDDI_VERSION < NTDDI_VISTA)
+#define FileIoCompletionNotificationInformation \
+    ((FILE_INFORMATION_CLASS)(FileShortNameInformation + 1))
+#endif
+
 //
 // Returns the type of METHOD_ used in this IOCTL
 //
@@ -910,6 +942,12 @@ IopAllocateIrpMustSucceed(
     IN CCHAR StackSize
 );
 
+VOID
+NTAPI
+IopRebalanceLookasideFloat(
+    VOID
+);
+
 //
 // Shutdown routines
 //
@@ -1276,6 +1314,7 @@ extern PDEVICE_NODE IopRootDeviceNode;
 extern KSPIN_LOCK IopDeviceTreeLock;
 extern ULONG IopTraceLevel;
 extern GENERAL_LOOKASIDE IopMdlLookasideList;
+extern ULONG IopLargeIrpStackLocations;
 extern GENERIC_MAPPING IopCompletionMapping;
 extern GENERIC_MAPPING IopFileMapping;
 extern POBJECT_TYPE _IoFileObjectType;
@@ -3,6 +3,8 @@
 /* Cache Manager Tags */
 #define TAG_CC                  '  cC'
 #define TAG_VACB                'aVcC'
+#define TAG_VACB_INDEX          'iVcC'
+#define TAG_CC_MDL              'dMcC'
 #define TAG_SHARED_CACHE_MAP    'cScC'
 #define TAG_PRIVATE_CACHE_MAP   'cPcC'
 #define TAG_BCB                 'cBcC'
@@ -56,8 +58,10 @@
 #define TAG_FILE_TYPE       'ELIF'
 #define TAG_ADAPTER_TYPE    'TPDA'
 #define IO_LARGEIRP         'lprI'
+#define IO_MEDIUMIRP        'mprI'
 #define IO_SMALLIRP         'sprI'
 #define IO_LARGEIRP_CPU     'LprI'
+#define IO_MEDIUMIRP_CPU    'MprI'
 #define IO_SMALLIRP_CPU     'SprI'
 #define IOC_TAG1            ' cpI'
 #define IOC_CPU             'PcpI'
@@ -2529,6 +2529,7 @@ NtSetInformationFile(IN HANDLE FileHandle,
     PIO_COMPLETION_CONTEXT Context;
     PFILE_RENAME_INFORMATION RenameInfo;
     HANDLE TargetHandle = NULL;
+    ULONG NotificationFlags;
     PAGED_CODE();
     IOTRACE(IO_API_DEBUG, "FileHandle: %p\n", FileHandle);
 
@@ -2536,7 +2537,7 @@ NtSetInformationFile(IN HANDLE FileHandle,
     if (PreviousMode != KernelMode)
     {
         /* Validate the information class */
-        if ((FileInformationClass >= FileMaximumInformation) ||
+        if ((FileInformationClass > FileIoCompletionNotificationInformation) ||
             !(IopSetOperationLength[FileInformationClass]))
         {
             /* Invalid class */
@@ -2572,7 +2573,7 @@ NtSetInformationFile(IN HANDLE FileHandle,
     else
     {
         /* Validate the information class */
-        if ((FileInformationClass >= FileMaximumInformation) ||
+        if ((FileInformationClass > FileIoCompletionNotificationInformation) ||
             !(IopSetOperationLength[FileInformationClass]))
         {
             /* Invalid class */
@@ -2597,6 +2598,58 @@ NtSetInformationFile(IN HANDLE FileHandle,
                                        NULL);
     if (!NT_SUCCESS(Status)) return Status;
 
+    /* Completion notification modes live in the file object, no IRP needed */
+    if (FileInformationClass == FileIoCompletionNotificationInformation)
+    {
+        /* Protect the read and the write in SEH */
+        _SEH2_TRY
+        {
+            /*
+             * Get the requested modes and make sure we know all of them.
+             * FILE_SKIP_SET_USER_EVENT_ON_FAST_IO is refused: our read, write
+             * and ioctl services never complete through fast I/O, so there is
+             * no path that could honor it.
+             */
+            NotificationFlags = ((PFILE_IO_COMPLETION_NOTIFICATION_INFORMATION)
+                                 FileInformation)->Flags;
+            if (NotificationFlags & ~(FILE_SKIP_COMPLETION_PORT_ON_SUCCESS |
+                                      FILE_SKIP_SET_EVENT_ON_HANDLE))
+            {
+                /* Invalid flags */
+                Status = STATUS_INVALID_PARAMETER;
+            }
+            else
+            {
+                /* The modes can only be turned on, never back off */
+                if (NotificationFlags & FILE_SKIP_COMPLETION_PORT_ON_SUCCESS)
+                {
+                    InterlockedOr((PLONG)&FileObject->Flags,
+                                  FO_SKIP_COMPLETION_PORT);
+                }
+                if (NotificationFlags & FILE_SKIP_SET_EVENT_ON_HANDLE)
+                {
+                    InterlockedOr((PLONG)&FileObject->Flags,
+                                  FO_SKIP_SET_EVENT);
+                }
+
+                /* Fill out the I/O Status Block */
+                IoStatusBlock->Information = 0;
+                Status = IoStatusBlock->Status = STATUS_SUCCESS;
+            }
+        }
+        _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
+        {
+            /* Get the exception code */
+            Status = _SEH2_GetExceptionCode();
+        }
+        _SEH2_END;
+
+        /* Update transfer count, dereference the file and return */
+        IopUpdateTransferCount(IopOtherTransfer, Length);
+        ObDereferenceObject(FileObject);
+        return Status;
+    }
+
     /* Check if this is a direct open or not */
     if (FileObject->Flags & FO_DIRECT_DEVICE_OPEN)
     {
@@ -77,8 +77,10 @@ extern KSPIN_LOCK IopTimerLock;
 extern PDEVICE_OBJECT IopErrorLogObject;
 
 GENERAL_LOOKASIDE IoLargeIrpLookaside;
+GENERAL_LOOKASIDE IoMediumIrpLookaside;
 GENERAL_LOOKASIDE IoSmallIrpLookaside;
 GENERAL_LOOKASIDE IopMdlLookasideList;
+ULONG IopLargeIrpStackLocations = IOP_LARGE_IRP_STACK_LOCATIONS;
 extern GENERAL_LOOKASIDE IoCompletionPacketLookaside;
 
 PLOADER_PARAMETER_BLOCK IopLoaderBlock;
@@ -94,17 +96,28 @@ INIT_FUNCTION
 NTAPI
 IopInitLookasideLists(VOID)
 {
-    ULONG LargeIrpSize, SmallIrpSize, MdlSize;
+    ULONG LargeIrpSize, MediumIrpSize, SmallIrpSize, MdlSize;
     LONG i;
     PKPRCB Prcb;
     PGENERAL_LOOKASIDE CurrentList = NULL;
 
+    /* Keep the registry override of the large IRP depth within bounds */
+    if (IopLargeIrpStackLocations < IOP_LARGE_IRP_STACK_LOCATIONS)
+    {
+        IopLargeIrpStackLocations = IOP_LARGE_IRP_STACK_LOCATIONS;
+    }
+    else if (IopLargeIrpStackLocations > IOP_MAXIMUM_LARGE_IRP_STACK_LOCATIONS)
+    {
+        IopLargeIrpStackLocations = IOP_MAXIMUM_LARGE_IRP_STACK_LOCATIONS;
+    }
+
     /* Calculate the sizes */
-    LargeIrpSize = sizeof(IRP) + (8 * sizeof(IO_STACK_LOCATION));
+    LargeIrpSize = sizeof(IRP) + (IopLargeIrpStackLocations * sizeof(IO_STACK_LOCATION));
+    MediumIrpSize = sizeof(IRP) + (IOP_MEDIUM_IRP_STACK_LOCATIONS * sizeof(IO_STACK_LOCATION));
     SmallIrpSize = sizeof(IRP) + sizeof(IO_STACK_LOCATION);
     MdlSize = sizeof(MDL) + (23 * sizeof(PFN_NUMBER));
 
-    /* Initialize the Lookaside List for I\O Completion */
+    /* Initialize the Lookaside List for I/O Completion */
     ExInitializeSystemLookasideList(&IoCompletionPacketLookaside,
                                     NonPagedPool,
                                     sizeof(IOP_MINI_COMPLETION_PACKET),
@@ -120,6 +133,13 @@ IopInitLookasideLists(VOID)
                                     64,
                                     &ExSystemLookasideListHead);
 
+    /* Initialize the Lookaside List for Medium IRPs */
+    ExInitializeSystemLookasideList(&IoMediumIrpLookaside,
+                                    NonPagedPool,
+                                    MediumIrpSize,
+                                    IO_MEDIUMIRP,
+                                    64,
+                                    &ExSystemLookasideListHead);
 
     /* Initialize the Lookaside List for Small IRPs */
     ExInitializeSystemLookasideList(&IoSmallIrpLookaside,
@@ -139,7 +159,7 @@ IopInitLookasideLists(VOID)
 
     /* Allocate the global lookaside list buffer */
     CurrentList = ExAllocatePoolWithTag(NonPagedPool,
-                                        4 * KeNumberProcessors *
+                                        5 * KeNumberProcessors *
                                         sizeof(GENERAL_LOOKASIDE),
                                         TAG_IO);
 
@@ -193,6 +213,26 @@ IopInitLookasideLists(VOID)
             Prcb->PPLookasideList[LookasideLargeIrpList].P = &IoLargeIrpLookaside;
         }
 
+        /* Set the Medium IRP List */
+        Prcb->PPLookasideList[LookasideMediumIrpList].L = &IoMediumIrpLookaside;
+        if (CurrentList)
+        {
+            /* Initialize the Lookaside List for Medium IRPs */
+            ExInitializeSystemLookasideList(CurrentList,
+                                            NonPagedPool,
+                                            MediumIrpSize,
+                                            IO_MEDIUMIRP_CPU,
+                                            64,
+                                            &ExSystemLookasideListHead);
+            Prcb->PPLookasideList[LookasideMediumIrpList].P = CurrentList;
+            CurrentList++;
+
+        }
+        else
+        {
+            Prcb->PPLookasideList[LookasideMediumIrpList].P = &IoMediumIrpLookaside;
+        }
+
         /* Set the Small IRP List */
         Prcb->PPLookasideList[LookasideSmallIrpList].L = &IoSmallIrpLookaside;
         if (CurrentList)
@@ -213,14 +253,14 @@ IopInitLookasideLists(VOID)
             Prcb->PPLookasideList[LookasideSmallIrpList].P = &IoSmallIrpLookaside;
         }
 
-        /* Set the MDL Completion List */
+        /* Set the MDL List */
         Prcb->PPLookasideList[LookasideMdlList].L = &IopMdlLookasideList;
         if (CurrentList)
         {
             /* Initialize the Lookaside List for MDLs */
             ExInitializeSystemLookasideList(CurrentList,
                                             NonPagedPool,
-                                            SmallIrpSize,
+                                            MdlSize,
                                             TAG_MDL,
                                             128,
                                             &ExSystemLookasideListHead);
@@ -322,8 +322,14 @@ IopCompleteRequest(IN PKAPC Apc,
           (Irp->PendingReturned) &&
           !(IsIrpSynchronous(Irp, FileObject))))
     {
-        /* Get any information we need from the FO before we kill it */
-        if ((FileObject) && (FileObject->CompletionContext))
+        /*
+         * Get any information we need from the FO before we kill it. If the
+         * request completed inline and the caller asked us not to queue a
+         * packet for that case, act as if there wasn't any port.
+         */
+        if ((FileObject) && (FileObject->CompletionContext) &&
+            ((Irp->PendingReturned) ||
+             !(FileObject->Flags & FO_SKIP_COMPLETION_PORT)))
         {
             /* Save Completion Data */
             Port = FileObject->CompletionContext->Port;
@@ -389,8 +395,14 @@ IopCompleteRequest(IN PKAPC Apc,
         }
         else if (FileObject)
         {
-            /* Signal the file object and set the status */
-            KeSetEvent(&FileObject->Event, 0, FALSE);
+            /* Signal the file object, unless the caller doesn't want that */
+            if ((FileObject->Flags & FO_SYNCHRONOUS_IO) ||
+                !(FileObject->Flags & FO_SKIP_SET_EVENT))
+            {
+                KeSetEvent(&FileObject->Event, 0, FALSE);
+            }
+
+            /* Set the status */
             FileObject->FinalStatus = Irp->IoStatus.Status;
 
             /*
@@ -534,6 +546,85 @@ IopCompleteRequest(IN PKAPC Apc,
     }
 }
 
+FORCEINLINE
+PP_NPAGED_LOOKASIDE_NUMBER
+IopGetIrpLookasideList(IN CCHAR StackSize,
+                       OUT PUSHORT Size)
+{
+    /* Single location IRPs are by far the most common, keep them small */
+    if (StackSize <= 1)
+    {
+        *Size = IoSizeOfIrp(1);
+        return LookasideSmallIrpList;
+    }
+
+    /* Then come the usual FS/volume/disk stacks */
+    if (StackSize <= IOP_MEDIUM_IRP_STACK_LOCATIONS)
+    {
+        *Size = IoSizeOfIrp(IOP_MEDIUM_IRP_STACK_LOCATIONS);
+        return LookasideMediumIrpList;
+    }
+
+    /* Everything else up to the configured depth */
+    *Size = IoSizeOfIrp(IopLargeIrpStackLocations);
+    return LookasideLargeIrpList;
+}
+
+VOID
+NTAPI
+IopRebalanceLookasideFloat(VOID)
+{
+    LONG i, Total, Target, Excess, Deficit, Pool;
+    PKPRCB Prcb;
+
+    /* Nothing to balance on UP */
+    if (KeNumberProcessors == 1) return;
+
+    /*
+     * IRPs get freed on whatever processor completes them, so the lookaside
+     * float (the number of quota charged IRPs a processor may still take from
+     * its lookaside lists) drifts towards the completing processors. Spread it
+     * evenly again. Credit is only ever moved with interlocked adds, so the
+     * total is kept even while allocations and frees keep going.
+     */
+    Total = 0;
+    for (i = 0; i < KeNumberProcessors; i++)
+    {
+        Total += KiProcessorBlock[i]->LookasideIrpFloat;
+    }
+    if (Total <= 0) return;
+    Target = Total / KeNumberProcessors;
+
+    /* Take the credit above the fair share away */
+    Pool = 0;
+    for (i = 0; i < KeNumberProcessors; i++)
+    {
+        Prcb = KiProcessorBlock[i];
+        Excess = Prcb->LookasideIrpFloat - Target;
+        if (Excess > 0)
+        {
+            InterlockedExchangeAdd(&Prcb->LookasideIrpFloat, -Excess);
+            Pool += Excess;
+        }
+    }
+
+    /* And give it to the processors that ran short */
+    for (i = 0; (i < KeNumberProcessors) && (Pool > 0); i++)
+    {
+        Prcb = KiProcessorBlock[i];
+        Deficit = Target - Prcb->LookasideIrpFloat;
+        if (Deficit > 0)
+        {
+            if (Deficit > Pool) Deficit = Pool;
+            InterlockedExchangeAdd(&Prcb->LookasideIrpFloat, Deficit);
+            Pool -= Deficit;
+        }
+    }
+
+    /* Counters moved while we were at it, keep the leftover here */
+    if (Pool > 0) InterlockedExchangeAdd(&KeGetCurrentPrcb()->LookasideIrpFloat, Pool);
+}
+
 /* FUNCTIONS *****************************************************************/
 
 /*
@@ -549,28 +640,27 @@ IoAllocateIrp(IN CCHAR StackSize,
     PKPRCB Prcb;
     UCHAR Flags = 0;
     PNPAGED_LOOKASIDE_LIST List = NULL;
-    PP_NPAGED_LOOKASIDE_NUMBER ListType = LookasideSmallIrpList;
+    PP_NPAGED_LOOKASIDE_NUMBER ListType;
 
     /* Set Charge Quota Flag */
     if (ChargeQuota) Flags |= IRP_QUOTA_CHARGED;
 
-    /* FIXME: Implement Lookaside Floats */
+    /* Get the PRCB */
+    Prcb = KeGetCurrentPrcb();
 
-    /* Figure out which Lookaside List to use */
-    if ((StackSize <= 8) && (ChargeQuota == FALSE))
+    /*
+     * Figure out if we can use a Lookaside List. Quota charged IRPs can only
+     * come from one while this processor has lookaside float left, since no
+     * quota gets charged for them.
+     */
+    if ((StackSize <= (CCHAR)IopLargeIrpStackLocations) &&
+        (!(ChargeQuota) || (Prcb->LookasideIrpFloat > 0)))
     {
         /* Set Fixed Size Flag */
-        Flags = IRP_ALLOCATED_FIXED_SIZE;
+        Flags |= IRP_ALLOCATED_FIXED_SIZE;
 
-        /* See if we should use big list */
-        if (StackSize != 1)
-        {
-            Size = IoSizeOfIrp(8);
-            ListType = LookasideLargeIrpList;
-        }
-
-        /* Get the PRCB */
-        Prcb = KeGetCurrentPrcb();
+        /* Get the list for this stack depth */
+        ListType = IopGetIrpLookasideList(StackSize, &Size);
 
         /* Get the P List First */
         List = (PNPAGED_LOOKASIDE_LIST)Prcb->PPLookasideList[ListType].P;
@@ -616,6 +706,13 @@ IoAllocateIrp(IN CCHAR StackSize,
     }
     else
     {
+        /* A quota charged IRP from lookaside uses up some of the float */
+        if (Flags & IRP_QUOTA_CHARGED)
+        {
+            Flags |= IRP_LOOKASIDE_ALLOCATION;
+            InterlockedDecrement(&Prcb->LookasideIrpFloat);
+        }
+
         /* In this case there is no charge quota */
         Flags &= ~IRP_QUOTA_CHARGED;
     }
@@ -1579,8 +1676,9 @@ NTAPI
 IoFreeIrp(IN PIRP Irp)
 {
     PNPAGED_LOOKASIDE_LIST List;
-    PP_NPAGED_LOOKASIDE_NUMBER ListType =  LookasideSmallIrpList;
+    PP_NPAGED_LOOKASIDE_NUMBER ListType;
     PKPRCB Prcb;
+    USHORT Size;
     IOTRACE(IO_IRP_DEBUG,
             "%s - Freeing IRPs %p\n",
             __FUNCTION__,
@@ -1591,19 +1689,27 @@ IoFreeIrp(IN PIRP Irp)
     ASSERT(IsListEmpty(&Irp->ThreadListEntry));
     ASSERT(Irp->CurrentLocation >= Irp->StackCount);
 
-    /* If this was a pool alloc, free it with the pool */
-    if (!(Irp->AllocationFlags & IRP_ALLOCATED_FIXED_SIZE))
+    /* Get the PRCB */
+    Prcb = KeGetCurrentPrcb();
+
+    /* Give back the lookaside float this IRP was using */
+    if (Irp->AllocationFlags & IRP_LOOKASIDE_ALLOCATION)
+    {
+        Irp->AllocationFlags &= ~IRP_LOOKASIDE_ALLOCATION;
+        InterlockedIncrement(&Prcb->LookasideIrpFloat);
+    }
+
+    /* If this was a pool alloc (or carries a quota charge), free it with the pool */
+    if (!(Irp->AllocationFlags & IRP_ALLOCATED_FIXED_SIZE) ||
+        (Irp->AllocationFlags & IRP_QUOTA_CHARGED))
     {
         /* Free it */
         ExFreePoolWithTag(Irp, TAG_IRP);
     }
     else
     {
-        /* Check if this was a Big IRP */
-        if (Irp->StackCount != 1) ListType = LookasideLargeIrpList;
-
-        /* Get the PRCB */
-        Prcb = KeGetCurrentPrcb();
+        /* Get the list it belongs to */
+        ListType = IopGetIrpLookasideList(Irp->StackCount, &Size);
 
         /* Use the P List */
         List = (PNPAGED_LOOKASIDE_LIST)Prcb->PPLookasideList[ListType].P;
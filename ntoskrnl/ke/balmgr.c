@@ -176,7 +176,10 @@ KeBalanceSetManager(IN PVOID Context)
             case STATUS_WAIT_0:
 
                 /* Adjust lookaside lists */
-                //ExAdjustLookasideDepth();
+                ExAdjustLookasideDepth();
+
+                /* Spread the IRP lookaside float over the processors again */
+                IopRebalanceLookasideFloat();
 
                 /* Call the working set manager */
                 //MmWorkingSetManager();
@@ -1179,6 +1179,11 @@ KeInvalidateAllCaches(VOID)
     return TRUE;
 }
 
+VOID
+FASTCALL
+KiXMMIZeroPagesNoSave(IN PVOID Address,
+                      IN ULONG Size);
+
 VOID
 FASTCALL
 KeZeroPages(IN PVOID Address,
@@ -1188,6 +1193,21 @@ KeZeroPages(IN PVOID Address,
     RtlZeroMemory(Address, Size);
 }
 
+VOID
+FASTCALL
+KeZeroPagesFromIdleThread(IN PVOID Address,
+                          IN ULONG Size)
+{
+    /* Nobody touches these pages soon, so keep them out of the caches */
+    if (KeFeatureBits & KF_XMMI64)
+    {
+        KiXMMIZeroPagesNoSave(Address, Size);
+        return;
+    }
+
+    RtlZeroMemory(Address, Size);
+}
+
 VOID
 NTAPI
 KiSaveProcessorState(IN PKTRAP_FRAME TrapFrame,
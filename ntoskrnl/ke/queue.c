@@ -231,12 +231,14 @@ KeReadStateQueue(IN PKQUEUE Queue)
 }
 
 /*
- * @implemented
+ * Returns either the removed entry, or the status that ended the wait
+ * (STATUS_TIMEOUT, STATUS_USER_APC or STATUS_ALERTED)
  */
 PLIST_ENTRY
 NTAPI
-KeRemoveQueue(IN PKQUEUE Queue,
+KiRemoveQueue(IN PKQUEUE Queue,
               IN KPROCESSOR_MODE WaitMode,
+              IN BOOLEAN Alertable,
               IN PLARGE_INTEGER Timeout OPTIONAL)
 {
     PLIST_ENTRY QueueEntry;
@@ -259,12 +261,14 @@ KeRemoveQueue(IN PKQUEUE Queue,
         /* It is, so next time don't do expect this */
         Thread->WaitNext = FALSE;
         KxQueueThreadWait();
+        Thread->Alertable = Alertable;
     }
     else
     {
         /* Raise IRQL to synch, prepare the wait, then lock the database */
         Thread->WaitIrql = KeRaiseIrqlToSynchLevel();
         KxQueueThreadWait();
+        Thread->Alertable = Alertable;
         KiAcquireDispatcherLockAtDpcLevel();
     }
 
@@ -344,12 +348,12 @@ KeRemoveQueue(IN PKQUEUE Queue,
             }
             else
             {
-                /* Fail if there's a User APC Pending */
-                if ((WaitMode != KernelMode) &&
-                    (Thread->ApcState.UserApcPending))
+                /* Fail if we were alerted or there's a User APC Pending */
+                Status = KiCheckAlertability(Thread, Alertable, WaitMode);
+                if (Status != STATUS_WAIT_0)
                 {
                     /* Return the status and increase the pending threads */
-                    QueueEntry = (PLIST_ENTRY)STATUS_USER_APC;
+                    QueueEntry = (PLIST_ENTRY)Status;
                     Queue->CurrentCount++;
                     break;
                 }
@@ -419,6 +423,7 @@ KeRemoveQueue(IN PKQUEUE Queue,
             /* Start another wait */
             Thread->WaitIrql = KeRaiseIrqlToSynchLevel();
             KxQueueThreadWait();
+            Thread->Alertable = Alertable;
             KiAcquireDispatcherLockAtDpcLevel();
             Queue->CurrentCount--;
         }
@@ -430,6 +435,92 @@ KeRemoveQueue(IN PKQUEUE Queue,
     return QueueEntry;
 }
 
+/*
+ * @implemented
+ */
+PLIST_ENTRY
+NTAPI
+KeRemoveQueue(IN PKQUEUE Queue,
+              IN KPROCESSOR_MODE WaitMode,
+              IN PLARGE_INTEGER Timeout OPTIONAL)
+{
+    /* Do a non-alertable wait for a single entry */
+    return KiRemoveQueue(Queue, WaitMode, FALSE, Timeout);
+}
+
+/*
+ * Returns the number of entries written to EntryArray. If the wait ended
+ * without an entry, the first (and only) element holds the wait status.
+ *
+ * @implemented
+ */
+ULONG
+NTAPI
+KeRemoveQueueEx(IN PKQUEUE Queue,
+                IN KPROCESSOR_MODE WaitMode,
+                IN BOOLEAN Alertable,
+                IN PLARGE_INTEGER Timeout OPTIONAL,
+                OUT PLIST_ENTRY *EntryArray,
+                IN ULONG Count)
+{
+    PLIST_ENTRY QueueEntry;
+    ULONG Removed;
+    KIRQL OldIrql;
+    ASSERT_QUEUE(Queue);
+    ASSERT_IRQL_LESS_OR_EQUAL(DISPATCH_LEVEL);
+    ASSERT(Count != 0);
+
+    /* Wait for the first entry like a normal removal would */
+    QueueEntry = KiRemoveQueue(Queue, WaitMode, Alertable, Timeout);
+    EntryArray[0] = QueueEntry;
+    if ((QueueEntry == (PLIST_ENTRY)STATUS_TIMEOUT) ||
+        (QueueEntry == (PLIST_ENTRY)STATUS_USER_APC) ||
+        (QueueEntry == (PLIST_ENTRY)STATUS_ALERTED) ||
+        (Count == 1))
+    {
+        /* Nothing else to grab */
+        return 1;
+    }
+
+    /*
+     * This thread is already accounted as running for the queue, so any
+     * other entry that is sitting in the queue can be handed to it as well
+     * without touching the concurrency count or waiting again.
+     */
+    OldIrql = KiAcquireDispatcherLock();
+    for (Removed = 1; Removed < Count; Removed++)
+    {
+        /* Stop once the queue is empty */
+        QueueEntry = Queue->EntryListHead.Flink;
+        if (QueueEntry == &Queue->EntryListHead) break;
+
+        /* Decrease the number of entries */
+        Queue->Header.SignalState--;
+
+        /* Check if the entry is valid. If not, bugcheck */
+        if (!(QueueEntry->Flink) || !(QueueEntry->Blink))
+        {
+            /* Invalid item */
+            KeBugCheckEx(INVALID_WORK_QUEUE_ITEM,
+                         (ULONG_PTR)QueueEntry,
+                         (ULONG_PTR)Queue,
+                         (ULONG_PTR)NULL,
+                         (ULONG_PTR)((PWORK_QUEUE_ITEM)QueueEntry)->
+                                     WorkerRoutine);
+        }
+
+        /* Remove the Entry */
+        RemoveEntryList(QueueEntry);
+        QueueEntry->Flink = NULL;
+        EntryArray[Removed] = QueueEntry;
+    }
+
+    /* Unlock Database and return */
+    KiReleaseDispatcherLock(OldIrql);
+    return Removed;
+}
+
+
 /*
  * @implemented
  */
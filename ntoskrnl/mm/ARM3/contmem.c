@@ -109,7 +109,7 @@ MiFindContiguousPages(IN PFN_NUMBER LowestPfn,
                 //
                 // Acquire the PFN lock
                 //
-                OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+                OldIrql = MiAcquirePfnLock();
                 do
                 {
                     //
@@ -164,7 +164,7 @@ MiFindContiguousPages(IN PFN_NUMBER LowestPfn,
                         //
                         // Now it's safe to let go of the PFN lock
                         //
-                        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+                        MiReleasePfnLock(OldIrql);
 
                         //
                         // Quick sanity check that the last PFN is consistent
@@ -196,7 +196,7 @@ MiFindContiguousPages(IN PFN_NUMBER LowestPfn,
                 // If we got here, something changed while we hadn't acquired
                 // the PFN lock yet, so we'll have to restart
                 //
-                KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+                MiReleasePfnLock(OldIrql);
                 Length = 0;
             }
         }
@@ -539,7 +539,7 @@ MiFreeContiguousMemory(IN PVOID BaseAddress)
     //
     // Lock the PFN database
     //
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     //
     // Loop all the pages
@@ -555,7 +555,7 @@ MiFreeContiguousMemory(IN PVOID BaseAddress)
     //
     // Release the PFN lock
     //
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 }
 
 /* PUBLIC FUNCTIONS ***********************************************************/
@@ -711,6 +711,7 @@ extern PMMPTE MmSharedUserDataPte;
 extern LIST_ENTRY MmProcessList;
 extern BOOLEAN MmZeroingPageThreadActive;
 extern KEVENT MmZeroingPageEvent;
+extern ULONG MmZeroPageThreadCount;
 extern ULONG MmSystemPageColor;
 extern ULONG MmProcessColorSeed;
 extern PMMWSL MmWorkingSetList;
@@ -733,6 +734,103 @@ extern ULONG_PTR MmSubsectionBase;
 extern LARGE_INTEGER MmCriticalSectionTimeout;
 extern LIST_ENTRY MmWorkingSetExpansionHead;
 
+#if DBG
+//
+// PFN lock usage statistics, only ever updated with the lock held
+//
+typedef struct _MI_PFN_LOCK_STATISTICS
+{
+    ULONG Acquires;
+    ULONGLONG AcquireTime;
+    ULONGLONG TotalHoldTime;
+    ULONGLONG MaximumHoldTime;
+} MI_PFN_LOCK_STATISTICS, *PMI_PFN_LOCK_STATISTICS;
+
+extern MI_PFN_LOCK_STATISTICS MiPfnLockStatistics;
+#endif
+
+//
+// Zero page thread statistics, only ever updated with the PFN lock held
+//
+typedef struct _MI_ZERO_PAGE_STATISTICS
+{
+    ULONG Batches;
+    PFN_NUMBER PagesZeroed;
+    PFN_NUMBER LowestZeroedDepth;
+} MI_ZERO_PAGE_STATISTICS, *PMI_ZERO_PAGE_STATISTICS;
+
+extern MI_ZERO_PAGE_STATISTICS MiZeroPageStatistics;
+extern PFN_NUMBER MiCachedZeroPages;
+
+#if DBG
+#if defined(_M_IX86) || defined(_M_AMD64)
+#define MI_PFN_LOCK_TIMESTAMP() __rdtsc()
+#else
+#define MI_PFN_LOCK_TIMESTAMP() 0
+#endif
+
+FORCEINLINE
+VOID
+MiPfnLockAcquired(VOID)
+{
+    MiPfnLockStatistics.Acquires++;
+    MiPfnLockStatistics.AcquireTime = MI_PFN_LOCK_TIMESTAMP();
+}
+
+FORCEINLINE
+VOID
+MiPfnLockReleasing(VOID)
+{
+    ULONGLONG HoldTime;
+
+    HoldTime = MI_PFN_LOCK_TIMESTAMP() - MiPfnLockStatistics.AcquireTime;
+    MiPfnLockStatistics.TotalHoldTime += HoldTime;
+    if (HoldTime > MiPfnLockStatistics.MaximumHoldTime)
+    {
+        MiPfnLockStatistics.MaximumHoldTime = HoldTime;
+    }
+}
+#else
+#define MiPfnLockAcquired()
+#define MiPfnLockReleasing()
+#endif
+
+FORCEINLINE
+KIRQL
+MiAcquirePfnLock(VOID)
+{
+    KIRQL OldIrql;
+
+    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    MiPfnLockAcquired();
+    return OldIrql;
+}
+
+FORCEINLINE
+VOID
+MiReleasePfnLock(
+    _In_ KIRQL OldIrql)
+{
+    MiPfnLockReleasing();
+    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+}
+
+FORCEINLINE
+VOID
+MiAcquirePfnLockAtDpcLevel(VOID)
+{
+    KeAcquireQueuedSpinLockAtDpcLevel(&KeGetCurrentPrcb()->LockQueue[LockQueuePfnLock]);
+    MiPfnLockAcquired();
+}
+
+FORCEINLINE
+VOID
+MiReleasePfnLockFromDpcLevel(VOID)
+{
+    MiPfnLockReleasing();
+    KeReleaseQueuedSpinLockFromDpcLevel(&KeGetCurrentPrcb()->LockQueue[LockQueuePfnLock]);
+}
+
 FORCEINLINE
 BOOLEAN
 MiIsMemoryTypeFree(TYPE_OF_MEMORY MemoryType)
@@ -2025,6 +2123,24 @@ MiRemoveZeroPage(
     IN ULONG Color
 );
 
+PFN_NUMBER
+NTAPI
+MiRemoveZeroPageFromCache(
+    VOID
+);
+
+VOID
+NTAPI
+MiRefillPageCache(
+    VOID
+);
+
+VOID
+NTAPI
+MiDrainPageCaches(
+    VOID
+);
+
 VOID
 NTAPI
 MiZeroPhysicalPage(
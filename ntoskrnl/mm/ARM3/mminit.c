@@ -950,7 +950,7 @@ MiBuildPfnDatabaseFromLoaderBlock(IN PLOADER_PARAMETER_BLOCK LoaderBlock)
                 Pfn1 = MiGetPfnEntry(PageFrameIndex);
 
                 /* Lock the PFN Database */
-                OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+                OldIrql = MiAcquirePfnLock();
                 while (PageCount--)
                 {
                     /* If the page really has no references, mark it as free */
@@ -967,7 +967,7 @@ MiBuildPfnDatabaseFromLoaderBlock(IN PLOADER_PARAMETER_BLOCK LoaderBlock)
                 }
 
                 /* Release PFN database */
-                KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+                MiReleasePfnLock(OldIrql);
 
                 /* Done with this block */
                 break;
@@ -1139,7 +1139,7 @@ MmFreeLoaderBlock(IN PLOADER_PARAMETER_BLOCK LoaderBlock)
     }
 
     /* Acquire the PFN lock */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* Loop the runs */
     LoaderPages = 0;
@@ -1181,7 +1181,7 @@ MmFreeLoaderBlock(IN PLOADER_PARAMETER_BLOCK LoaderBlock)
 
     /* Release the PFN lock and flush the TLB */
     DPRINT("Loader pages freed: %lx\n", LoaderPages);
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
     KeFlushCurrentTb();
 
     /* Free our run structure */
@@ -1564,6 +1564,20 @@ MmDumpArmPfnDatabase(IN BOOLEAN StatusOnly)
 
     DbgPrint("Active:               %5d pages\t[%6d KB]\n", ActivePages,  (ActivePages    << PAGE_SHIFT) / 1024);
     DbgPrint("Free:                 %5d pages\t[%6d KB]\n", FreePages,    (FreePages      << PAGE_SHIFT) / 1024);
+    OtherPages = MmZeroedPageListHead.Total;
+    DbgPrint("Zeroed:               %5d pages\t[%6d KB]\n", OtherPages,   (OtherPages     << PAGE_SHIFT) / 1024);
+    OtherPages = (ULONG)MiCachedZeroPages;
+    DbgPrint("Zeroed (cached):      %5d pages\t[%6d KB]\n", OtherPages,   (OtherPages     << PAGE_SHIFT) / 1024);
+    DbgPrint("Zero page thread:     %5lu pages in %lu batches, lowest zeroed depth %lu\n",
+             (ULONG)MiZeroPageStatistics.PagesZeroed,
+             MiZeroPageStatistics.Batches,
+             (ULONG)MiZeroPageStatistics.LowestZeroedDepth);
+#if DBG
+    DbgPrint("PFN lock:             %5lu acquires, held %I64u cycles total, %I64u longest\n",
+             MiPfnLockStatistics.Acquires,
+             MiPfnLockStatistics.TotalHoldTime,
+             MiPfnLockStatistics.MaximumHoldTime);
+#endif
     DbgPrint("-----------------------------------------\n");
 #if MI_TRACE_PFNS
     OtherPages = UsageBucket[MI_USAGE_BOOT_DRIVER];
@@ -1813,7 +1827,7 @@ MiBuildPagedPool(VOID)
     //
     // Lock the PFN database
     //
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
 #if (_MI_PAGING_LEVELS >= 3)
     /* On these systems, there's no double-mapping, so instead, the PPEs
@@ -1874,7 +1888,7 @@ MiBuildPagedPool(VOID)
     //
     // Release the PFN database lock
     //
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 
     //
     // We only have one PDE mapped for now... at fault time, additional PDEs
@@ -2144,7 +2158,7 @@ MmArmInitSystem(IN ULONG Phase,
         KeInitializeMutant(&MmSystemLoadLock, FALSE);
 
         /* Set the zero page event */
-        KeInitializeEvent(&MmZeroingPageEvent, SynchronizationEvent, FALSE);
+        KeInitializeEvent(&MmZeroingPageEvent, NotificationEvent, FALSE);
         MmZeroingPageThreadActive = FALSE;
 
         /* Initialize the dead stack S-LIST */
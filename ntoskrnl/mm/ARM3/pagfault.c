@@ -573,8 +573,11 @@ MiResolveDemandZeroFault(IN PVOID Address,
     if (OldIrql == MM_NOIRQL)
     {
         /* Acquire it and remember we should release it after */
-        OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        OldIrql = MiAcquirePfnLock();
         HaveLock = TRUE;
+
+        /* Process pages can come from this processor's zeroed page cache */
+        if (Color != 0xFFFFFFFF) PageFrameNumber = MiRemoveZeroPageFromCache();
     }
 
     /* We either manually locked the PFN DB, or already came with it locked */
@@ -592,16 +595,29 @@ MiResolveDemandZeroFault(IN PVOID Address,
     if (!Process) MI_SET_PROCESS2("Kernel Demand 0");
 
     /* Do we need a zero page? */
-    if (Color != 0xFFFFFFFF)
+    if (PageFrameNumber)
+    {
+        /* We got one from the cache, it is already zeroed */
+        NeedZero = FALSE;
+    }
+    else if (Color != 0xFFFFFFFF)
     {
         /* Try to get one, if we couldn't grab a free page and zero it */
         PageFrameNumber = MiRemoveZeroPageSafe(Color);
-        if (!PageFrameNumber)
+        if (PageFrameNumber)
+        {
+            /* Pages on the zeroed list don't need to be zeroed again */
+            NeedZero = FALSE;
+        }
+        else
         {
             /* We'll need a free page and zero it manually */
             PageFrameNumber = MiRemoveAnyPage(Color);
             NeedZero = TRUE;
         }
+
+        /* Refill the cache while we hold the lock, so the next faults skip the lists */
+        MiRefillPageCache();
     }
     else
     {
@@ -626,7 +642,7 @@ MiResolveDemandZeroFault(IN PVOID Address,
     if (HaveLock)
     {
         /* Release it */
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
 
         /* Update performance counters */
         if (Process > HYDRA_PROCESS) Process->NumberOfPrivatePages++;
@@ -759,7 +775,7 @@ MiCompleteProtoPteFault(IN BOOLEAN StoreInstruction,
     }
 
     /* Release the PFN lock */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 
     /* Remove special/caching bits */
     Protection &= ~MM_PROTECT_SPECIAL;
@@ -859,13 +875,13 @@ MiResolvePageFileFault(_In_ BOOLEAN StoreInstruction,
     MI_WRITE_INVALID_PTE(PointerPte, TempPte);
 
     /* Release the PFN lock while we proceed */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, *OldIrql);
+    MiReleasePfnLock(*OldIrql);
 
     /* Do the paging IO */
     Status = MiReadPageFile(Page, PageFileIndex, PageFileOffset);
 
     /* Lock the PFN database again */
-    *OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    *OldIrql = MiAcquirePfnLock();
 
     /* Nobody should have changed that while we were not looking */
     ASSERT(Pfn1->u1.Event == &Event);
@@ -1073,7 +1089,7 @@ MiResolveProtoPteFault(IN BOOLEAN StoreInstruction,
     {
         /* Release the lock */
         DPRINT1("Access on reserved section?\n");
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
         return STATUS_ACCESS_VIOLATION;
     }
 
@@ -1154,6 +1170,88 @@ MiResolveProtoPteFault(IN BOOLEAN StoreInstruction,
                                    OutPfn);
 }
 
+/* Number of PTEs looked at for fault-around on a prototype PTE fault */
+#define MI_PROTO_FAULT_CLUSTER  8
+
+static
+PFN_COUNT
+MiMapResidentProtoPtes(IN PMMVAD Vad,
+                       IN PMMPTE PointerPte,
+                       IN PMMPTE PointerProtoPte)
+{
+    MMPTE TempPte, ProtoPte;
+    PMMPFN Pfn1, Pfn2;
+    PFN_NUMBER PageFrameIndex;
+    ULONG_PTR Vpn, Protection;
+    PFN_COUNT Count, MappedPtes = 0;
+    KIRQL OldIrql;
+
+    /* Don't go past the end of the VAD or of its prototype PTEs */
+    Vpn = (ULONG_PTR)MiPteToAddress(PointerPte) >> PAGE_SHIFT;
+    Count = (PFN_COUNT)min(Vad->EndingVpn - Vpn, MI_PROTO_FAULT_CLUSTER - 1);
+
+    OldIrql = MiAcquirePfnLock();
+
+    while (Count--)
+    {
+        PointerPte++;
+        PointerProtoPte++;
+        if (PointerProtoPte > Vad->LastContiguousPte) break;
+
+        /* Stay in this page table and in the paged pool page holding the prototype PTEs */
+        if (MiIsPteOnPdeBoundary(PointerPte) || MiIsPteOnPdeBoundary(PointerProtoPte)) break;
+
+        /* Only pick up cached pages which are resident right now */
+        ProtoPte = *PointerProtoPte;
+        if (ProtoPte.u.Hard.Valid == 0) break;
+        if (MI_PFN_ELEMENT(PFN_FROM_PTE(&ProtoPte))->u3.e1.CacheAttribute != MiCached) break;
+
+        /* The PTE must be untouched, or point to its VAD's prototype PTE */
+        TempPte = *PointerPte;
+        if (TempPte.u.Long == 0)
+        {
+            Protection = Vad->u.VadFlags.Protection;
+        }
+        else if ((TempPte.u.Hard.Valid == 0) &&
+                 (TempPte.u.Soft.Prototype == 1) &&
+                 (TempPte.u.Soft.PageFileHigh == MI_PTE_LOOKUP_NEEDED))
+        {
+            Protection = TempPte.u.Soft.Protection;
+        }
+        else
+        {
+            break;
+        }
+
+        /* Leave anything which needs special handling to a real fault */
+        if ((Protection == MM_NOACCESS) ||
+            (Protection & MM_PROTECT_SPECIAL) ||
+            ((Protection & MM_WRITECOPY) == MM_WRITECOPY))
+        {
+            break;
+        }
+
+        /* An untouched PTE is a new reference on the page table */
+        if (TempPte.u.Long == 0) MiIncrementPageTableReferences(MiPteToAddress(PointerPte));
+
+        /* One more user of the page, and one more valid PTE in the page table */
+        PageFrameIndex = PFN_FROM_PTE(&ProtoPte);
+        Pfn1 = MI_PFN_ELEMENT(PageFrameIndex);
+        Pfn1->u2.ShareCount++;
+        Pfn1->u3.e1.PrototypePte = 1;
+        Pfn2 = MI_PFN_ELEMENT(MiAddressToPte(PointerPte)->u.Hard.PageFrameNumber);
+        Pfn2->u2.ShareCount++;
+
+        /* Build a clean user PTE, like MiCompleteProtoPteFault does for a read */
+        MI_MAKE_HARDWARE_PTE_USER(&TempPte, PointerPte, Protection, PageFrameIndex);
+        MI_WRITE_VALID_PTE(PointerPte, TempPte);
+        MappedPtes++;
+    }
+
+    MiReleasePfnLock(OldIrql);
+    return MappedPtes;
+}
+
 NTSTATUS
 NTAPI
 MiDispatchFault(IN BOOLEAN StoreInstruction,
@@ -1172,6 +1270,7 @@ MiDispatchFault(IN BOOLEAN StoreInstruction,
     PMMPFN Pfn1, OutPfn = NULL;
     PFN_NUMBER PageFrameIndex;
     PFN_COUNT PteCount, ProcessedPtes;
+    BOOLEAN FaultAround = FALSE;
     DPRINT("ARM3 Page Fault Dispatcher for address: %p in process: %p\n",
              Address,
              Process);
@@ -1202,7 +1301,7 @@ MiDispatchFault(IN BOOLEAN StoreInstruction,
         if (Address >= MmSystemRangeStart)
         {
             /* Lock the PFN database */
-            LockIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+            LockIrql = MiAcquirePfnLock();
 
             /* Has the PTE been made valid yet? */
             if (!SuperProtoPte->u.Hard.Valid)
@@ -1243,9 +1342,9 @@ MiDispatchFault(IN BOOLEAN StoreInstruction,
                 (Vad->u.VadFlags.VadType != VadImageMap) &&
                 !(Vad->u2.VadFlags2.ExtendableFile))
             {
-                /* One day, ReactOS will cluster faults */
+                /* Map the resident neighbours too once the fault is resolved */
                 ASSERT(Address <= MM_HIGHEST_USER_ADDRESS);
-                DPRINT("Should cluster fault, but won't\n");
+                FaultAround = TRUE;
             }
 
             /* Only one PTE to handle for now */
@@ -1253,7 +1352,7 @@ MiDispatchFault(IN BOOLEAN StoreInstruction,
             ProcessedPtes = 0;
 
             /* Lock the PFN database */
-            LockIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+            LockIrql = MiAcquirePfnLock();
 
             /* We only handle the valid path */
             ASSERT(SuperProtoPte->u.Hard.Valid == 1);
@@ -1356,6 +1455,9 @@ MiDispatchFault(IN BOOLEAN StoreInstruction,
                 /* Loop all the processing we did */
                 ASSERT(ProcessedPtes == 0);
 
+                /* Fault around the page we just mapped */
+                if (FaultAround) MiMapResidentProtoPtes(Vad, PointerPte, PointerProtoPte);
+
                 /* Complete this as a transition fault */
                 ASSERT(OldIrql == KeGetCurrentIrql());
                 ASSERT(OldIrql <= APC_LEVEL);
@@ -1389,14 +1491,20 @@ MiDispatchFault(IN BOOLEAN StoreInstruction,
             {
                 /* We had a locked PFN, so acquire the PFN lock to dereference it */
                 ASSERT(PointerProtoPte != NULL);
-                OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+                OldIrql = MiAcquirePfnLock();
 
                 /* Dereference the locked PFN */
                 MiDereferencePfnAndDropLockCount(OutPfn);
                 ASSERT(OutPfn->u3.e2.ReferenceCount >= 1);
 
                 /* And now release the lock */
-                KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+                MiReleasePfnLock(OldIrql);
+            }
+
+            /* Fault around the page we just mapped */
+            if ((FaultAround) && NT_SUCCESS(Status))
+            {
+                MiMapResidentProtoPtes(Vad, PointerPte, PointerProtoPte);
             }
 
             /* Complete this as a transition fault */
@@ -1412,7 +1520,7 @@ MiDispatchFault(IN BOOLEAN StoreInstruction,
     {
         PVOID InPageBlock = NULL;
         /* Lock the PFN database */
-        LockIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        LockIrql = MiAcquirePfnLock();
 
         /* Resolve */
         Status = MiResolveTransitionFault(Address, PointerPte, Process, LockIrql, &InPageBlock);
@@ -1420,7 +1528,7 @@ MiDispatchFault(IN BOOLEAN StoreInstruction,
         NT_ASSERT(NT_SUCCESS(Status));
 
         /* And now release the lock and leave*/
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, LockIrql);
+        MiReleasePfnLock(LockIrql);
 
         if (InPageBlock != NULL)
         {
@@ -1438,13 +1546,13 @@ MiDispatchFault(IN BOOLEAN StoreInstruction,
     if (TempPte.u.Soft.PageFileHigh != 0)
     {
         /* Lock the PFN database */
-        LockIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        LockIrql = MiAcquirePfnLock();
 
         /* Resolve */
         Status = MiResolvePageFileFault(StoreInstruction, Address, PointerPte, Process, &LockIrql);
 
         /* And now release the lock and leave*/
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, LockIrql);
+        MiReleasePfnLock(LockIrql);
 
         ASSERT(OldIrql == KeGetCurrentIrql());
         ASSERT(OldIrql <= APC_LEVEL);
@@ -1628,7 +1736,7 @@ MmArmAccessFault(IN BOOLEAN StoreInstruction,
             if (!IsSessionAddress)
             {
                 /* Check if the PTE is still valid under PFN lock */
-                OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+                OldIrql = MiAcquirePfnLock();
                 TempPte = *PointerPte;
                 if (TempPte.u.Hard.Valid)
                 {
@@ -1651,7 +1759,7 @@ MmArmAccessFault(IN BOOLEAN StoreInstruction,
                 }
 
                 /* Release PFN lock and return all good */
-                KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+                MiReleasePfnLock(OldIrql);
                 return STATUS_SUCCESS;
             }
         }
@@ -2097,7 +2205,7 @@ UserFault:
             }
 
             /* Lock the PFN database since we're going to grab a page */
-            OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+            OldIrql = MiAcquirePfnLock();
 
             /* Make sure we have enough pages */
             ASSERT(MmAvailablePages >= 32);
@@ -2114,20 +2222,20 @@ UserFault:
                 ASSERT(PageFrameIndex);
 
                 /* Release the lock since we need to do some zeroing */
-                KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+                MiReleasePfnLock(OldIrql);
 
                 /* Zero out the page, since it's for user-mode */
                 MiZeroPfn(PageFrameIndex);
 
                 /* Grab the lock again so we can initialize the PFN entry */
-                OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+                OldIrql = MiAcquirePfnLock();
             }
 
             /* Initialize the PFN entry now */
             MiInitializePfn(PageFrameIndex, PointerPte, 1);
 
             /* And we're done with the lock */
-            KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+            MiReleasePfnLock(OldIrql);
 
             /* Increment the count of pages in the process */
             CurrentProcess->NumberOfPrivatePages++;
@@ -29,6 +29,20 @@ do { \
 #define ASSERT_LIST_INVARIANT(x)
 #endif
 
+//
+// Each processor keeps a few zeroed pages off the lists, so that the demand
+// zero fault path doesn't have to search the colored lists for them. The
+// caches are only touched with the PFN lock held, so any processor can give
+// all of them back, and their pages still count as available.
+//
+#define MI_PAGE_CACHE_DEPTH 15
+
+typedef struct _MI_PAGE_CACHE
+{
+    DECLSPEC_CACHEALIGN ULONG Count;
+    PFN_NUMBER Pages[MI_PAGE_CACHE_DEPTH];
+} MI_PAGE_CACHE, *PMI_PAGE_CACHE;
+
 /* GLOBALS ********************************************************************/
 
 BOOLEAN MmDynamicPfn;
@@ -63,6 +77,12 @@ PMMPFNLIST MmPageLocationList[] =
 ULONG MI_PFN_CURRENT_USAGE;
 CHAR MI_PFN_CURRENT_PROCESS_NAME[16] = "None yet";
 
+#if DBG
+MI_PFN_LOCK_STATISTICS MiPfnLockStatistics;
+#endif
+static MI_PAGE_CACHE MiPageCache[MAXIMUM_PROCESSORS];
+PFN_NUMBER MiCachedZeroPages;
+
 /* FUNCTIONS ******************************************************************/
 
 static
@@ -483,6 +503,12 @@ MiRemoveAnyPage(IN ULONG Color)
     ASSERT(MmAvailablePages != 0);
     ASSERT(Color < MmSecondaryColors);
 
+    /* Pages held in the processor caches are available too, get them back */
+    if ((MmFreePageListHead.Total == 0) && (MmZeroedPageListHead.Total == 0))
+    {
+        MiDrainPageCaches();
+    }
+
     /* Check the colored free list */
     PageIndex = MmFreePagesByColor[FreePageList][Color].Flink;
     if (PageIndex == LIST_HEAD)
@@ -540,6 +566,12 @@ MiRemoveZeroPage(IN ULONG Color)
     ASSERT(MmAvailablePages != 0);
     ASSERT(Color < MmSecondaryColors);
 
+    /* Pages held in the processor caches are available too, get them back */
+    if ((MmFreePageListHead.Total == 0) && (MmZeroedPageListHead.Total == 0))
+    {
+        MiDrainPageCaches();
+    }
+
     /* Check the colored zero list */
     PageIndex = MmFreePagesByColor[ZeroedPageList][Color].Flink;
     if (PageIndex == LIST_HEAD)
@@ -597,6 +629,85 @@ MiRemoveZeroPage(IN ULONG Color)
     return PageIndex;
 }
 
+PFN_NUMBER
+NTAPI
+MiRemoveZeroPageFromCache(VOID)
+{
+    PMI_PAGE_CACHE PageCache;
+
+    /* Make sure the PFN lock is held */
+    ASSERT(KeGetCurrentIrql() == DISPATCH_LEVEL);
+    PageCache = &MiPageCache[KeGetCurrentProcessorNumber()];
+
+    /* Return zero when it is empty, the caller takes the regular path */
+    if (PageCache->Count == 0) return 0;
+
+    /* The page only stops being available now */
+    MiCachedZeroPages--;
+    MiDecrementAvailablePages();
+    return PageCache->Pages[--PageCache->Count];
+}
+
+VOID
+NTAPI
+MiRefillPageCache(VOID)
+{
+    PMI_PAGE_CACHE PageCache;
+    PFN_NUMBER PageFrameIndex;
+
+    /* Make sure the PFN lock is held */
+    ASSERT(KeGetCurrentIrql() == DISPATCH_LEVEL);
+
+    /* Don't sit on zeroed pages when memory gets tight or the list ran dry */
+    if ((MmAvailablePages <= MmPlentyFreePages) ||
+        (MmZeroedPageListHead.Total == 0))
+    {
+        MiDrainPageCaches();
+        return;
+    }
+
+    /* Fill the cache in one go */
+    PageCache = &MiPageCache[KeGetCurrentProcessorNumber()];
+    while ((PageCache->Count < MI_PAGE_CACHE_DEPTH) &&
+           (MmZeroedPageListHead.Total != 0))
+    {
+        /* Spread the pages over the colors, skipping the empty ones */
+        PageFrameIndex = MiRemoveZeroPageSafe(MI_GET_NEXT_COLOR());
+        if (!PageFrameIndex) continue;
+
+        /* Cached pages are still available */
+        PageCache->Pages[PageCache->Count++] = PageFrameIndex;
+        MiCachedZeroPages++;
+        MiIncrementAvailablePages();
+    }
+}
+
+VOID
+NTAPI
+MiDrainPageCaches(VOID)
+{
+    PMI_PAGE_CACHE PageCache;
+    ULONG i;
+
+    /* Make sure the PFN lock is held */
+    ASSERT(KeGetCurrentIrql() == DISPATCH_LEVEL);
+
+    /* Loop the processor caches until they are all empty */
+    for (i = 0; (i < KeNumberProcessors) && (MiCachedZeroPages != 0); i++)
+    {
+        PageCache = &MiPageCache[i];
+        while (PageCache->Count != 0)
+        {
+            /* The page is already counted as available, and reinserting it
+               counts it once more */
+            MiCachedZeroPages--;
+            MmAvailablePages--;
+            MiInsertPageInList(&MmZeroedPageListHead,
+                               PageCache->Pages[--PageCache->Count]);
+        }
+    }
+}
+
 VOID
 NTAPI
 MiInsertPageInFreeList(IN PFN_NUMBER PageFrameIndex)
@@ -1094,13 +1205,13 @@ MiInitializeAndChargePfn(OUT PPFN_NUMBER PageFrameIndex,
     TempPte = SessionAllocation ? ValidKernelPdeLocal : ValidKernelPde;
 
     /* Lock the PFN database */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* Make sure nobody is racing us */
     if (PointerPde->u.Hard.Valid == 1)
     {
         /* Return special error if that was the case */
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
         return STATUS_RETRY;
     }
 
@@ -1116,7 +1227,7 @@ MiInitializeAndChargePfn(OUT PPFN_NUMBER PageFrameIndex,
     ASSERT(MI_PFN_ELEMENT(*PageFrameIndex)->u1.WsIndex == 0);
 
     /* Release the lock and return success */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
     return STATUS_SUCCESS;
 }
 
@@ -223,7 +223,7 @@ MmDeleteKernelStack(IN PVOID StackBase,
                                 KERNEL_LARGE_STACK_SIZE : KERNEL_STACK_SIZE);
 
     /* Acquire the PFN lock */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     //
     // Loop them
@@ -265,7 +265,7 @@ MmDeleteKernelStack(IN PVOID StackBase,
     ASSERT(PointerPte->u.Hard.Valid == 0);
 
     /* Release the PFN lock */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 
     //
     // Release the PTEs
@@ -350,7 +350,7 @@ MmCreateKernelStack(IN BOOLEAN GuiStack,
     //
     // Acquire the PFN DB lock
     //
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     //
     // Loop each stack page
@@ -379,7 +379,7 @@ MmCreateKernelStack(IN BOOLEAN GuiStack,
     //
     // Release the PFN lock
     //
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 
     //
     // Return the stack address
@@ -441,7 +441,7 @@ MmGrowKernelStackEx(IN PVOID StackPointer,
     //
     // Acquire the PFN DB lock
     //
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     //
     // Loop each stack page
@@ -467,7 +467,7 @@ MmGrowKernelStackEx(IN PVOID StackPointer,
     //
     // Release the PFN lock
     //
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 
     //
     // Set the new limit
@@ -933,7 +933,7 @@ MmInitializeProcessAddressSpace(IN PEPROCESS Process,
     Process->VadRoot.BalancedRoot.u1.Parent = &Process->VadRoot.BalancedRoot;
 
     /* Lock PFN database */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* Setup the PFN for the PDE base of this process */
 #ifdef _M_AMD64
@@ -972,7 +972,7 @@ MmInitializeProcessAddressSpace(IN PEPROCESS Process,
     ASSERT(Process->PhysicalVadRoot == NULL);
 
     /* Release PFN lock */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 
     /* Lock the VAD, ARM3-owned ranges away */
     MiRosTakeOverSharedUserPage(Process);
@@ -1106,7 +1106,7 @@ MmCreateProcessAddressSpace(IN ULONG MinWs,
     KeInitializeSpinLock(&Process->HyperSpaceLock);
 
     /* Lock PFN database */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* Get a zero page for the PDE, if possible */
     Color = MI_GET_NEXT_PROCESS_COLOR(Process);
@@ -1118,9 +1118,9 @@ MmCreateProcessAddressSpace(IN ULONG MinWs,
         PdeIndex = MiRemoveAnyPage(Color);
 
         /* Zero it outside the PFN lock */
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
         MiZeroPhysicalPage(PdeIndex);
-        OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        OldIrql = MiAcquirePfnLock();
     }
 
     /* Get a zero page for hyperspace, if possible */
@@ -1133,9 +1133,9 @@ MmCreateProcessAddressSpace(IN ULONG MinWs,
         HyperIndex = MiRemoveAnyPage(Color);
 
         /* Zero it outside the PFN lock */
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
         MiZeroPhysicalPage(HyperIndex);
-        OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        OldIrql = MiAcquirePfnLock();
     }
 
     /* Get a zero page for the woring set list, if possible */
@@ -1148,13 +1148,13 @@ MmCreateProcessAddressSpace(IN ULONG MinWs,
         WsListIndex = MiRemoveAnyPage(Color);
 
         /* Zero it outside the PFN lock */
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
         MiZeroPhysicalPage(WsListIndex);
     }
     else
     {
         /* Release the PFN lock */
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
     }
 
     /* Switch to phase 1 initialization */
@@ -1345,7 +1345,7 @@ MmDeleteProcessAddressSpace2(IN PEPROCESS Process)
     //ASSERT(Process->CommitCharge == 0);
 
     /* Acquire the PFN lock */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* Check for fully initialized process */
     if (Process->AddressSpaceInitialized == 2)
@@ -1389,7 +1389,7 @@ MmDeleteProcessAddressSpace2(IN PEPROCESS Process)
     }
 
     /* Release the PFN lock */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 
     /* Drop a reference on the session */
     if (Process->Session) MiReleaseProcessReferenceToSessionDataPage(Process->Session);
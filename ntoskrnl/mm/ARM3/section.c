@@ -499,7 +499,7 @@ MiFillSystemPageDirectory(IN PVOID Base,
     while (PointerPde <= LastPde)
     {
         /* Lock the PFN database */
-        OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        OldIrql = MiAcquirePfnLock();
 
         /* Check if we don't already have this PDE mapped */
         if (SystemMapPde->u.Hard.Valid == 0)
@@ -533,7 +533,7 @@ MiFillSystemPageDirectory(IN PVOID Base,
         }
 
         /* Release the lock and keep going with the next PDE */
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
         SystemMapPde++;
         PointerPde++;
     }
@@ -550,7 +550,7 @@ MiCheckPurgeAndUpMapCount(IN PCONTROL_AREA ControlArea,
     ASSERT(FailIfSystemViews == FALSE);
 
     /* Lock the PFN database */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* State not yet supported */
     ASSERT(ControlArea->u.Flags.BeingPurged == 0);
@@ -561,7 +561,7 @@ MiCheckPurgeAndUpMapCount(IN PCONTROL_AREA ControlArea,
     ASSERT(ControlArea->NumberOfSectionReferences != 0);
 
     /* Release the PFN lock and return success */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
     return STATUS_SUCCESS;
 }
 
@@ -633,7 +633,7 @@ MiSegmentDelete(IN PSEGMENT Segment)
     LastPte = PointerPte + Segment->NonExtendedPtes;
 
     /* Lock the PFN database */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* Check if the master PTE is invalid */
     PteForProto = MiAddressToPte(PointerPte);
@@ -716,7 +716,7 @@ MiSegmentDelete(IN PSEGMENT Segment)
     }
 
     /* Release the PFN lock */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 
     /* Free the structures */
     ExFreePool(ControlArea);
@@ -747,7 +747,7 @@ MiCheckControlArea(IN PCONTROL_AREA ControlArea,
     }
 
     /* Release the PFN lock */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 
     /* Delete the segment if needed */
     if (DeleteSegment)
@@ -765,7 +765,7 @@ MiDereferenceControlArea(IN PCONTROL_AREA ControlArea)
     KIRQL OldIrql;
 
     /* Lock the PFN database */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* Drop reference counts */
     ControlArea->NumberOfMappedViews--;
@@ -802,7 +802,7 @@ MiRemoveMappedView(IN PEPROCESS CurrentProcess,
     MiUnlockProcessWorkingSetUnsafe(CurrentProcess, CurrentThread);
 
     /* Lock the PFN database */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* Remove references */
     ControlArea->NumberOfMappedViews--;
@@ -985,7 +985,7 @@ MiSessionCommitPageTables(IN PVOID StartVa,
             ASSERT(MmAvailablePages >= 32);
 
             /* Acquire the PFN lock and grab a zero page */
-            OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+            OldIrql = MiAcquirePfnLock();
             Color = (++MmSessionSpace->Color) & MmSecondaryColorMask;
             PageFrameNumber = MiRemoveZeroPage(Color);
             TempPte.u.Hard.PageFrameNumber = PageFrameNumber;
@@ -1001,7 +1001,7 @@ MiSessionCommitPageTables(IN PVOID StartVa,
                                            MmSessionSpace->SessionPageDirectoryIndex);
 
             /* And now release the lock */
-            KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+            MiReleasePfnLock(OldIrql);
 
             /* Get the PFN entry and make sure there's no event for it */
             Pfn1 = MI_PFN_ELEMENT(PageFrameNumber);
@@ -1135,11 +1135,11 @@ MiSetControlAreaSymbolsLoaded(IN PCONTROL_AREA ControlArea)
 
     ASSERT(KeGetCurrentIrql() <= APC_LEVEL);
 
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
     ControlArea->u.Flags.DebugSymbolsLoaded |= 1;
 
     ASSERT(OldIrql <= APC_LEVEL);
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
     ASSERT(KeGetCurrentIrql() <= APC_LEVEL);
 }
 
@@ -1877,7 +1877,7 @@ MiFlushTbAndCapture(IN PMMVAD FoundVad,
                               PointerPte,
                               ProtectionMask,
                               PreviousPte.u.Hard.PageFrameNumber);
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     //
     // We don't support I/O mappings in this path yet
@@ -1945,7 +1945,7 @@ MiFlushTbAndCapture(IN PMMVAD FoundVad,
     //
     // Release the PFN lock, we are done
     //
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+    MiReleasePfnLock(OldIrql);
 }
 
 //
@@ -2152,7 +2152,7 @@ MiRemoveMappedPtes(IN PVOID BaseAddress,
             PointerPde = MiAddressToPte(PointerPte);
 
             /* Lock the PFN database and make sure this isn't a mapped file */
-            OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+            OldIrql = MiAcquirePfnLock();
             ASSERT(((Pfn1->u3.e1.PrototypePte) && (Pfn1->OriginalPte.u.Soft.Prototype)) == 0);
 
             /* Mark the page as modified accordingly */
@@ -2181,7 +2181,7 @@ MiRemoveMappedPtes(IN PVOID BaseAddress,
             MiDecrementShareCount(Pfn1, PFN_FROM_PTE(&PteContents));
 
             /* Release the PFN lock */
-            KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+            MiReleasePfnLock(OldIrql);
         }
         else
         {
@@ -2211,7 +2211,7 @@ MiRemoveMappedPtes(IN PVOID BaseAddress,
     KeFlushCurrentTb();
 
     /* Acquire the PFN lock */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     /* Decrement the accounting counters */
     ControlArea->NumberOfUserReferences--;
@@ -2407,7 +2407,7 @@ MmCreateArm3Section(OUT PVOID *SectionObject,
         }
 
         /* Lock the PFN database while we play with the section pointers */
-        OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        OldIrql = MiAcquirePfnLock();
 
         /* Image-file backed sections are not yet supported */
         ASSERT((AllocationAttributes & SEC_IMAGE) == 0);
@@ -2422,7 +2422,7 @@ MmCreateArm3Section(OUT PVOID *SectionObject,
         File->SectionObjectPointer->DataSectionObject = ControlArea;
 
         /* We can release the PFN lock now */
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
 
         /* We don't support previously-mapped file */
         ASSERT(NewSegment == NULL);
@@ -2480,7 +2480,7 @@ MmCreateArm3Section(OUT PVOID *SectionObject,
         ASSERT(File != NULL);
 
         /* Acquire the PFN lock while we set control area flags */
-        OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        OldIrql = MiAcquirePfnLock();
 
         /* We don't support this race condition yet, so assume no waiters */
         ASSERT(ControlArea->WaitingForDeletion == NULL);
@@ -2492,7 +2492,7 @@ MmCreateArm3Section(OUT PVOID *SectionObject,
 
         /* Take off the being created flag, and then release the lock */
         ControlArea->u.Flags.BeingCreated = FALSE;
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
     }
 
     /* Check if we locked the file earlier */
@@ -3048,7 +3048,7 @@ MiDeleteARM3Section(PVOID ObjectBody)
     SectionObject = (PSECTION)ObjectBody;
 
     /* Lock the PFN database */
-    OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    OldIrql = MiAcquirePfnLock();
 
     ASSERT(SectionObject->Segment);
     ASSERT(SectionObject->Segment->ControlArea);
@@ -264,13 +264,13 @@ MmAllocateSpecialPool(SIZE_T NumberOfBytes, ULONG Tag, POOL_TYPE PoolType, ULONG
         MiSpecialPagesNonPaged > MiSpecialPagesNonPagedMaximum)*/
 
     /* Lock PFN database */
-    Irql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+    Irql = MiAcquirePfnLock();
 
     /* Reject allocation in case amount of available pages is too small */
     if (MmAvailablePages < 0x100)
     {
         /* Release the PFN database lock */
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, Irql);
+        MiReleasePfnLock(Irql);
         DPRINT1("Special pool: MmAvailablePages 0x%x is too small\n", MmAvailablePages);
         return NULL;
     }
@@ -283,7 +283,7 @@ MmAllocateSpecialPool(SIZE_T NumberOfBytes, ULONG Tag, POOL_TYPE PoolType, ULONG
         {
             /* No reserves left, reject this allocation */
             static int once;
-            KeReleaseQueuedSpinLock(LockQueuePfnLock, Irql);
+            MiReleasePfnLock(Irql);
             if (!once++) DPRINT1("Special pool: No PTEs left!\n");
             return NULL;
         }
@@ -307,7 +307,7 @@ MmAllocateSpecialPool(SIZE_T NumberOfBytes, ULONG Tag, POOL_TYPE PoolType, ULONG
     MiInitializePfnAndMakePteValid(PageFrameNumber, PointerPte, TempPte);
 
     /* Release the PFN database lock */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, Irql);
+    MiReleasePfnLock(Irql);
 
     /* Put some content into the page. Low value of tick count would do */
     Entry = MiPteToAddress(PointerPte);
@@ -546,7 +546,7 @@ MmFreeSpecialPool(PVOID P)
         Pfn = MI_PFN_ELEMENT(PointerPte->u.Hard.PageFrameNumber);
 
         /* Lock PFN database */
-        Irql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        Irql = MiAcquirePfnLock();
 
         /* Delete this PFN */
         MI_SET_PFN_DELETED(Pfn);
@@ -566,7 +566,7 @@ MmFreeSpecialPool(PVOID P)
         MiDeleteSystemPageableVm(PointerPte, 1, 0, NULL);
 
         /* Lock PFN database */
-        Irql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        Irql = MiAcquirePfnLock();
     }
 
     /* Mark next PTE as invalid */
@@ -583,7 +583,7 @@ MmFreeSpecialPool(PVOID P)
     MiSpecialPoolLastPte = PointerPte;
 
     /* Release the PFN database lock */
-    KeReleaseQueuedSpinLock(LockQueuePfnLock, Irql);
+    MiReleasePfnLock(Irql);
 }
 
 VOID
@@ -20,6 +20,24 @@
 BOOLEAN MmZeroingPageThreadActive;
 KEVENT MmZeroingPageEvent;
 
+/* Number of zeroing workers, zero means one per processor */
+ULONG MmZeroPageThreadCount;
+MI_ZERO_PAGE_STATISTICS MiZeroPageStatistics;
+
+/* Pages pulled off the free list and mapped together on each pass */
+#define MI_ZERO_PAGE_BATCH      (MI_ZERO_PTES - 1)
+
+/* Each worker owns its own zeroing PTEs, so the number of workers is bounded */
+#define MI_MAXIMUM_ZERO_PAGE_THREADS    16
+
+typedef struct _MI_ZERO_PAGE_WORKER
+{
+    PMMPTE ZeroingPte;
+    ULONG Processor;
+} MI_ZERO_PAGE_WORKER, *PMI_ZERO_PAGE_WORKER;
+
+static MI_ZERO_PAGE_WORKER MiZeroPageWorkers[MI_MAXIMUM_ZERO_PAGE_THREADS];
+
 /* PRIVATE FUNCTIONS **********************************************************/
 
 VOID
@@ -32,22 +50,22 @@ NTAPI
 MiFreeInitializationCode(IN PVOID StartVa,
 IN PVOID EndVa);
 
+static
 VOID
-NTAPI
-MmZeroPageThread(VOID)
+MiZeroPageLoop(IN PMI_ZERO_PAGE_WORKER Worker)
 {
     PKTHREAD Thread = KeGetCurrentThread();
-    PVOID StartAddress, EndAddress;
     PVOID WaitObjects[2];
     KIRQL OldIrql;
     PVOID ZeroAddress;
-    PFN_NUMBER PageIndex, FreePage;
-    PMMPFN Pfn1;
+    PFN_NUMBER PageIndex, FreePage, PageCount;
+    PMMPFN Pfn1, FirstPfn;
 
-    /* Get the discardable sections to free them */
-    MiFindInitializationCode(&StartAddress, &EndAddress);
-    if (StartAddress) MiFreeInitializationCode(StartAddress, EndAddress);
-    DPRINT("Free non-cache pages: %lx\n", MmAvailablePages + MiMemoryConsumers[MC_CACHE].PagesUsed);
+    /*
+     * The zeroing PTEs are only flushed from the local TLB when they wrap
+     * around, so each worker must stay on its own processor.
+     */
+    KeSetSystemAffinityThread(AFFINITY_MASK(Worker->Processor));
 
     /* Set our priority to 0 */
     Thread->BasePriority = 0;
@@ -67,46 +85,150 @@ MmZeroPageThread(VOID)
                                  FALSE,
                                  NULL,
                                  NULL);
-        OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        OldIrql = MiAcquirePfnLock();
+
+        /* Remember how far the zeroed list had drained before we got here */
+        if (MmZeroedPageListHead.Total < MiZeroPageStatistics.LowestZeroedDepth)
+        {
+            MiZeroPageStatistics.LowestZeroedDepth = MmZeroedPageListHead.Total;
+        }
+
         while (TRUE)
         {
             if (!MmFreePageListHead.Total)
             {
+                /* Every worker goes back to sleep until more pages get freed */
                 MmZeroingPageThreadActive = FALSE;
-                KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+                KeClearEvent(&MmZeroingPageEvent);
+                MiReleasePfnLock(OldIrql);
                 break;
             }
 
-            PageIndex = MmFreePageListHead.Flink;
-            ASSERT(PageIndex != LIST_HEAD);
-            Pfn1 = MiGetPfnEntry(PageIndex);
-            MI_SET_USAGE(MI_USAGE_ZERO_LOOP);
-            MI_SET_PROCESS2("Kernel 0 Loop");
-            FreePage = MiRemoveAnyPage(MI_GET_PAGE_COLOR(PageIndex));
+            /* Grab a batch of free pages, chained through their PFN entries */
+            FirstPfn = (PMMPFN)LIST_HEAD;
+            PageCount = 0;
+            while ((PageCount < MI_ZERO_PAGE_BATCH) && (MmFreePageListHead.Total))
+            {
+                PageIndex = MmFreePageListHead.Flink;
+                ASSERT(PageIndex != LIST_HEAD);
+                Pfn1 = MiGetPfnEntry(PageIndex);
+                MI_SET_USAGE(MI_USAGE_ZERO_LOOP);
+                MI_SET_PROCESS2("Kernel 0 Loop");
+                FreePage = MiRemoveAnyPage(MI_GET_PAGE_COLOR(PageIndex));
+
+                /* The first global free page should also be the first on its own list */
+                if (FreePage != PageIndex)
+                {
+                    KeBugCheckEx(PFN_LIST_CORRUPT,
+                                 0x8F,
+                                 FreePage,
+                                 PageIndex,
+                                 0);
+                }
+
+                Pfn1->u1.Flink = (ULONG_PTR)FirstPfn;
+                FirstPfn = Pfn1;
+                PageCount++;
+            }
+            MiReleasePfnLock(OldIrql);
 
-            /* The first global free page should also be the first on its own list */
-            if (FreePage != PageIndex)
+            /* Map the whole batch at once and clear it */
+            ZeroAddress = MiMapPagesInZeroSpace(Worker->ZeroingPte, FirstPfn, PageCount);
+            ASSERT(ZeroAddress);
+            KeZeroPagesFromIdleThread(ZeroAddress, PageCount << PAGE_SHIFT);
+            MiUnmapPagesInZeroSpace(ZeroAddress, PageCount);
+
+            OldIrql = MiAcquirePfnLock();
+
+            /* Hand the batch over to the zeroed list */
+            while (FirstPfn != (PMMPFN)LIST_HEAD)
             {
-                KeBugCheckEx(PFN_LIST_CORRUPT,
-                             0x8F,
-                             FreePage,
-                             PageIndex,
-                             0);
+                Pfn1 = FirstPfn;
+                FirstPfn = (PMMPFN)Pfn1->u1.Flink;
+                MiInsertPageInList(&MmZeroedPageListHead, MiGetPfnEntryIndex(Pfn1));
             }
 
-            Pfn1->u1.Flink = LIST_HEAD;
-            KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+            MiZeroPageStatistics.Batches++;
+            MiZeroPageStatistics.PagesZeroed += PageCount;
+        }
+    }
+}
 
-            ZeroAddress = MiMapPagesInZeroSpace(Pfn1, 1);
-            ASSERT(ZeroAddress);
-            RtlZeroMemory(ZeroAddress, PAGE_SIZE);
-            MiUnmapPagesInZeroSpace(ZeroAddress, 1);
+static
+VOID
+NTAPI
+MiZeroPageWorkerThread(IN PVOID Context)
+{
+    /* Secondary workers just run the zeroing loop */
+    MiZeroPageLoop(Context);
+}
 
-            OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+static
+VOID
+MiCreateZeroPageWorkers(VOID)
+{
+    ULONG Count, i;
+    PMMPTE ZeroingPte;
+    HANDLE ThreadHandle;
+    NTSTATUS Status;
+
+    /* Default to one worker per processor */
+    Count = MmZeroPageThreadCount;
+    if ((Count == 0) || (Count > (ULONG)KeNumberProcessors))
+    {
+        Count = KeNumberProcessors;
+    }
+    Count = min(Count, MI_MAXIMUM_ZERO_PAGE_THREADS);
+
+    /* The boot thread becomes the first worker and uses the boot zeroing PTEs */
+    MiZeroPageWorkers[0].ZeroingPte = MiFirstReservedZeroingPte;
+    MiZeroPageWorkers[0].Processor = 0;
+    MiZeroPageStatistics.LowestZeroedDepth = MmZeroedPageListHead.Total;
 
-            MiInsertPageInList(&MmZeroedPageListHead, PageIndex);
+    for (i = 1; i < Count; i++)
+    {
+        /* Reserve this worker's zeroing PTEs, with the counter at maximum */
+        ZeroingPte = MiReserveSystemPtes(MI_ZERO_PTES, SystemPteSpace);
+        if (!ZeroingPte) break;
+        RtlZeroMemory(ZeroingPte, MI_ZERO_PTES * sizeof(MMPTE));
+        ZeroingPte->u.Hard.PageFrameNumber = MI_ZERO_PTES - 1;
+
+        MiZeroPageWorkers[i].ZeroingPte = ZeroingPte;
+        MiZeroPageWorkers[i].Processor = i;
+
+        Status = PsCreateSystemThread(&ThreadHandle,
+                                      THREAD_ALL_ACCESS,
+                                      NULL,
+                                      NULL,
+                                      NULL,
+                                      MiZeroPageWorkerThread,
+                                      &MiZeroPageWorkers[i]);
+        if (!NT_SUCCESS(Status))
+        {
+            DPRINT1("Failed to create zero page worker %lu: %lx\n", i, Status);
+            MiReleaseSystemPtes(ZeroingPte, MI_ZERO_PTES, SystemPteSpace);
+            break;
         }
+        ZwClose(ThreadHandle);
     }
+
+    DPRINT("Started %lu zero page workers\n", i);
+}
+
+VOID
+NTAPI
+MmZeroPageThread(VOID)
+{
+    PVOID StartAddress, EndAddress;
+
+    /* Get the discardable sections to free them */
+    MiFindInitializationCode(&StartAddress, &EndAddress);
+    if (StartAddress) MiFreeInitializationCode(StartAddress, EndAddress);
+    DPRINT("Free non-cache pages: %lx\n", MmAvailablePages + MiMemoryConsumers[MC_CACHE].PagesUsed);
+
+    /* Start the secondary workers, then become the first one */
+    MiCreateZeroPageWorkers();
+    MiZeroPageLoop(&MiZeroPageWorkers[0]);
 }
 
 /* EOF */
@@ -379,7 +379,7 @@ MiBalancerThread(PVOID Unused)
                 PEPROCESS Process = PsGetCurrentProcess();
 
                 /* Acquire PFN lock */
-                KIRQL OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+                KIRQL OldIrql = MiAcquirePfnLock();
                 PMMPDE pointerPde;
                 for (Address = (ULONG_PTR)MI_LOWEST_VAD_ADDRESS;
                         Address < (ULONG_PTR)MM_HIGHEST_VAD_ADDRESS;
@@ -394,7 +394,7 @@ MiBalancerThread(PVOID Unused)
                     }
                 }
                 /* Release lock */
-                KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+                MiReleasePfnLock(OldIrql);
             }
 #endif
             do
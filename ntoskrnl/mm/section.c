@@ -1276,6 +1276,224 @@ MiReadPage(PMEMORY_AREA MemoryArea,
 }
 #endif
 
+/* Number of pages brought in around a section view fault */
+#define MI_SECTION_FAULT_CLUSTER    8
+
+static
+PVOID
+MiGetSectionFaultClusterEnd(PMEMORY_AREA MemoryArea,
+                            PMM_REGION Region,
+                            PVOID RegionBaseAddress,
+                            PVOID PAddress)
+{
+    ULONG_PTR ClusterEnd;
+
+    /*
+     * Stay inside the view and inside the region, so that every page of the
+     * cluster gets the protection of the faulting one.
+     */
+    ClusterEnd = (ULONG_PTR)PAddress + MI_SECTION_FAULT_CLUSTER * PAGE_SIZE;
+    ClusterEnd = min(ClusterEnd, (ULONG_PTR)MemoryArea->EndingAddress);
+    ClusterEnd = min(ClusterEnd, (ULONG_PTR)RegionBaseAddress + Region->Length);
+    return (PVOID)ClusterEnd;
+}
+
+static
+ULONG
+MiClaimSectionReadCluster(PEPROCESS Process,
+                          PMEMORY_AREA MemoryArea,
+                          PVOID PAddress,
+                          PVOID ClusterEnd,
+                          PLARGE_INTEGER Offset)
+/*
+ * FUNCTION: Mark the pages following a faulting page as being read in, so
+ * they can be brought in along with it. Called with the segment locked.
+ * RETURNS: The number of pages claimed after the faulting one.
+ */
+{
+    PMM_SECTION_SEGMENT Segment = MemoryArea->Data.SectionData.Segment;
+    BOOLEAN IsImageSection;
+    LARGE_INTEGER PageOffset;
+    LONGLONG View;
+    PVOID Address;
+    ULONG Count = 0;
+
+    IsImageSection = MemoryArea->Data.SectionData.Section->AllocationAttributes & SEC_IMAGE ? TRUE : FALSE;
+    View = (Offset->QuadPart + Segment->Image.FileOffset) / VACB_MAPPING_GRANULARITY;
+    Address = (PCHAR)PAddress + PAGE_SIZE;
+    PageOffset.QuadPart = Offset->QuadPart + PAGE_SIZE;
+
+    while (Address < ClusterEnd)
+    {
+        /* Image pages past the raw data are zero filled, not read */
+        if (IsImageSection &&
+            (PageOffset.QuadPart >= (LONGLONG)PAGE_ROUND_UP(Segment->RawLength.QuadPart)))
+        {
+            break;
+        }
+
+        /* Only cluster pages which come from the same cache view, that's a single read */
+        if ((PageOffset.QuadPart + Segment->Image.FileOffset) / VACB_MAPPING_GRANULARITY != View)
+        {
+            break;
+        }
+
+        /* The page must be neither in memory nor being handled by someone else */
+        if ((MmGetPageEntrySectionSegment(Segment, &PageOffset) != 0) ||
+            MmIsPagePresent(Process, Address) ||
+            MmIsPageSwapEntry(Process, Address) ||
+            MmIsDisabledPage(Process, Address))
+        {
+            break;
+        }
+
+        MmSetPageEntrySectionSegment(Segment, &PageOffset, MAKE_SWAP_SSE(MM_WAIT_ENTRY));
+        Count++;
+
+        Address = (PCHAR)Address + PAGE_SIZE;
+        PageOffset.QuadPart += PAGE_SIZE;
+    }
+
+    return Count;
+}
+
+static
+ULONG
+MiReadSectionCluster(PMEMORY_AREA MemoryArea,
+                     LONGLONG SegOffset,
+                     ULONG Count,
+                     PPFN_NUMBER Pages)
+/*
+ * FUNCTION: Read the pages claimed by MiClaimSectionReadCluster. The
+ * faulting page has already been read, so its cache view is up to date.
+ * RETURNS: The number of pages successfully read.
+ */
+{
+    ULONG i;
+
+    for (i = 0; i < Count; i++)
+    {
+        /* Stop at the first failure, the remaining pages will just fault later */
+        if (!NT_SUCCESS(MiReadPage(MemoryArea, SegOffset + (i + 1) * PAGE_SIZE, &Pages[i])))
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+static
+VOID
+MiMapSectionCluster(PEPROCESS Process,
+                    PMM_SECTION_SEGMENT Segment,
+                    PVOID PAddress,
+                    PLARGE_INTEGER Offset,
+                    ULONG Count,
+                    ULONG ReadCount,
+                    PPFN_NUMBER Pages,
+                    ULONG Attributes)
+/*
+ * FUNCTION: Map the pages read by MiReadSectionCluster and release the
+ * claim on the ones which could not be read.
+ */
+{
+    LARGE_INTEGER PageOffset;
+    SWAPENTRY FakeSwapEntry;
+    PVOID Address;
+    NTSTATUS Status;
+    ULONG i;
+
+    for (i = 0; i < Count; i++)
+    {
+        Address = (PCHAR)PAddress + (i + 1) * PAGE_SIZE;
+        PageOffset.QuadPart = Offset->QuadPart + (i + 1) * PAGE_SIZE;
+
+        MmLockSectionSegment(Segment);
+        MmSetPageEntrySectionSegment(Segment,
+                                     &PageOffset,
+                                     (i < ReadCount) ? MAKE_SSE(Pages[i] << PAGE_SHIFT, 1) : 0);
+        MmUnlockSectionSegment(Segment);
+
+        MmDeletePageFileMapping(Process, Address, &FakeSwapEntry);
+        if (i >= ReadCount) continue;
+
+        Status = MmCreateVirtualMapping(Process,
+                                        Address,
+                                        Attributes,
+                                        &Pages[i],
+                                        1);
+        if (!NT_SUCCESS(Status))
+        {
+            DPRINT1("Unable to create virtual mapping\n");
+            KeBugCheck(MEMORY_MANAGEMENT);
+        }
+        MmInsertRmap(Pages[i], Process, Address);
+    }
+}
+
+static
+VOID
+MiMapResidentSectionPages(PEPROCESS Process,
+                          PMEMORY_AREA MemoryArea,
+                          PVOID PAddress,
+                          PVOID ClusterEnd,
+                          PLARGE_INTEGER Offset,
+                          ULONG Attributes)
+/*
+ * FUNCTION: Map the pages following a faulting page which are already in
+ * memory, saving a fault for each of them.
+ */
+{
+    PMM_SECTION_SEGMENT Segment = MemoryArea->Data.SectionData.Segment;
+    LARGE_INTEGER PageOffset;
+    ULONG_PTR Entry;
+    PFN_NUMBER Page;
+    PVOID Address;
+    NTSTATUS Status;
+
+    Address = (PCHAR)PAddress + PAGE_SIZE;
+    PageOffset.QuadPart = Offset->QuadPart + PAGE_SIZE;
+
+    while (Address < ClusterEnd)
+    {
+        if (MmIsPagePresent(Process, Address) ||
+            MmIsPageSwapEntry(Process, Address) ||
+            MmIsDisabledPage(Process, Address))
+        {
+            break;
+        }
+
+        MmLockSectionSegment(Segment);
+        Entry = MmGetPageEntrySectionSegment(Segment, &PageOffset);
+        if ((Entry == 0) ||
+            IS_SWAP_FROM_SSE(Entry) ||
+            (SHARE_COUNT_FROM_SSE(Entry) == MAX_SHARE_COUNT))
+        {
+            MmUnlockSectionSegment(Segment);
+            break;
+        }
+        Page = PFN_FROM_SSE(Entry);
+        MmSharePageEntrySectionSegment(Segment, &PageOffset);
+        MmUnlockSectionSegment(Segment);
+
+        Status = MmCreateVirtualMapping(Process,
+                                        Address,
+                                        Attributes,
+                                        &Page,
+                                        1);
+        if (!NT_SUCCESS(Status))
+        {
+            DPRINT1("Unable to create virtual mapping\n");
+            KeBugCheck(MEMORY_MANAGEMENT);
+        }
+        MmInsertRmap(Page, Process, Address);
+
+        Address = (PCHAR)Address + PAGE_SIZE;
+        PageOffset.QuadPart += PAGE_SIZE;
+    }
+}
+
 NTSTATUS
 NTAPI
 MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
@@ -1296,6 +1514,10 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
     PVOID PAddress;
     PEPROCESS Process = MmGetAddressSpaceOwner(AddressSpace);
     SWAPENTRY SwapEntry;
+    PVOID RegionBaseAddress, ClusterEnd;
+    PFN_NUMBER ClusterPages[MI_SECTION_FAULT_CLUSTER - 1];
+    ULONG ClusterCount, ClusterReadCount, i;
+    BOOLEAN ZeroFill;
 
     /*
      * There is a window between taking the page fault and locking the
@@ -1328,8 +1550,9 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
     Section = MemoryArea->Data.SectionData.Section;
     Region = MmFindRegion(MemoryArea->StartingAddress,
                           &MemoryArea->Data.SectionData.RegionListHead,
-                          Address, NULL);
+                          Address, &RegionBaseAddress);
     ASSERT(Region != NULL);
+    ClusterEnd = MiGetSectionFaultClusterEnd(MemoryArea, Region, RegionBaseAddress, PAddress);
     /*
      * Lock the segment
      */
@@ -1491,17 +1714,38 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
          * locked the segment) then we need to load the page.
          */
 
+        ZeroFill = (Segment->Flags & MM_PAGEFILE_SEGMENT) ||
+                   ((Offset.QuadPart >= (LONGLONG)PAGE_ROUND_UP(Segment->RawLength.QuadPart) &&
+                     (Section->AllocationAttributes & SEC_IMAGE)));
+
         /*
-         * Release all our locks and read in the page from disk
+         * Pages read from the file also claim the following pages of the same
+         * cache view, so that they all come in with a single read.
          */
         MmSetPageEntrySectionSegment(Segment, &Offset, MAKE_SWAP_SSE(MM_WAIT_ENTRY));
+        ClusterCount = 0;
+        if (!ZeroFill)
+        {
+            ClusterCount = MiClaimSectionReadCluster(Process,
+                                                     MemoryArea,
+                                                     PAddress,
+                                                     ClusterEnd,
+                                                     &Offset);
+        }
+
+        /*
+         * Release all our locks and read in the page from disk
+         */
         MmUnlockSectionSegment(Segment);
         MmCreatePageFileMapping(Process, PAddress, MM_WAIT_ENTRY);
+        for (i = 1; i <= ClusterCount; i++)
+        {
+            MmCreatePageFileMapping(Process, (PCHAR)PAddress + i * PAGE_SIZE, MM_WAIT_ENTRY);
+        }
         MmUnlockAddressSpace(AddressSpace);
 
-        if ((Segment->Flags & MM_PAGEFILE_SEGMENT) ||
-                ((Offset.QuadPart >= (LONGLONG)PAGE_ROUND_UP(Segment->RawLength.QuadPart) &&
-                  (Section->AllocationAttributes & SEC_IMAGE))))
+        ClusterReadCount = 0;
+        if (ZeroFill)
         {
             MI_SET_USAGE(MI_USAGE_SECTION);
             if (Process) MI_SET_PROCESS2(Process->ImageFileName);
@@ -1520,6 +1764,14 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
             {
                 DPRINT1("MiReadPage failed (Status %x)\n", Status);
             }
+            else if (ClusterCount)
+            {
+                /* The view is in the cache now, the rest of the cluster is cheap */
+                ClusterReadCount = MiReadSectionCluster(MemoryArea,
+                                                        Offset.QuadPart,
+                                                        ClusterCount,
+                                                        ClusterPages);
+            }
         }
         if (!NT_SUCCESS(Status))
         {
@@ -1530,6 +1782,14 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
              * Cleanup and release locks
              */
             MmLockAddressSpace(AddressSpace);
+            MiMapSectionCluster(Process,
+                                Segment,
+                                PAddress,
+                                &Offset,
+                                ClusterCount,
+                                0,
+                                ClusterPages,
+                                Attributes);
             MiSetPageEvent(Process, Address);
             DPRINT("Address 0x%p\n", Address);
             return(Status);
@@ -1561,6 +1821,16 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
         ASSERT(MmIsPagePresent(Process, PAddress));
         MmInsertRmap(Page, Process, Address);
 
+        /* Map the rest of the cluster, releasing whatever could not be read */
+        MiMapSectionCluster(Process,
+                            Segment,
+                            PAddress,
+                            &Offset,
+                            ClusterCount,
+                            ClusterReadCount,
+                            ClusterPages,
+                            Attributes);
+
         MiSetPageEvent(Process, Address);
         DPRINT("Address 0x%p\n", Address);
         return(STATUS_SUCCESS);
@@ -1659,6 +1929,15 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
             KeBugCheck(MEMORY_MANAGEMENT);
         }
         MmInsertRmap(Page, Process, Address);
+
+        /* Fault around: map the neighbours which are in memory as well */
+        MiMapResidentSectionPages(Process,
+                                  MemoryArea,
+                                  PAddress,
+                                  ClusterEnd,
+                                  &Offset,
+                                  Attributes);
+
         MiSetPageEvent(Process, Address);
         DPRINT("Address 0x%p\n", Address);
         return(STATUS_SUCCESS);
@@ -1989,9 +2268,9 @@ MmPageOutSectionView(PMMSUPPORT AddressSpace,
     }
     else
     {
-        OldIrql = KeAcquireQueuedSpinLock(LockQueuePfnLock);
+        OldIrql = MiAcquirePfnLock();
         MmReferencePage(Page);
-        KeReleaseQueuedSpinLock(LockQueuePfnLock, OldIrql);
+        MiReleasePfnLock(OldIrql);
     }
 
     MmDeleteAllRmaps(Page, (PVOID)&Context, MmPageOutDeleteMapping);
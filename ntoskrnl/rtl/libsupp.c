@@ -96,6 +96,13 @@ RtlpGetMode()
    return KernelMode;
 }
 
+ULONG
+NTAPI
+RtlpGetAffinityHint(VOID)
+{
+    return KeGetCurrentProcessorNumber();
+}
+
 PVOID
 NTAPI
 RtlpAllocateMemory(ULONG Bytes,
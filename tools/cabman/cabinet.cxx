@@ -20,7 +20,9 @@
 #include <string.h>
 #if !defined(_WIN32)
 # include <dirent.h>
+# include <pthread.h>
 # include <sys/stat.h>
+# include <sys/time.h>
 # include <sys/types.h>
 #endif
 #include "cabinet.h"
@@ -62,6 +64,17 @@ static bool _ReadFileData(FILEHANDLE handle, void* buffer, ULONG size, PULONG by
 
 #ifndef CAB_READ_ONLY
 
+static ULONG GetMilliseconds()
+{
+#if defined(_WIN32)
+    return GetTickCount();
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (ULONG)(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+#endif
+}
+
 #if 0
 #if DBG
 
@@ -341,6 +354,14 @@ CCabinet::CCabinet()
     BytesLeftInBlock = 0;
     ReuseBlock       = false;
     CurrentDataNode  = NULL;
+
+    CompressThreads    = 1;
+    CompressBlocks     = NULL;
+    CompressBlockCount = 0;
+    QueuedBlocks       = 0;
+    UncompressedBytes  = 0;
+    CompressedBytes    = 0;
+    WriteTime          = 0;
 }
 
 
@@ -1438,6 +1459,28 @@ bool CCabinet::IsCodecSelected()
     return CodecSelected;
 }
 
+static CCABCodec* NewCodec(LONG Id)
+/*
+ * FUNCTION: Creates an instance of a codec engine
+ * ARGUMENTS:
+ *     Id = Codec identifier
+ * RETURNS:
+ *     Pointer to codec, NULL if the codec is unknown
+ */
+{
+    switch (Id)
+    {
+        case CAB_CODEC_RAW:
+            return new CRawCodec();
+
+        case CAB_CODEC_MSZIP:
+            return new CMSZipCodec();
+
+        default:
+            return NULL;
+    }
+}
+
 void CCabinet::SelectCodec(LONG Id)
 /*
  * FUNCTION: Selects codec engine to use
@@ -1454,19 +1497,9 @@ void CCabinet::SelectCodec(LONG Id)
         delete Codec;
     }
 
-    switch (Id)
-    {
-        case CAB_CODEC_RAW:
-            Codec = new CRawCodec();
-            break;
-
-        case CAB_CODEC_MSZIP:
-            Codec = new CMSZipCodec();
-            break;
-
-        default:
-            return;
-    }
+    Codec = NewCodec(Id);
+    if (!Codec)
+        return;
 
     CodecId       = Id;
     CodecSelected = true;
@@ -1498,6 +1531,17 @@ ULONG CCabinet::NewCabinet()
     CurrentIBuffer     = InputBuffer;
     CurrentIBufferSize = 0;
 
+    if (CompressThreads > 1)
+    {
+        Status = AllocateCompressBlocks();
+        if (Status != CAB_STATUS_SUCCESS)
+            return Status;
+    }
+
+    UncompressedBytes = 0;
+    CompressedBytes   = 0;
+    WriteTime         = 0;
+
     CABHeader.Signature     = CAB_SIGNATURE;
     CABHeader.Reserved1     = 0;            // Not used
     CABHeader.CabinetSize   = 0;            // Not yet known
@@ -1579,8 +1623,15 @@ ULONG CCabinet::NewFolder()
  *     Status of operation
  */
 {
+    ULONG Status;
+
     DPRINT(MAX_TRACE, ("Creating new folder.\n"));
 
+    /* Queued data blocks belong to the current folder */
+    Status = FlushDataBlocks();
+    if (Status != CAB_STATUS_SUCCESS)
+        return Status;
+
     CurrentFolderNode = NewFolderNode();
     if (!CurrentFolderNode)
     {
@@ -1758,6 +1809,9 @@ ULONG CCabinet::WriteDisk(ULONG MoreDisks)
 {
     PCFFILE_NODE FileNode;
     ULONG Status;
+    ULONG StartTime;
+
+    StartTime = GetMilliseconds();
 
     ContinueFile = false;
     FileNode = FileListHead;
@@ -1774,6 +1828,9 @@ ULONG CCabinet::WriteDisk(ULONG MoreDisks)
             while (CreateNewDisk)
             {
                 DPRINT(MAX_TRACE, ("Creating new disk.\n"));
+                Status = FlushDataBlocks();
+                if (Status != CAB_STATUS_SUCCESS)
+                    return Status;
                 CommitDisk(true);
                 CloseDisk();
                 NewDisk();
@@ -1811,6 +1868,9 @@ ULONG CCabinet::WriteDisk(ULONG MoreDisks)
             if (CreateNewDisk)
             {
                 DPRINT(MID_TRACE, ("Creating new disk 2.\n"));
+                Status = FlushDataBlocks();
+                if (Status != CAB_STATUS_SUCCESS)
+                    return Status;
                 CommitDisk(true);
                 CloseDisk();
                 NewDisk();
@@ -1827,8 +1887,15 @@ ULONG CCabinet::WriteDisk(ULONG MoreDisks)
             }
         } while (CreateNewDisk);
     }
+
+    Status = FlushDataBlocks();
+    if (Status != CAB_STATUS_SUCCESS)
+        return Status;
+
     CommitDisk(MoreDisks);
 
+    WriteTime += GetMilliseconds() - StartTime;
+
     return CAB_STATUS_SUCCESS;
 }
 
@@ -1982,6 +2049,8 @@ ULONG CCabinet::CloseCabinet()
         OutputBuffer = NULL;
     }
 
+    FreeCompressBlocks();
+
     Close();
 
     if (ScratchFile)
@@ -2243,6 +2312,60 @@ void CCabinet::SetMaxDiskSize(ULONG Size)
     MaxDiskSize = Size;
 }
 
+
+void CCabinet::SetCompressionThreads(ULONG Count)
+/*
+ * FUNCTION: Sets the number of threads used to compress data blocks
+ * ARGUMENTS:
+ *     Count = Number of threads, 0 to use one per processor
+ */
+{
+    if (Count == 0)
+    {
+#if defined(_WIN32)
+        SYSTEM_INFO SystemInfo;
+
+        GetSystemInfo(&SystemInfo);
+        Count = SystemInfo.dwNumberOfProcessors;
+#else
+        long Processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+        Count = (Processors > 0) ? (ULONG)Processors : 1;
+#endif
+    }
+
+    if (Count > CAB_MAX_COMPRESS_THREADS)
+        Count = CAB_MAX_COMPRESS_THREADS;
+
+    CompressThreads = Count;
+}
+
+
+ULONG CCabinet::GetCompressionThreads()
+/*
+ * FUNCTION: Returns the number of threads used to compress data blocks
+ */
+{
+    return CompressThreads;
+}
+
+
+void CCabinet::GetCompressionStatistics(ULONGLONG* Uncompressed,
+                                        ULONGLONG* Compressed,
+                                        PULONG Milliseconds)
+/*
+ * FUNCTION: Returns statistics about the data blocks written so far
+ * ARGUMENTS:
+ *     Uncompressed = Address of buffer to place number of uncompressed bytes
+ *     Compressed   = Address of buffer to place number of compressed bytes
+ *     Milliseconds = Address of buffer to place time spent writing disks
+ */
+{
+    *Uncompressed = UncompressedBytes;
+    *Compressed   = CompressedBytes;
+    *Milliseconds = WriteTime;
+}
+
 #endif /* CAB_READ_ONLY */
 
 
@@ -3530,8 +3653,12 @@ ULONG CCabinet::WriteDataBlock()
  */
 {
     ULONG Status;
-    ULONG BytesWritten;
-    PCFDATA_NODE DataNode;
+
+    /* Without a disk size limit, the compressed size of a block does not
+       influence how the next one is laid out, so blocks can be compressed
+       in parallel and stored later in the order they were queued */
+    if (CompressBlocks && !BlockIsSplit && MaxDiskSize == 0)
+        return QueueDataBlock();
 
     if (!BlockIsSplit)
     {
@@ -3539,6 +3666,11 @@ ULONG CCabinet::WriteDataBlock()
             InputBuffer,
             CurrentIBufferSize,
             &TotalCompSize);
+        if (Status != CS_SUCCESS)
+        {
+            DPRINT(MIN_TRACE, ("Cannot compress data block (%u).\n", (UINT)Status));
+            return (Status == CS_NOMEMORY) ? CAB_STATUS_NOMEMORY : CAB_STATUS_FAILURE;
+        }
 
         DPRINT(MAX_TRACE, ("Block compressed. CurrentIBufferSize (%u)  TotalCompSize(%u).\n",
             (UINT)CurrentIBufferSize, (UINT)TotalCompSize));
@@ -3547,6 +3679,21 @@ ULONG CCabinet::WriteDataBlock()
         CurrentOBufferSize = TotalCompSize;
     }
 
+    return StoreDataBlock();
+}
+
+
+ULONG CCabinet::StoreDataBlock()
+/*
+ * FUNCTION: Writes the compressed current data block to the scratch file
+ * RETURNS:
+ *     Status of operation
+ */
+{
+    ULONG Status;
+    ULONG BytesWritten;
+    PCFDATA_NODE DataNode;
+
     DataNode = NewDataNode(CurrentFolderNode);
     if (!DataNode)
     {
@@ -3600,6 +3747,9 @@ ULONG CCabinet::WriteDataBlock()
 
     LastBlockStart += DataNode->Data.UncompSize;
 
+    UncompressedBytes += DataNode->Data.UncompSize;
+    CompressedBytes   += DataNode->Data.CompSize;
+
     if (!BlockIsSplit)
     {
         CurrentIBufferSize = 0;
@@ -3609,6 +3759,249 @@ ULONG CCabinet::WriteDataBlock()
     return CAB_STATUS_SUCCESS;
 }
 
+
+ULONG CCabinet::AllocateCompressBlocks()
+/*
+ * FUNCTION: Allocates the queue of data blocks for parallel compression
+ * RETURNS:
+ *     Status of operation
+ */
+{
+    ULONG i;
+
+    FreeCompressBlocks();
+
+    CompressBlockCount = CompressThreads * CAB_BLOCKS_PER_THREAD;
+    CompressBlocks = (PCAB_COMPRESS_BLOCK)AllocateMemory(CompressBlockCount * sizeof(CAB_COMPRESS_BLOCK));
+    if (!CompressBlocks)
+    {
+        DPRINT(MIN_TRACE, ("Insufficient memory.\n"));
+        return CAB_STATUS_NOMEMORY;
+    }
+    memset(CompressBlocks, 0, CompressBlockCount * sizeof(CAB_COMPRESS_BLOCK));
+
+    for (i = 0; i < CompressBlockCount; i++)
+    {
+        CompressBlocks[i].InputBuffer  = AllocateMemory(CAB_BLOCKSIZE + 12);
+        CompressBlocks[i].OutputBuffer = AllocateMemory(CAB_BLOCKSIZE + 12);
+        if (!CompressBlocks[i].InputBuffer || !CompressBlocks[i].OutputBuffer)
+        {
+            DPRINT(MIN_TRACE, ("Insufficient memory.\n"));
+            FreeCompressBlocks();
+            return CAB_STATUS_NOMEMORY;
+        }
+    }
+
+    QueuedBlocks = 0;
+
+    return CAB_STATUS_SUCCESS;
+}
+
+
+void CCabinet::FreeCompressBlocks()
+/*
+ * FUNCTION: Frees the queue of data blocks for parallel compression
+ */
+{
+    ULONG i;
+
+    if (!CompressBlocks)
+        return;
+
+    for (i = 0; i < CompressBlockCount; i++)
+    {
+        if (CompressBlocks[i].InputBuffer)
+            FreeMemory(CompressBlocks[i].InputBuffer);
+        if (CompressBlocks[i].OutputBuffer)
+            FreeMemory(CompressBlocks[i].OutputBuffer);
+    }
+
+    FreeMemory(CompressBlocks);
+    CompressBlocks     = NULL;
+    CompressBlockCount = 0;
+    QueuedBlocks       = 0;
+}
+
+
+ULONG CCabinet::QueueDataBlock()
+/*
+ * FUNCTION: Queues the current data block for compression
+ * RETURNS:
+ *     Status of operation
+ */
+{
+    PCAB_COMPRESS_BLOCK Block = &CompressBlocks[QueuedBlocks++];
+
+    memcpy(Block->InputBuffer, InputBuffer, CurrentIBufferSize);
+    Block->InputSize = CurrentIBufferSize;
+
+    CurrentIBufferSize = 0;
+    CurrentIBuffer     = InputBuffer;
+
+    if (QueuedBlocks == CompressBlockCount)
+        return FlushDataBlocks();
+
+    return CAB_STATUS_SUCCESS;
+}
+
+
+typedef struct _CAB_COMPRESS_WORKER
+{
+    PCAB_COMPRESS_BLOCK Blocks;
+    ULONG               BlockCount;
+    ULONG               First;          // Index of first block for this worker
+    ULONG               Stride;         // Number of workers
+    LONG                CodecId;
+} CAB_COMPRESS_WORKER, *PCAB_COMPRESS_WORKER;
+
+static void CompressWorkerBlocks(PCAB_COMPRESS_WORKER Worker)
+/*
+ * FUNCTION: Compresses every Stride'th queued data block
+ * ARGUMENTS:
+ *     Worker = Pointer to worker description
+ */
+{
+    CCABCodec *Codec;
+    ULONG i;
+
+    /* Codecs keep stream state, so every worker needs its own */
+    Codec = NewCodec(Worker->CodecId);
+
+    for (i = Worker->First; i < Worker->BlockCount; i += Worker->Stride)
+    {
+        PCAB_COMPRESS_BLOCK Block = &Worker->Blocks[i];
+
+        if (!Codec)
+        {
+            Block->Status = CS_NOMEMORY;
+            continue;
+        }
+
+        Block->Status = Codec->Compress(Block->OutputBuffer,
+            Block->InputBuffer,
+            Block->InputSize,
+            &Block->OutputSize);
+    }
+
+    delete Codec;
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI CompressWorkerThread(LPVOID Parameter)
+{
+    CompressWorkerBlocks((PCAB_COMPRESS_WORKER)Parameter);
+    return 0;
+}
+#else
+static void* CompressWorkerThread(void* Parameter)
+{
+    CompressWorkerBlocks((PCAB_COMPRESS_WORKER)Parameter);
+    return NULL;
+}
+#endif
+
+
+ULONG CCabinet::FlushDataBlocks()
+/*
+ * FUNCTION: Compresses the queued data blocks in parallel and writes
+ *           them to the scratch file in the order they were queued
+ * RETURNS:
+ *     Status of operation
+ */
+{
+    CAB_COMPRESS_WORKER Workers[CAB_MAX_COMPRESS_THREADS];
+#if defined(_WIN32)
+    HANDLE Threads[CAB_MAX_COMPRESS_THREADS];
+#else
+    pthread_t Threads[CAB_MAX_COMPRESS_THREADS];
+#endif
+    bool ThreadStarted[CAB_MAX_COMPRESS_THREADS];
+    ULONG SavedIBufferSize;
+    ULONG WorkerCount;
+    ULONG Status;
+    ULONG i;
+
+    if (QueuedBlocks == 0)
+        return CAB_STATUS_SUCCESS;
+
+    WorkerCount = (QueuedBlocks < CompressThreads) ? QueuedBlocks : CompressThreads;
+
+    for (i = 0; i < WorkerCount; i++)
+    {
+        Workers[i].Blocks     = CompressBlocks;
+        Workers[i].BlockCount = QueuedBlocks;
+        Workers[i].First      = i;
+        Workers[i].Stride     = WorkerCount;
+        Workers[i].CodecId    = CodecId;
+    }
+
+    /* The calling thread takes the first share of the work */
+    for (i = 1; i < WorkerCount; i++)
+    {
+#if defined(_WIN32)
+        Threads[i] = CreateThread(NULL, 0, CompressWorkerThread, &Workers[i], 0, NULL);
+        ThreadStarted[i] = (Threads[i] != NULL);
+#else
+        ThreadStarted[i] = (pthread_create(&Threads[i], NULL, CompressWorkerThread, &Workers[i]) == 0);
+#endif
+    }
+
+    CompressWorkerBlocks(&Workers[0]);
+
+    for (i = 1; i < WorkerCount; i++)
+    {
+        if (!ThreadStarted[i])
+        {
+            CompressWorkerBlocks(&Workers[i]);
+            continue;
+        }
+#if defined(_WIN32)
+        WaitForSingleObject(Threads[i], INFINITE);
+        CloseHandle(Threads[i]);
+#else
+        pthread_join(Threads[i], NULL);
+#endif
+    }
+
+    /* Store the blocks in order. The partially filled input buffer is
+       saved and restored around this, as stores reset it */
+    SavedIBufferSize = CurrentIBufferSize;
+
+    for (i = 0; i < QueuedBlocks; i++)
+    {
+        PCAB_COMPRESS_BLOCK Block = &CompressBlocks[i];
+
+        if (Block->Status != CS_SUCCESS)
+        {
+            DPRINT(MIN_TRACE, ("Cannot compress data block (%u).\n", (UINT)Block->Status));
+            QueuedBlocks = 0;
+            return (Block->Status == CS_NOMEMORY) ? CAB_STATUS_NOMEMORY : CAB_STATUS_FAILURE;
+        }
+
+        DPRINT(MAX_TRACE, ("Block compressed. InputSize (%u)  OutputSize(%u).\n",
+            (UINT)Block->InputSize, (UINT)Block->OutputSize));
+
+        TotalCompSize      = Block->OutputSize;
+        CurrentOBuffer     = Block->OutputBuffer;
+        CurrentOBufferSize = Block->OutputSize;
+        CurrentIBufferSize = Block->InputSize;
+
+        Status = StoreDataBlock();
+        if (Status != CAB_STATUS_SUCCESS)
+        {
+            QueuedBlocks = 0;
+            return Status;
+        }
+    }
+
+    QueuedBlocks = 0;
+
+    CurrentIBufferSize = SavedIBufferSize;
+    CurrentIBuffer     = (unsigned char*)InputBuffer + SavedIBufferSize;
+
+    return CAB_STATUS_SUCCESS;
+}
+
 #if !defined(_WIN32)
 
 void CCabinet::ConvertDateAndTime(time_t* Time,
@@ -287,6 +287,21 @@ public:
 #define CAB_CODEC_MSZIP 0x02
 
 
+/* Parallel compression */
+
+#define CAB_MAX_COMPRESS_THREADS  64
+#define CAB_BLOCKS_PER_THREAD     4   // Blocks queued per thread before they are compressed
+
+typedef struct _CAB_COMPRESS_BLOCK
+{
+    void*       InputBuffer;            // Uncompressed data
+    ULONG       InputSize;              // Number of uncompressed bytes
+    void*       OutputBuffer;           // Compressed data
+    ULONG       OutputSize;             // Number of compressed bytes
+    ULONG       Status;                 // Codec status code
+} CAB_COMPRESS_BLOCK, *PCAB_COMPRESS_BLOCK;
+
+
 
 /* Classes */
 
@@ -391,6 +406,12 @@ public:
     ULONG AddFile(char* FileName);
     /* Sets the maximum size of the current disk */
     void SetMaxDiskSize(ULONG Size);
+    /* Sets the number of threads used to compress data blocks (0 = one per processor) */
+    void SetCompressionThreads(ULONG Count);
+    /* Returns the number of threads used to compress data blocks */
+    ULONG GetCompressionThreads();
+    /* Returns statistics about the data blocks written so far */
+    void GetCompressionStatistics(ULONGLONG* UncompressedBytes, ULONGLONG* CompressedBytes, PULONG Milliseconds);
 #endif /* CAB_READ_ONLY */
 
     /* Default event handlers */
@@ -434,6 +455,11 @@ private:
     ULONG WriteFileEntries();
     ULONG CommitDataBlocks(PCFFOLDER_NODE FolderNode);
     ULONG WriteDataBlock();
+    ULONG StoreDataBlock();
+    ULONG AllocateCompressBlocks();
+    void FreeCompressBlocks();
+    ULONG QueueDataBlock();
+    ULONG FlushDataBlocks();
     ULONG GetAttributesOnFile(PCFFILE_NODE File);
     ULONG SetAttributesOnFile(char* FileName, USHORT FileAttributes);
     ULONG GetFileTimes(FILEHANDLE FileHandle, PCFFILE_NODE File);
@@ -499,6 +525,14 @@ private:
     ULONG TotalBytesLeft;
     bool BlockIsSplit;                  // true if current data block is split
     ULONG NextFolderNumber;     // Zero based folder number
+
+    ULONG CompressThreads;              // Number of threads compressing data blocks
+    PCAB_COMPRESS_BLOCK CompressBlocks; // Data blocks waiting to be compressed, NULL if serial
+    ULONG CompressBlockCount;           // Number of entries in CompressBlocks
+    ULONG QueuedBlocks;                 // Number of data blocks queued in CompressBlocks
+    ULONGLONG UncompressedBytes;        // Statistics
+    ULONGLONG CompressedBytes;
+    ULONG WriteTime;
 #endif /* CAB_READ_ONLY */
 };
 
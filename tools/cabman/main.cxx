@@ -192,8 +192,8 @@ void CCABManager::Usage()
 {
     printf("ReactOS Cabinet Manager\n\n");
     printf("CABMAN [-D | -E] [-A] [-L dir] cabinet [filename ...]\n");
-    printf("CABMAN [-M mode] -C dirfile [-I] [-RC file] [-P dir]\n");
-    printf("CABMAN [-M mode] -S cabinet filename [...]\n");
+    printf("CABMAN [-M mode] [-T threads] -C dirfile [-I] [-RC file] [-P dir]\n");
+    printf("CABMAN [-M mode] [-T threads] -S cabinet filename [...]\n");
     printf("  cabinet   Cabinet file.\n");
     printf("  filename  Name of the file to add to or extract from the cabinet.\n");
     printf("            Wild cards and multiple filenames\n");
@@ -217,6 +217,8 @@ void CCABManager::Usage()
     printf("            (size must be less than 64KB).\n");
     printf("  -S        Create simple cabinet.\n");
     printf("  -P dir    Files in the .dff are relative to this directory.\n");
+    printf("  -T num    Number of threads to compress data blocks with\n");
+    printf("            (default is 1, 0 means one per processor).\n");
     printf("  -V        Verbose mode (prints more messages).\n");
 }
 
@@ -347,6 +349,18 @@ bool CCABManager::ParseCmdline(int argc, char* argv[])
 
                     break;
 
+                case 't':
+                case 'T':
+                    if (argv[i][2] == 0)
+                    {
+                        i++;
+                        SetCompressionThreads(atoi(&argv[i][0]));
+                    }
+                    else
+                        SetCompressionThreads(atoi(&argv[i][2]));
+
+                    break;
+
                 case 'V':
                     Verbose = true;
                     break;
@@ -568,7 +582,10 @@ bool CCABManager::Run()
     switch (Mode)
     {
         case CM_MODE_CREATE:
-            return CreateCabinet();
+            if (!CreateCabinet())
+                return false;
+            ShowCompressionStatistics();
+            return true;
 
         case CM_MODE_DISPLAY:
             return DisplayCabinet();
@@ -577,7 +594,10 @@ bool CCABManager::Run()
             return ExtractFromCabinet();
 
         case CM_MODE_CREATE_SIMPLE:
-            return CreateSimpleCabinet();
+            if (!CreateSimpleCabinet())
+                return false;
+            ShowCompressionStatistics();
+            return true;
 
         default:
             break;
@@ -586,6 +606,34 @@ bool CCABManager::Run()
 }
 
 
+void CCABManager::ShowCompressionStatistics()
+/*
+ * FUNCTION: Display how much data was compressed and how fast
+ */
+{
+    ULONGLONG Uncompressed;
+    ULONGLONG Compressed;
+    ULONG Milliseconds;
+    double Megabytes;
+
+    GetCompressionStatistics(&Uncompressed, &Compressed, &Milliseconds);
+    if (Uncompressed == 0)
+        return;
+
+    Megabytes = (double)Uncompressed / (1024 * 1024);
+
+    printf("Compressed %.1f MB into %.1f MB with %u thread%s in %u ms",
+           Megabytes,
+           (double)Compressed / (1024 * 1024),
+           (UINT)GetCompressionThreads(),
+           GetCompressionThreads() == 1 ? "" : "s",
+           (UINT)Milliseconds);
+    if (Milliseconds > 0)
+        printf(" (%.1f MB/s)", Megabytes * 1000 / Milliseconds);
+    printf("\n");
+}
+
+
 /* Event handlers */
 
 bool CCABManager::OnOverwrite(PCFFILE File,
@@ -36,6 +36,10 @@
 
 /* According to his website, this file was released into the public domain by Philip J. Erdelsky */
 
+#ifdef __linux__
+# define _GNU_SOURCE  /* for copy_file_range() */
+#endif
+
 #include <stdio.h>
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -58,10 +62,15 @@
 # endif // __FreeBSD__
 # include <errno.h>
 # include <sys/types.h>
+# include <sys/time.h>
 # include <dirent.h>
 # include <unistd.h>
 # define TRUE 1
 # define FALSE 0
+# if defined(__linux__) && defined(__GLIBC__) && \
+     (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#  define HAVE_COPY_FILE_RANGE
+# endif
 #endif // _WIN32
 #include <ctype.h>
 #include <time.h>
@@ -81,7 +90,8 @@ typedef int BOOL;
 #define MAX_EXTENSION_LENGTH    10
 #define MAX_CDEXTENSION_LENGTH  3
 #define SECTOR_SIZE             2048
-#define BUFFER_SIZE             (8 * SECTOR_SIZE)
+#define BUFFER_SIZE             (512 * SECTOR_SIZE)
+#define NUM_CONTENT_HASH_BUCKETS 4096
 
 const BYTE HIDDEN_FLAG    = 1;
 const BYTE DIRECTORY_FLAG = 2;
@@ -121,6 +131,7 @@ typedef struct directory_record
     char extension_on_cd[MAX_CDEXTENSION_LENGTH+1];
     char *joliet_name;
     const char *orig_name;
+    struct directory_record *same_as;           /* file record only */
     DATE_AND_TIME date_and_time;
     DWORD sector;
     DWORD size;
@@ -130,6 +141,16 @@ typedef struct directory_record
     WORD path_table_index;                      /* directory record only */
 } DIR_RECORD, *PDIR_RECORD;
 
+/* Files seen so far, keyed by size, for sharing extents between duplicates */
+typedef struct content_entry
+{
+    struct content_entry *next;
+    PDIR_RECORD record;
+    char *source;
+    BOOL hashed;
+    unsigned long hash;
+} CONTENT_ENTRY, *PCONTENT_ENTRY;
+
 typedef enum directory_record_type
 {
     DOT_RECORD,
@@ -172,6 +193,11 @@ DWORD boot_catalog_sector;
 DWORD boot_image_sector;
 WORD boot_image_size;  // counted in 512 byte sectors
 
+BOOL deduplicate;
+PCONTENT_ENTRY content_hash[NUM_CONTENT_HASH_BUCKETS];
+DWORD number_of_shared_files;
+DWORD bytes_in_shared_files;
+
 BOOL joliet;
 DWORD joliet_path_table_size;
 DWORD joliet_little_endian_path_table_sector;
@@ -207,12 +233,39 @@ static char *edit_with_commas(DWORD x, BOOL pad)
     return s + i;
 }
 
+/*-----------------------------------------------------------------------------
+This function returns a wall clock time in milliseconds, for the timing report.
+-----------------------------------------------------------------------------*/
+
+static DWORD get_milliseconds(void)
+{
+#ifdef _WIN32
+    return GetTickCount();
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (DWORD)(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+#endif
+}
+
 /*-----------------------------------------------------------------------------
 This function releases all allocated memory blocks.
 -----------------------------------------------------------------------------*/
 
 static void release_memory(void)
 {
+    unsigned i;
+
+    for (i = 0; i < NUM_CONTENT_HASH_BUCKETS; i++)
+    {
+        while (content_hash[i] != NULL)
+        {
+            PCONTENT_ENTRY next = content_hash[i]->next;
+            free(content_hash[i]->source);
+            free(content_hash[i]);
+            content_hash[i] = next;
+        }
+    }
     while (root.next_in_memory != NULL)
     {
         struct directory_record *next =
@@ -1283,6 +1336,198 @@ static void get_file_specifications(PDIR_RECORD d)
     }
 }
 
+/*-----------------------------------------------------------------------------
+This function returns the full name of the source of a file record, in a
+buffer the caller must free.
+-----------------------------------------------------------------------------*/
+
+static char *get_file_source(PDIR_RECORD q)
+{
+    char *old_end_source;
+    char *file_source;
+
+    if (q->orig_name)
+        return strdup(q->orig_name);
+
+    old_end_source = end_source;
+    get_file_specifications(q);
+    *end_source = 0;
+    file_source = strdup(source);
+    end_source = old_end_source;
+    return file_source;
+}
+
+/*-----------------------------------------------------------------------------
+These functions find out whether a file has the same contents as a file seen
+earlier, so that both can share a single extent in the image. Candidates must
+have the same size and hash, and are then compared byte for byte.
+-----------------------------------------------------------------------------*/
+
+static BOOL hash_file(const char *file_source, unsigned long *hash)
+{
+    FILE *file;
+    size_t n, i;
+    unsigned long h = 2166136261UL;
+
+    file = fopen(file_source, "rb");
+    if (file == NULL)
+        return FALSE;
+    while ((n = fread(cd.buffer, 1, BUFFER_SIZE, file)) != 0)
+    {
+        for (i = 0; i < n; i++)
+            h = (h ^ cd.buffer[i]) * 16777619UL;
+    }
+    fclose(file);
+    *hash = h;
+    return TRUE;
+}
+
+static BOOL compare_files(const char *name1, const char *name2)
+{
+    FILE *file1, *file2;
+    BYTE *buffer2 = cd.buffer + BUFFER_SIZE / 2;
+    size_t n1, n2;
+    BOOL same = FALSE;
+
+    file1 = fopen(name1, "rb");
+    file2 = fopen(name2, "rb");
+    if (file1 != NULL && file2 != NULL)
+    {
+        do
+        {
+            n1 = fread(cd.buffer, 1, BUFFER_SIZE / 2, file1);
+            n2 = fread(buffer2, 1, BUFFER_SIZE / 2, file2);
+        } while (n1 == n2 && n1 != 0 && memcmp(cd.buffer, buffer2, n1) == 0);
+        same = (n1 == 0 && n2 == 0);
+    }
+    if (file1 != NULL)
+        fclose(file1);
+    if (file2 != NULL)
+        fclose(file2);
+    return same;
+}
+
+static PDIR_RECORD find_same_contents(PDIR_RECORD q)
+{
+    PCONTENT_ENTRY *bucket = &content_hash[q->size % NUM_CONTENT_HASH_BUCKETS];
+    PCONTENT_ENTRY e, entry;
+
+    entry = malloc(sizeof(CONTENT_ENTRY));
+    if (entry == NULL)
+        error_exit("Insufficient memory");
+    entry->record = q;
+    entry->source = get_file_source(q);
+    entry->hashed = FALSE;
+    if (entry->source == NULL)
+        error_exit("Insufficient memory");
+
+    for (e = *bucket; e != NULL; e = e->next)
+    {
+        if (e->record->size != q->size)
+            continue;
+
+        // only hash files once there is another file of the same size
+        if (!entry->hashed)
+        {
+            if (!hash_file(entry->source, &entry->hash))
+                error_exit("Can't open %s\n", entry->source);
+            entry->hashed = TRUE;
+        }
+        if (!e->hashed)
+        {
+            if (!hash_file(e->source, &e->hash))
+                error_exit("Can't open %s\n", e->source);
+            e->hashed = TRUE;
+        }
+
+        if (e->hash == entry->hash && compare_files(e->source, entry->source))
+        {
+            free(entry->source);
+            free(entry);
+            return e->record;
+        }
+    }
+
+    entry->next = *bucket;
+    *bucket = entry;
+    return NULL;
+}
+
+/*-----------------------------------------------------------------------------
+This function copies the contents of a file into the CD-ROM image. The file
+is read unbuffered straight into the large write buffer, or on Linux, copied
+by the kernel when the image and the file system allow it.
+-----------------------------------------------------------------------------*/
+
+static void write_file_data(const char *file_source, DWORD size)
+{
+    FILE *file;
+    int n;
+
+    file = fopen(file_source, "rb");
+    if (file == NULL)
+        error_exit("Can't open %s\n", file_source);
+    setvbuf(file, NULL, _IONBF, 0);
+
+#ifdef HAVE_COPY_FILE_RANGE
+    if (size >= BUFFER_SIZE && cd.offset == 0)
+    {
+        loff_t in_offset = 0;
+        loff_t out_offset;
+        ssize_t copied;
+
+        // the kernel writes at an explicit offset, so flush what we have first
+        if (cd.count > 0)
+            flush_buffer();
+        if (fflush(cd.file) != 0)
+            error_exit("File write error");
+        out_offset = (loff_t)cd.sector * SECTOR_SIZE;
+
+        while (size > 0)
+        {
+            copied = copy_file_range(fileno(file), &in_offset,
+                                     fileno(cd.file), &out_offset,
+                                     size, 0);
+            if (copied <= 0)
+                break;
+            cd.sector += copied / SECTOR_SIZE;
+            cd.offset += copied % SECTOR_SIZE;
+            cd.sector += cd.offset / SECTOR_SIZE;
+            cd.offset %= SECTOR_SIZE;
+            size -= copied;
+        }
+
+        // carry on with buffered writes right after what was copied
+        if (fseeko(cd.file, out_offset, SEEK_SET) != 0 ||
+            fseeko(file, in_offset, SEEK_SET) != 0)
+        {
+            fclose(file);
+            error_exit("Seek error in file %s\n", file_source);
+        }
+    }
+#endif
+
+    while (size > 0)
+    {
+        n = BUFFER_SIZE - cd.count;
+        if ((DWORD) n > size)
+            n = size;
+        if (fread(cd.buffer + cd.count, n, 1, file) < 1)
+        {
+            fclose(file);
+            error_exit("Read error in file %s\n", file_source);
+        }
+        cd.count += n;
+        if (cd.count == BUFFER_SIZE)
+            flush_buffer();
+        cd.offset += n;
+        cd.sector += cd.offset / SECTOR_SIZE;
+        cd.offset %= SECTOR_SIZE;
+        size -= n;
+    }
+    fclose(file);
+}
+
 static void get_time_string(char *str)
 {
     sprintf(str, "%04d%02d%02d%02d%02d%02d00",
@@ -1302,7 +1547,6 @@ static void pass(void)
     unsigned int name_length;
     DWORD size;
     DWORD number_of_sectors;
-    char *old_end_source;
     int n;
     FILE *file;
     char timestring[17];
@@ -1622,56 +1866,46 @@ static void pass(void)
         {
             if ((q->flags & DIRECTORY_FLAG) == 0)
             {
-                q->sector = q->joliet_sector = cd.sector;
                 size = q->size;
                 if (cd.file == NULL)
                 {
-                    number_of_sectors = (size + SECTOR_SIZE - 1) / SECTOR_SIZE;
-                    cd.sector += number_of_sectors;
                     number_of_files++;
                     bytes_in_files += size;
+
+                    // files with the same contents as an earlier one share its extent
+                    q->same_as = NULL;
+                    if (deduplicate && size > 0)
+                        q->same_as = find_same_contents(q);
+                    if (q->same_as != NULL)
+                    {
+                        q->sector = q->joliet_sector = q->same_as->sector;
+                        number_of_shared_files++;
+                        bytes_in_shared_files += size;
+                        continue;
+                    }
+
+                    q->sector = q->joliet_sector = cd.sector;
+                    number_of_sectors = (size + SECTOR_SIZE - 1) / SECTOR_SIZE;
+                    cd.sector += number_of_sectors;
                     unused_bytes_at_ends_of_files +=
                     number_of_sectors * SECTOR_SIZE - size;
                 }
+                else if (q->same_as != NULL)
+                {
+                    q->sector = q->joliet_sector = q->same_as->sector;
+                }
                 else
                 {
-                    const char *file_source;
-                    old_end_source = end_source;
-                    if (!q->orig_name)
-                    {
-                        get_file_specifications(q);
-                        *end_source = 0;
-                        file_source = source;
-                    }
-                    else
-                    {
-                        file_source = q->orig_name;
-                    }
+                    char *file_source;
+
+                    q->sector = q->joliet_sector = cd.sector;
+                    file_source = get_file_source(q);
+                    if (file_source == NULL)
+                        error_exit("Insufficient memory");
                     if (verbosity == VERBOSE)
                         printf("Writing contents of %s\n", file_source);
-                    file = fopen(file_source, "rb");
-                    if (file == NULL)
-                        error_exit("Can't open %s\n", file_source);
-                    fseek(file, 0, SEEK_SET);
-                    while (size > 0)
-                    {
-                        n = BUFFER_SIZE - cd.count;
-                        if ((DWORD) n > size)
-                            n = size;
-                        if (fread(cd.buffer + cd.count, n, 1, file) < 1)
-                        {
-                            fclose(file);
-                            error_exit("Read error in file %s\n", file_source);
-                        }
-                        cd.count += n;
-                        if (cd.count == BUFFER_SIZE)
-                            flush_buffer();
-                        cd.sector += n / SECTOR_SIZE;
-                        cd.offset += n % SECTOR_SIZE;
-                        size -= n;
-                    }
-                    fclose(file);
-                    end_source = old_end_source;
+                    write_file_data(file_source, size);
+                    free(file_source);
                     fill_sector();
                 }
             }
@@ -1687,7 +1921,7 @@ static char HELP[] =
     "Copyright (C) Philip J. Erdelsky\n"
     "Copyright (C) 2003-2015 ReactOS Team\n"
     "\n\n"
-    "CDMAKE [-q] [-v] [-p] [-s N] [-m] [-b bootimage] [-j] source volume image\n"
+    "CDMAKE [-q] [-v] [-p] [-s N] [-m] [-b bootimage] [-j] [-d] source volume image\n"
     "\n"
     "  source        Specifications of base directory containing all files to\n"
     "                be written to CD-ROM image\n"
@@ -1702,7 +1936,8 @@ static char HELP[] =
     "  -m            Accept punctuation marks other than underscores in\n"
     "                names and extensions\n"
     "  -b bootimage  Create bootable ElTorito CD-ROM using 'no emulation' mode\n"
-    "  -j            Generate Joliet filename records\n";
+    "  -j            Generate Joliet filename records\n"
+    "  -d            Store files with identical contents only once\n";
 
 /*-----------------------------------------------------------------------------
 Program execution starts here.
@@ -1711,6 +1946,7 @@ Program execution starts here.
 int main(int argc, char **argv)
 {
     time_t timestamp = time(NULL);
+    DWORD start_time, scan_time, layout_time, write_time;
     BOOL q_option = FALSE;
     BOOL v_option = FALSE;
     int i;
@@ -1779,6 +2015,8 @@ int main(int argc, char **argv)
             accept_punctuation_marks = TRUE;
         else if (strcmp(argv[i], "-j") == 0)
             joliet = TRUE;
+        else if (strcmp(argv[i], "-d") == 0)
+            deduplicate = TRUE;
         else if (strcmp(argv[i], "-b") == 0)
         {
             strcpy(bootimage, argv[++i]);
@@ -1810,6 +2048,8 @@ int main(int argc, char **argv)
     if (cd.filespecs[0] == 0)
         error_exit("Missing image file specifications");
 
+    start_time = get_milliseconds();
+
     if (source[0] != '@')
     {
         /* set source[] and end_source to source directory,
@@ -1887,14 +2127,23 @@ int main(int argc, char **argv)
     // make non-writing pass over directory structure to obtain the proper
     // sector numbers and offsets and to determine the size of the image
 
+    scan_time = get_milliseconds();
     number_of_files = bytes_in_files = number_of_directories =
-    bytes_in_directories = unused_bytes_at_ends_of_files = 0;
+    bytes_in_directories = unused_bytes_at_ends_of_files =
+    number_of_shared_files = bytes_in_shared_files = 0;
     pass();
+    layout_time = get_milliseconds();
 
     if (verbosity >= NORMAL)
     {
         printf("%s bytes ", edit_with_commas(bytes_in_files, TRUE));
         printf("in %s files\n", edit_with_commas(number_of_files, FALSE));
+        if (deduplicate)
+        {
+            printf("%s bytes ", edit_with_commas(bytes_in_shared_files, TRUE));
+            printf("in %s files stored only once\n",
+                edit_with_commas(number_of_shared_files, FALSE));
+        }
         printf("%s unused bytes at ends of files\n",
             edit_with_commas(unused_bytes_at_ends_of_files, TRUE));
         printf("%s bytes ", edit_with_commas(bytes_in_directories, TRUE));
@@ -1934,8 +2183,15 @@ int main(int argc, char **argv)
         error_exit("File write error in image file %s", cd.filespecs);
     }
 
+    write_time = get_milliseconds();
+
     if (verbosity >= NORMAL)
+    {
         puts("CD-ROM image made successfully");
+        printf("Scanning took %lu ms, layout %lu ms, writing %lu ms\n",
+               scan_time - start_time, layout_time - scan_time,
+               write_time - layout_time);
+    }
 
     dir_hash_destroy(&specified_files);
     release_memory();
@@ -0,0 +1,273 @@
+/*
+ * PROJECT:     ReactOS host tools
+ * LICENSE:     See COPYING in the top level directory
+ * FILE:        tools/dibbench/dibbench.c
+ * PURPOSE:     Checks and times the win32k SRCCOPY line conversion routines
+ *
+ * Usage: dibbench
+ *
+ * Every format pair is converted twice: once per pixel through a translation
+ * function, the way the DIB blitters did it before, and once with the line
+ * routine from win32ss/gdi/dib/dibconv.h. The results must be identical. The
+ * throughput of both is printed in MPixels/s.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <typedefs.h>
+
+typedef BYTE *PBYTE;
+
+#ifndef FORCEINLINE
+#define FORCEINLINE static __inline
+#endif
+#ifndef UNALIGNED
+#define UNALIGNED
+#endif
+
+#if !defined(_M_IX86) && !defined(_M_AMD64)
+#if defined(__i386__)
+#define _M_IX86
+#elif defined(__x86_64__)
+#define _M_AMD64
+#endif
+#endif
+
+#ifdef _MSC_VER
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+#include "../../win32ss/gdi/dib/dibconv.h"
+
+#define WIDTH  1021
+#define HEIGHT 768
+#define MIN_CLOCKS (CLOCKS_PER_SEC / 4)
+
+/* Stand-in for the EXLATEOBJ the translation functions get */
+typedef struct _XLATE
+{
+    ULONG (*pfnXlate)(struct _XLATE *pxlate, ULONG iColor);
+    PULONG pulXlate;
+    ULONG cEntries;
+} XLATE, *PXLATE;
+
+/* The translations below are copied from win32ss/gdi/eng/xlateobj.c */
+
+static ULONG XlateTrivial(PXLATE pxlate, ULONG iColor)
+{
+    return iColor;
+}
+
+static ULONG XlateTable(PXLATE pxlate, ULONG iColor)
+{
+    if (iColor >= pxlate->cEntries) return 0;
+    return pxlate->pulXlate[iColor];
+}
+
+static ULONG XlateBGRto555(PXLATE pxlate, ULONG iColor)
+{
+    ULONG iNewColor;
+
+    iColor >>= 3;
+    iNewColor = iColor & 0x1f;
+    iColor >>= 3;
+    iNewColor |= (iColor & 0x3E0);
+    iColor >>= 3;
+    iNewColor |= (iColor & 0x7C00);
+    return iNewColor;
+}
+
+static ULONG XlateBGRto565(PXLATE pxlate, ULONG iColor)
+{
+    ULONG iNewColor;
+
+    iColor >>= 3;
+    iNewColor = iColor & 0x1f;
+    iColor >>= 2;
+    iNewColor |= (iColor & 0x7E0);
+    iColor >>= 3;
+    iNewColor |= (iColor & 0xF800);
+    return iNewColor;
+}
+
+/* Like XLATEOBJ_iXlate, which is called for every pixel */
+static NOINLINE ULONG XlateColor(PXLATE pxlate, ULONG iColor)
+{
+    return pxlate->pfnXlate(pxlate, iColor);
+}
+
+typedef struct _PAIR
+{
+    const char *pszName;
+    ULONG cjSrcPixel;
+    ULONG cjDstPixel;
+    XLATE xlate;
+    void (*pfnPerPixel)(struct _PAIR *pPair, PBYTE pjDst, PBYTE pjSrc);
+    void (*pfnLine)(struct _PAIR *pPair, PBYTE pjDst, PBYTE pjSrc);
+} PAIR, *PPAIR;
+
+static ULONG cjSrcDelta, cjDstDelta;
+
+static void PerPixel32to32(PPAIR pPair, PBYTE pjDst, PBYTE pjSrc)
+{
+    ULONG x, y;
+    for (y = 0; y < HEIGHT; y++, pjDst += cjDstDelta, pjSrc += cjSrcDelta)
+        for (x = 0; x < WIDTH; x++)
+            ((PULONG)pjDst)[x] = XlateColor(&pPair->xlate, ((PULONG)pjSrc)[x]);
+}
+
+static void Line32to32(PPAIR pPair, PBYTE pjDst, PBYTE pjSrc)
+{
+    ULONG y;
+    for (y = 0; y < HEIGHT; y++, pjDst += cjDstDelta, pjSrc += cjSrcDelta)
+        memmove(pjDst, pjSrc, WIDTH * 4);
+}
+
+static void PerPixel24to32(PPAIR pPair, PBYTE pjDst, PBYTE pjSrc)
+{
+    ULONG x, y, iColor;
+    for (y = 0; y < HEIGHT; y++, pjDst += cjDstDelta, pjSrc += cjSrcDelta)
+        for (x = 0; x < WIDTH; x++)
+        {
+            iColor = (pjSrc[3 * x + 2] << 16) + (pjSrc[3 * x + 1] << 8) + pjSrc[3 * x];
+            ((PULONG)pjDst)[x] = XlateColor(&pPair->xlate, iColor);
+        }
+}
+
+static void Line24to32(PPAIR pPair, PBYTE pjDst, PBYTE pjSrc)
+{
+    ULONG y;
+    for (y = 0; y < HEIGHT; y++, pjDst += cjDstDelta, pjSrc += cjSrcDelta)
+        DIB_vConvertLine24to32((PULONG)pjDst, pjSrc, WIDTH);
+}
+
+static void PerPixel8to32(PPAIR pPair, PBYTE pjDst, PBYTE pjSrc)
+{
+    ULONG x, y;
+    for (y = 0; y < HEIGHT; y++, pjDst += cjDstDelta, pjSrc += cjSrcDelta)
+        for (x = 0; x < WIDTH; x++)
+            ((PULONG)pjDst)[x] = XlateColor(&pPair->xlate, pjSrc[x]);
+}
+
+static void Line8to32(PPAIR pPair, PBYTE pjDst, PBYTE pjSrc)
+{
+    ULONG y;
+    for (y = 0; y < HEIGHT; y++, pjDst += cjDstDelta, pjSrc += cjSrcDelta)
+        DIB_vConvertLine8to32((PULONG)pjDst, pjSrc, WIDTH,
+                              pPair->xlate.pulXlate, pPair->xlate.cEntries);
+}
+
+static void PerPixel32to16(PPAIR pPair, PBYTE pjDst, PBYTE pjSrc)
+{
+    ULONG x, y;
+    for (y = 0; y < HEIGHT; y++, pjDst += cjDstDelta, pjSrc += cjSrcDelta)
+        for (x = 0; x < WIDTH; x++)
+            ((PUSHORT)pjDst)[x] = (USHORT)XlateColor(&pPair->xlate, ((PULONG)pjSrc)[x]);
+}
+
+static void Line32to555(PPAIR pPair, PBYTE pjDst, PBYTE pjSrc)
+{
+    ULONG y;
+    for (y = 0; y < HEIGHT; y++, pjDst += cjDstDelta, pjSrc += cjSrcDelta)
+        DIB_vConvertLine32to555((PUSHORT)pjDst, (PULONG)pjSrc, WIDTH);
+}
+
+static void Line32to565(PPAIR pPair, PBYTE pjDst, PBYTE pjSrc)
+{
+    ULONG y;
+    for (y = 0; y < HEIGHT; y++, pjDst += cjDstDelta, pjSrc += cjSrcDelta)
+        DIB_vConvertLine32to565((PUSHORT)pjDst, (PULONG)pjSrc, WIDTH);
+}
+
+static double MPixelsPerSecond(PPAIR pPair,
+                               void (*pfnConvert)(PPAIR, PBYTE, PBYTE),
+                               PBYTE pjDst, PBYTE pjSrc)
+{
+    clock_t Start, Elapsed;
+    ULONG cRuns = 0;
+
+    /* Repeat the whole bitmap until the clock has something to measure */
+    Start = clock();
+    do
+    {
+        pfnConvert(pPair, pjDst, pjSrc);
+        cRuns++;
+        Elapsed = clock() - Start;
+    } while (Elapsed < MIN_CLOCKS);
+
+    return (double)cRuns * WIDTH * HEIGHT * CLOCKS_PER_SEC / Elapsed / 1000000;
+}
+
+int main(void)
+{
+    ULONG aulTable[256], aulShortTable[16];
+    PAIR aPairs[] =
+    {
+        {"32 -> 32",         4, 4, {XlateTrivial}, PerPixel32to32, Line32to32},
+        {"24 -> 32",         3, 4, {XlateTrivial}, PerPixel24to32, Line24to32},
+        {"8 -> 32",          1, 4, {XlateTable},   PerPixel8to32,  Line8to32},
+        {"8 -> 32 (16 col)", 1, 4, {XlateTable},   PerPixel8to32,  Line8to32},
+        {"32 -> 16 (555)",   4, 2, {XlateBGRto555}, PerPixel32to16, Line32to555},
+        {"32 -> 16 (565)",   4, 2, {XlateBGRto565}, PerPixel32to16, Line32to565},
+    };
+    PBYTE pjSrc, pjDst, pjRef;
+    ULONG i, cjSize;
+    int iResult = 0;
+
+    aPairs[2].xlate.pulXlate = aulTable;
+    aPairs[2].xlate.cEntries = 256;
+    aPairs[3].xlate.pulXlate = aulShortTable;
+    aPairs[3].xlate.cEntries = 16;
+
+    /* Room for the biggest format, with DWORD aligned lines */
+    cjSize = ((WIDTH * 4 + 3) & ~3) * HEIGHT;
+    pjSrc = malloc(cjSize);
+    pjDst = malloc(cjSize);
+    pjRef = malloc(cjSize);
+    if (!pjSrc || !pjDst || !pjRef)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    /* Fill the source and the tables with pseudo random colors */
+    srand(1);
+    for (i = 0; i < cjSize; i++) pjSrc[i] = (BYTE)rand();
+    for (i = 0; i < 256; i++) aulTable[i] = ((ULONG)rand() << 16) ^ rand();
+    for (i = 0; i < 16; i++) aulShortTable[i] = aulTable[i];
+
+    printf("%-18s %12s %12s\n", "Pair", "per pixel", "line");
+    for (i = 0; i < sizeof(aPairs) / sizeof(aPairs[0]); i++)
+    {
+        PPAIR pPair = &aPairs[i];
+        double PerPixel, Line;
+
+        cjSrcDelta = (WIDTH * pPair->cjSrcPixel + 3) & ~3;
+        cjDstDelta = (WIDTH * pPair->cjDstPixel + 3) & ~3;
+
+        /* Both versions must produce the same bits */
+        memset(pjRef, 0xCC, cjSize);
+        memset(pjDst, 0xCC, cjSize);
+        pPair->pfnPerPixel(pPair, pjRef, pjSrc);
+        pPair->pfnLine(pPair, pjDst, pjSrc);
+        if (memcmp(pjRef, pjDst, cjDstDelta * HEIGHT) != 0)
+        {
+            printf("%-18s MISMATCH\n", pPair->pszName);
+            iResult = 1;
+            continue;
+        }
+
+        PerPixel = MPixelsPerSecond(pPair, pPair->pfnPerPixel, pjRef, pjSrc);
+        Line = MPixelsPerSecond(pPair, pPair->pfnLine, pjDst, pjSrc);
+        printf("%-18s %8.1f MP/s %8.1f MP/s\n", pPair->pszName, PerPixel, Line);
+    }
+
+    free(pjSrc);
+    free(pjDst);
+    free(pjRef);
+    return iResult;
+}
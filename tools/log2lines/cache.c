@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 #include "util.h"
 #include "version.h"
@@ -21,6 +22,25 @@
 static char *cache_name;
 static char *tmp_name;
 
+static void
+get_index_name(char *buf, const char *Fname)
+{
+    if (Fname)
+        sprintf(buf, "%s" INDEX_SUFFIX PATH_STR "%s", cache_name, Fname);
+    else
+        sprintf(buf, "%s" INDEX_SUFFIX, cache_name);
+}
+
+static int
+index_dir_exists(void)
+{
+    char dir[PATH_MAX];
+    struct stat st;
+
+    get_index_name(dir, NULL);
+    return stat(dir, &st) == 0 && (st.st_mode & S_IFDIR);
+}
+
 static int
 unpack_iso(char *dir, char *iso)
 {
@@ -194,12 +214,34 @@ read_cache(void)
     return result;
 }
 
+void *
+load_index(PLIST_MEMBER pentry)
+{
+    char indexName[PATH_MAX];
+
+    /* Map each image's index once, it stays mapped for later lookups */
+    if (!pentry->indexTried)
+    {
+        pentry->indexTried = 1;
+        get_index_name(indexName, pentry->name);
+        pentry->index = map_index(indexName, pentry->path, &pentry->indexSize);
+        if (pentry->index)
+        {
+            l2l_dbg(2, "Loaded symbol index %s\n", indexName);
+            summ.index_loads++;
+        }
+    }
+    return pentry->index;
+}
+
 int
 create_cache(int force, int skipImageBase)
 {
     FILE *fr, *fw;
     char *Line = NULL, *Fname = NULL;
+    char indexName[PATH_MAX];
     int len, err;
+    int indexed = 0;
     size_t ImageBase;
 
     if ((fw = fopen(tmp_name, "w")) == NULL)
@@ -222,13 +264,19 @@ create_cache(int force, int skipImageBase)
     }
     else
     {
-        if (file_exists(cache_name))
+        if (file_exists(cache_name) && (skipImageBase || index_dir_exists()))
         {
             l2l_dbg(3, "Cache %s already exists\n", cache_name);
             return 0;
         }
     }
 
+    if (!skipImageBase)
+    {
+        get_index_name(indexName, NULL);
+        MKDIR(indexName);
+    }
+
     Line = malloc(LINESIZE + 1);
     if (!Line)
         return 1;
@@ -269,7 +317,12 @@ create_cache(int force, int skipImageBase)
                 if (*Fname && !skipImageBase)
                 {
                     if ((err = get_ImageBase(Line, &ImageBase)) == 0)
+                    {
                         fprintf(fw, "%s|%s|%0x\n", Fname, Line, (unsigned int)ImageBase);
+                        get_index_name(indexName, Fname);
+                        if (!create_index(Line, indexName, ImageBase))
+                            indexed++;
+                    }
                     else
                         l2l_dbg(3, "%s|%s|%0x, ERR=%d\n", Fname, Line, (unsigned int)ImageBase, err);
                 }
@@ -277,6 +330,7 @@ create_cache(int force, int skipImageBase)
             fclose(fw);
         }
         l2l_dbg(0, "... done\n");
+        l2l_dbg(1, "%d symbol indexes created\n", indexed);
         fclose(fr);
     }
     remove(tmp_name);
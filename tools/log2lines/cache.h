@@ -7,9 +7,12 @@
 
 #pragma once
 
+#include "list.h"
+
 int check_directory(int force);
 int read_cache(void);
 int create_cache(int force, int skipImageBase);
 int cleanable(char *path);
+void *load_index(PLIST_MEMBER pentry);
 
 /* EOF */
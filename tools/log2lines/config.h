@@ -12,6 +12,8 @@
 #define DEF_OPT_DIR     "output-i386"
 #define SOURCES_ENV     "_ROSBE_ROSSOURCEDIR"
 #define CACHEFILE       "log2lines.cache"
+#define INDEX_SUFFIX    ".idx"       // directory with symbol indexes: <cachefile>.idx
+#define MAGIC_SYMINDEX  0x58444953 //'SIDX'
 #define TRKBUILDPREFIX  "bootcd-"
 #define SVN_PREFIX      "/trunk/reactos/"
 #define PIPEREAD_CMD    "piperead -c"
@@ -28,11 +28,16 @@ char *verboseUsage =
 "  - An image with base < 0x400000 MUST be relocated to a > 0x400000 address.\n"
 "  - The offset of a relocated image MUST be relative.\n\n"
 "  log2lines uses a cache in order to avoid a directory scan at each\n"
-"  image lookup, greatly increasing performance. Only image path and its\n"
-"  base address are cached.\n\n"
+"  image lookup, greatly increasing performance. The cache holds the image\n"
+"  path and its base address, and for each image with symbols an index of\n"
+"  its function and line ranges, so images need not be read again.\n\n"
 "Options:\n"
 "  -b   Use this combined with '-l'. Enable buffering on logFile.\n"
 "       This may solve loosing output on real hardware (ymmv).\n\n"
+"  -B   Batch mode. Translate a complete log from stdin as fast as possible:\n"
+"       - Output is fully buffered and console mode (-c) is disabled.\n"
+"       - Images are only looked up in the cache, not by their path.\n"
+"       Each symbol index is loaded once and kept for the whole log.\n\n"
 "  -c   Console mode. Outputs text per character instead of per line.\n"
 "       This is slightly slower but enables to see what you type.\n\n"
 "  -d <directory>|<ISO image>\n"
@@ -105,6 +110,8 @@ char *verboseUsage =
 "       - Reg candidates:  Regression candidates. See '-R regscan'\n"
 "       - Offset error:    Image exists, but error retrieving offset info.\n"
 "       - Total:           Total number of lines attempted to translate.\n"
+"       - Indexes loaded:  Images translated through their symbol index.\n"
+"       - Images loaded:   Images read because they had no (valid) index.\n"
 "       Also some version info is displayed.\n\n"
 "  -S <context>[+<add>][,<sources>]\n"
 "       Source line options:\n"
@@ -168,6 +175,8 @@ char *verboseUsage =
 "       log2lines -c -l dbg.log -P \"piperead -c \\\\.\\pipe\\kdbg\"\n\n"
 "  Use kdbg debugger to send output to logfile:\n"
 "       log2lines < \\\\.\\pipe\\kdbg > dbg.log\n\n"
+"  Translate a large debug log in batch mode:\n"
+"       log2lines -B -d output-i386 < bugxxxx.log > bugxxxx-translated.log\n\n"
 "  Re-translate a debug log:\n"
 "       log2lines -U -d bootcd-38701-dbg.iso < bugxxxx.log\n\n"
 "  Re-translate a debug log. Specify a 7z file, which wil be decompressed.\n"
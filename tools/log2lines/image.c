@@ -7,9 +7,17 @@
 
 #include <errno.h>
 #include <string.h>
+#include <sys/stat.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include <rsym.h>
 
 #include "compat.h"
+#include "config.h"
+#include "image.h"
 #include "util.h"
 #include "options.h"
 #include "log2lines.h"
@@ -40,19 +48,22 @@ find_offset(void *data, size_t offset)
     PSYMBOLFILE_HEADER RosSymHeader = (PSYMBOLFILE_HEADER)data;
     PROSSYM_ENTRY Entries = (PROSSYM_ENTRY)((char *)data + RosSymHeader->SymbolsOffset);
     size_t symbols = RosSymHeader->SymbolsLength / sizeof(ROSSYM_ENTRY);
-    size_t i;
+    size_t low = 0, high = symbols, mid;
 
-    for (i = 0; i < symbols; i++)
+    /* rsym sorts the entries by address, find the first one above offset */
+    while (low < high)
     {
-        if (Entries[i].Address > offset)
-        {
-            if (!i--)
-                return NULL;
-            else
-                return &Entries[i];
-        }
+        mid = low + (high - low) / 2;
+        if (Entries[mid].Address > offset)
+            high = mid;
+        else
+            low = mid + 1;
     }
-    return NULL;
+
+    /* Offsets before the first or past the last entry are not resolved */
+    if (low == 0 || low == symbols)
+        return NULL;
+    return &Entries[low - 1];
 }
 
 PIMAGE_SECTION_HEADER
@@ -97,6 +108,191 @@ get_sectionheader(const void *FileData)
     return PERosSymSectionHeader;
 }
 
+/* Same as get_sectionheader(), but quiet and checked against the file size */
+static PIMAGE_SECTION_HEADER
+locate_rossym(const void *FileData, size_t FileSize)
+{
+    PIMAGE_DOS_HEADER PEDosHeader = (PIMAGE_DOS_HEADER)FileData;
+    PIMAGE_FILE_HEADER PEFileHeader;
+    PIMAGE_OPTIONAL_HEADER PEOptHeader;
+    PIMAGE_SECTION_HEADER PESectionHeaders;
+    size_t HeadersEnd;
+
+    if (FileSize < sizeof(IMAGE_DOS_HEADER) ||
+        PEDosHeader->e_magic != IMAGE_DOS_MAGIC || PEDosHeader->e_lfanew == 0L)
+        return NULL;
+
+    HeadersEnd = PEDosHeader->e_lfanew + sizeof(ULONG) + sizeof(IMAGE_FILE_HEADER);
+    if (HeadersEnd > FileSize)
+        return NULL;
+    PEFileHeader = (PIMAGE_FILE_HEADER)((char *)FileData + PEDosHeader->e_lfanew + sizeof(ULONG));
+    PEOptHeader = (PIMAGE_OPTIONAL_HEADER)(PEFileHeader + 1);
+
+    HeadersEnd += PEFileHeader->SizeOfOptionalHeader +
+                  PEFileHeader->NumberOfSections * sizeof(IMAGE_SECTION_HEADER);
+    if (HeadersEnd > FileSize)
+        return NULL;
+    PESectionHeaders = (PIMAGE_SECTION_HEADER)((char *)PEOptHeader + PEFileHeader->SizeOfOptionalHeader);
+
+    return find_rossym_section(PEFileHeader, PESectionHeaders);
+}
+
+static int
+rossym_length(const void *data, size_t available, size_t *length)
+{
+    PSYMBOLFILE_HEADER RosSymHeader = (PSYMBOLFILE_HEADER)data;
+    PROSSYM_ENTRY Entries;
+    size_t symbols, i, end;
+
+    if (available < sizeof(SYMBOLFILE_HEADER))
+        return 1;
+
+    end = (size_t)RosSymHeader->SymbolsOffset + RosSymHeader->SymbolsLength;
+    if ((size_t)RosSymHeader->StringsOffset + RosSymHeader->StringsLength > end)
+        end = (size_t)RosSymHeader->StringsOffset + RosSymHeader->StringsLength;
+    if (end > available)
+        return 2;
+
+    /* Lookups use a binary search, so the entries must be sorted */
+    Entries = (PROSSYM_ENTRY)((char *)data + RosSymHeader->SymbolsOffset);
+    symbols = RosSymHeader->SymbolsLength / sizeof(ROSSYM_ENTRY);
+    for (i = 1; i < symbols; i++)
+    {
+        if (Entries[i].Address < Entries[i - 1].Address)
+            return 3;
+    }
+
+    *length = end;
+    return 0;
+}
+
+int
+create_index(char *fname, char *indexName, size_t ImageBase)
+{
+    SYMINDEX_HEADER Header;
+    PIMAGE_SECTION_HEADER PERosSymSectionHeader;
+    struct stat st;
+    void *FileData;
+    size_t FileSize, RosSymLength;
+    char *RosSym;
+    FILE *fw;
+    int res = 0;
+
+    if (stat(fname, &st) != 0)
+        return 1;
+
+    FileData = load_file(fname, &FileSize);
+    if (!FileData)
+        return 2;
+
+    PERosSymSectionHeader = locate_rossym(FileData, FileSize);
+    if (!PERosSymSectionHeader || PERosSymSectionHeader->PointerToRawData >= FileSize)
+    {
+        l2l_dbg(3, "create_index %s, no rossym section\n", fname);
+        free(FileData);
+        return 3;
+    }
+
+    RosSym = (char *)FileData + PERosSymSectionHeader->PointerToRawData;
+    if ((res = rossym_length(RosSym, FileSize - PERosSymSectionHeader->PointerToRawData, &RosSymLength)))
+    {
+        l2l_dbg(1, "create_index %s, unusable rossym data (%d)\n", fname, res);
+        free(FileData);
+        return 4;
+    }
+
+    Header.Magic = MAGIC_SYMINDEX;
+    Header.ImageSize = (ULONG)st.st_size;
+    Header.ImageTime = (ULONG)st.st_mtime;
+    Header.ImageBase = (ULONG)ImageBase;
+    Header.RosSymLength = (ULONG)RosSymLength;
+
+    fw = fopen(indexName, "wb");
+    if (!fw)
+    {
+        l2l_dbg(1, "create_index, cannot create '%s' (%s)\n", indexName, strerror(errno));
+        free(FileData);
+        return 5;
+    }
+    if (fwrite(&Header, sizeof(Header), 1, fw) != 1 ||
+        fwrite(RosSym, RosSymLength, 1, fw) != 1)
+    {
+        l2l_dbg(1, "create_index, write error on '%s' (%s)\n", indexName, strerror(errno));
+        res = 6;
+    }
+    if (fclose(fw) != 0 && !res)
+        res = 6;
+    if (res)
+        remove(indexName);
+
+    free(FileData);
+    return res;
+}
+
+void *
+map_index(char *indexName, char *fname, size_t *indexSize)
+{
+    PSYMINDEX_HEADER Header;
+    struct stat st;
+    void *index;
+    size_t size;
+
+    /* An index is only valid for the image it was created from */
+    if (stat(fname, &st) != 0)
+        return NULL;
+
+#if defined(_WIN32)
+    index = load_file(indexName, &size);
+    if (!index)
+        return NULL;
+#else
+    {
+        struct stat ist;
+        int fd = open(indexName, O_RDONLY);
+
+        if (fd < 0)
+            return NULL;
+        if (fstat(fd, &ist) != 0 || (size_t)ist.st_size < sizeof(SYMINDEX_HEADER))
+        {
+            close(fd);
+            return NULL;
+        }
+        size = ist.st_size;
+        index = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (index == MAP_FAILED)
+            return NULL;
+    }
+#endif
+
+    Header = (PSYMINDEX_HEADER)index;
+    if (size < sizeof(SYMINDEX_HEADER) ||
+        Header->Magic != MAGIC_SYMINDEX ||
+        Header->ImageSize != (ULONG)st.st_size ||
+        Header->ImageTime != (ULONG)st.st_mtime ||
+        Header->RosSymLength > size - sizeof(SYMINDEX_HEADER))
+    {
+        l2l_dbg(2, "Symbol index %s is stale or damaged\n", indexName);
+        unmap_index(index, size);
+        return NULL;
+    }
+
+    *indexSize = size;
+    return index;
+}
+
+void
+unmap_index(void *index, size_t indexSize)
+{
+    if (!index)
+        return;
+#if defined(_WIN32)
+    free(index);
+#else
+    munmap(index, indexSize);
+#endif
+}
+
 int
 get_ImageBase(char *fname, size_t *ImageBase)
 {
@@ -9,6 +9,21 @@
 
 #include <rsym.h>
 
+/* Symbol index, stored per image in the cache directory.
+ * It is followed by a copy of the image's .rossym data, with the
+ * entries sorted by address.
+ */
+typedef struct _SYMINDEX_HEADER
+{
+    ULONG Magic;            // MAGIC_SYMINDEX
+    ULONG ImageSize;        // Size of the image the index was created from
+    ULONG ImageTime;        // Modification time of that image
+    ULONG ImageBase;
+    ULONG RosSymLength;     // Size of the .rossym data following this header
+} SYMINDEX_HEADER, *PSYMINDEX_HEADER;
+
+#define INDEX_ROSSYM(index) ((char *)(index) + sizeof(SYMINDEX_HEADER))
+
 size_t fixup_offset(size_t ImageBase, size_t offset);
 
 PROSSYM_ENTRY find_offset(void *data, size_t offset);
@@ -17,4 +32,10 @@ PIMAGE_SECTION_HEADER get_sectionheader(const void *FileData);
 
 int get_ImageBase(char *fname, size_t *ImageBase);
 
+int create_index(char *fname, char *indexName, size_t ImageBase);
+
+void *map_index(char *indexName, char *fname, size_t *indexSize);
+
+void unmap_index(void *index, size_t indexSize);
+
 /* EOF */
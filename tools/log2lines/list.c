@@ -165,6 +165,9 @@ cache_entry_create(char *Line)
     }
     pentry->RelBase = INVALID_BASE;
     pentry->Size = 0;
+    pentry->index = NULL;
+    pentry->indexSize = 0;
+    pentry->indexTried = 0;
     return pentry;
 }
 
@@ -184,6 +187,7 @@ sources_entry_create(PLIST list, char *path, char *prefix)
     pentry = malloc(sizeof(LIST_MEMBER));
     if (!pentry)
         return NULL;
+    memset(pentry, 0, sizeof(LIST_MEMBER));
 
     l = strlen(path) + strlen(prefix);
     pentry->buf = s = malloc(l + 1);
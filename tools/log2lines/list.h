@@ -8,6 +8,9 @@ typedef struct entry_struct
     size_t ImageBase;
     size_t RelBase;
     size_t Size;
+    void *index;            // Mapped symbol index, see load_index()
+    size_t indexSize;
+    int indexTried;
     struct entry_struct *pnext;
 } LIST_MEMBER, *PLIST_MEMBER;
 
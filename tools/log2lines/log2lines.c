@@ -218,15 +218,11 @@ print_offset(void *data, size_t offset, char *toString)
 }
 
 static int
-process_data(const void *FileData, size_t offset, char *toString)
+process_rossym(void *RosSym, size_t offset, char *toString)
 {
     int res;
 
-    PIMAGE_SECTION_HEADER PERosSymSectionHeader = get_sectionheader((char *)FileData);
-    if (!PERosSymSectionHeader)
-        return 2;
-
-    res = print_offset((char *)FileData + PERosSymSectionHeader->PointerToRawData, offset, toString);
+    res = print_offset(RosSym, offset, toString);
     if (res)
     {
         if (toString)
@@ -240,6 +236,16 @@ process_data(const void *FileData, size_t offset, char *toString)
     return res;
 }
 
+static int
+process_data(const void *FileData, size_t offset, char *toString)
+{
+    PIMAGE_SECTION_HEADER PERosSymSectionHeader = get_sectionheader((char *)FileData);
+    if (!PERosSymSectionHeader)
+        return 2;
+
+    return process_rossym((char *)FileData + PERosSymSectionHeader->PointerToRawData, offset, toString);
+}
+
 static int
 process_file(const char *file_name, size_t offset, char *toString)
 {
@@ -254,6 +260,7 @@ process_file(const char *file_name, size_t offset, char *toString)
     }
     else
     {
+        summ.image_loads++;
         res = process_data(FileData, offset, toString);
         free(FileData);
     }
@@ -272,8 +279,8 @@ translate_file(const char *cpath, size_t offset, char *toString)
     if (!path)
         return 1;
 
-    // The path could be absolute:
-    if (get_ImageBase(path, &base))
+    // The path could be absolute (batch mode only uses the cache):
+    if (opt_batch || get_ImageBase(path, &base))
     {
         pentry = entry_lookup(&cache, path);
         if (pentry)
@@ -295,7 +302,10 @@ translate_file(const char *cpath, size_t offset, char *toString)
 
     if (!res)
     {
-        res = process_file(path, offset, toString);
+        if (pentry && load_index(pentry))
+            res = process_rossym(INDEX_ROSSYM(pentry->index), offset, toString);
+        else
+            res = process_file(path, offset, toString);
     }
 
     free(dpath);
@@ -322,7 +332,7 @@ remove_mark(char *Line)
 static void
 translate_line(FILE *outFile, char *Line, char *path, char *LineOut)
 {
-    size_t offset;
+    size_t offset = 0;  // sscanf below only fills the low 32 bits
     int cnt, res;
     char *sep, *tail, *mark, *s;
     unsigned char ch;
@@ -610,6 +620,9 @@ main(int argc, const char **argv)
         return 2;
     l2l_dbg(4, "opt_logFile processed\n");
 
+    if (opt_batch)
+        setvbuf(conOut, NULL, _IOFBF, 64 * 1024);
+
     if (opt_Pipe)
     {
         l2l_dbg(3, "Command line: \"%s\"\n",opt_Pipe);
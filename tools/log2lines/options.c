@@ -17,8 +17,9 @@
 #include "log2lines.h"
 #include "options.h"
 
-char *optchars       = "bcd:fFhl:L:mMP:rR:sS:tTuUvz:";
+char *optchars       = "bBcd:fFhl:L:mMP:rR:sS:tTuUvz:";
 int   opt_buffered   = 0;        // -b
+int   opt_batch      = 0;        // -B
 int   opt_help       = 0;        // -h
 int   opt_force      = 0;        // -f
 int   opt_exit       = 0;        // -e
@@ -128,6 +129,9 @@ int optionParse(int argc, const char **argv)
         case 'b':
             opt_buffered++;
             break;
+        case 'B':
+            opt_batch++;
+            break;
         case 'c':
             opt_console++;
             break;
@@ -217,6 +221,11 @@ int optionParse(int argc, const char **argv)
         }
         optCount++;
     }
+    if (opt_batch && opt_console)
+    {
+        l2l_dbg(2, "Note: console mode is not available in batch mode\n");
+        opt_console = 0;
+    }
     if(opt_console)
     {
         l2l_dbg(2, "Note: use 's' command in console mode. Statistics option disabled\n");
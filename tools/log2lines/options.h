@@ -9,6 +9,7 @@
 
 extern char *optchars;
 extern int   opt_buffered;  // -b
+extern int   opt_batch;     // -B
 extern int   opt_help;      // -h
 extern int   opt_force;     // -f
 extern int   opt_exit;      // -e
@@ -29,6 +29,8 @@ stat_print(FILE *outFile, PSUMM psumm)
         clilog(outFile, "Regression candidates:    %d\n", psumm->regfound);
         clilog(outFile, "Offset error:             %d\n", psumm->offset_errors);
         clilog(outFile, "Total:                    %d\n", psumm->total);
+        clilog(outFile, "Symbol indexes loaded:    %d\n", psumm->index_loads);
+        clilog(outFile, "Images loaded:            %d\n", psumm->image_loads);
         clilog(outFile, "-------------------------------\n");
         clilog(outFile, "Log2lines version: " LOG2LINES_VERSION "\n");
         clilog(outFile, "Directory:         %s\n", opt_dir);
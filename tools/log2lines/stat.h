@@ -21,6 +21,8 @@ typedef struct summ_struct
     int regfound;
     int offset_errors;
     int total;
+    int index_loads;
+    int image_loads;
 } SUMM, *PSUMM;
 
 void stat_print(FILE *outFile, PSUMM psumm);
@@ -26,6 +26,7 @@
 /* INCLUDES *****************************************************************/
 
 #include <stdio.h>
+#include <time.h>
 
 #include "mkhive.h"
 
@@ -36,6 +37,7 @@ ExportBinaryHive(
 {
     FILE *File;
     BOOL ret;
+    clock_t Start;
 
     printf ("  Creating binary hive: %s\n", FileName);
 
@@ -49,9 +51,17 @@ ExportBinaryHive(
 
     fseek (File, 0, SEEK_SET);
 
+    Start = clock();
     Hive->FileHandles[HFILE_TYPE_PRIMARY] = (HANDLE)File;
     ret = HvWriteHive(&Hive->Hive);
     fclose (File);
+
+    if (ShowTimings)
+    {
+        printf ("    %lu blocks written in %lu ms\n",
+                Hive->Hive.Storage[Stable].Length,
+                (unsigned long)((clock() - Start) * 1000 / CLOCKS_PER_SEC));
+    }
     return ret;
 }
 
@@ -26,6 +26,28 @@
 #define NDEBUG
 #include "mkhive.h"
 
+/*
+ * In-memory index of the subkeys created while importing, so that looking
+ * up a key does not have to scan all the subkeys of its parent. All keys
+ * are created through CmiAddSubKey, which keeps it complete; if it ever
+ * fails to grow, it is dropped and lookups go back to scanning the hive.
+ */
+typedef struct _CMI_SUBKEY_ENTRY
+{
+    struct _CMI_SUBKEY_ENTRY *Next;
+    PCMHIVE RegistryHive;
+    HCELL_INDEX ParentKeyCellOffset;
+    HCELL_INDEX KeyCellOffset;
+    ULONG HashKey;
+} CMI_SUBKEY_ENTRY, *PCMI_SUBKEY_ENTRY;
+
+#define CMI_SUBKEY_INDEX_INITIAL_SIZE 4096
+
+static PCMI_SUBKEY_ENTRY *CmiSubKeyIndex;
+static ULONG CmiSubKeyIndexSize;
+static ULONG CmiSubKeyIndexCount;
+static BOOLEAN CmiSubKeyIndexDisabled;
+
 PVOID
 NTAPI
 CmpAllocate(
@@ -325,6 +347,158 @@ CmiCreateSubKey(
     return Status;
 }
 
+static ULONG
+CmiHashSubKey(
+    IN PCMHIVE RegistryHive,
+    IN HCELL_INDEX ParentKeyCellOffset,
+    IN PCUNICODE_STRING SubKeyName)
+{
+    ULONG HashKey = (ULONG)(ULONG_PTR)RegistryHive ^ (ParentKeyCellOffset * 0x9E3779B1);
+    PWCHAR NamePtr = SubKeyName->Buffer;
+    USHORT NameLength = SubKeyName->Length / sizeof(WCHAR);
+    USHORT i;
+
+    /* Skip leading backslash, like CmiCreateSubKey */
+    if (NameLength != 0 && NamePtr[0] == L'\\')
+    {
+        NamePtr++;
+        NameLength--;
+    }
+
+    for (i = 0; i < NameLength; i++)
+    {
+        HashKey = 37 * HashKey + RtlUpcaseUnicodeChar(NamePtr[i]);
+    }
+
+    return HashKey;
+}
+
+VOID
+CmiFreeSubKeyIndex(VOID)
+{
+    PCMI_SUBKEY_ENTRY Entry, Next;
+    ULONG i;
+
+    if (!CmiSubKeyIndex)
+        return;
+
+    for (i = 0; i < CmiSubKeyIndexSize; i++)
+    {
+        for (Entry = CmiSubKeyIndex[i]; Entry; Entry = Next)
+        {
+            Next = Entry->Next;
+            free(Entry);
+        }
+    }
+
+    free(CmiSubKeyIndex);
+    CmiSubKeyIndex = NULL;
+    CmiSubKeyIndexSize = 0;
+    CmiSubKeyIndexCount = 0;
+}
+
+static BOOLEAN
+CmiGrowSubKeyIndex(VOID)
+{
+    PCMI_SUBKEY_ENTRY *NewIndex;
+    PCMI_SUBKEY_ENTRY Entry, Next;
+    ULONG NewSize, i;
+
+    NewSize = CmiSubKeyIndexSize ? CmiSubKeyIndexSize * 2 : CMI_SUBKEY_INDEX_INITIAL_SIZE;
+    NewIndex = (PCMI_SUBKEY_ENTRY *)calloc(NewSize, sizeof(PCMI_SUBKEY_ENTRY));
+    if (!NewIndex)
+        return FALSE;
+
+    /* Rehash the existing entries, the size is always a power of two */
+    for (i = 0; i < CmiSubKeyIndexSize; i++)
+    {
+        for (Entry = CmiSubKeyIndex[i]; Entry; Entry = Next)
+        {
+            Next = Entry->Next;
+            Entry->Next = NewIndex[Entry->HashKey & (NewSize - 1)];
+            NewIndex[Entry->HashKey & (NewSize - 1)] = Entry;
+        }
+    }
+
+    free(CmiSubKeyIndex);
+    CmiSubKeyIndex = NewIndex;
+    CmiSubKeyIndexSize = NewSize;
+    return TRUE;
+}
+
+static VOID
+CmiInsertSubKeyIndex(
+    IN PCMHIVE RegistryHive,
+    IN HCELL_INDEX ParentKeyCellOffset,
+    IN PCUNICODE_STRING SubKeyName,
+    IN HCELL_INDEX KeyCellOffset)
+{
+    PCMI_SUBKEY_ENTRY Entry;
+
+    if (CmiSubKeyIndexDisabled)
+        return;
+
+    /* Keep the chains short by growing once there are two entries per bucket */
+    if (CmiSubKeyIndexCount >= CmiSubKeyIndexSize * 2 && !CmiGrowSubKeyIndex())
+        goto Disable;
+
+    Entry = (PCMI_SUBKEY_ENTRY)malloc(sizeof(CMI_SUBKEY_ENTRY));
+    if (!Entry)
+        goto Disable;
+
+    Entry->RegistryHive = RegistryHive;
+    Entry->ParentKeyCellOffset = ParentKeyCellOffset;
+    Entry->KeyCellOffset = KeyCellOffset;
+    Entry->HashKey = CmiHashSubKey(RegistryHive, ParentKeyCellOffset, SubKeyName);
+    Entry->Next = CmiSubKeyIndex[Entry->HashKey & (CmiSubKeyIndexSize - 1)];
+    CmiSubKeyIndex[Entry->HashKey & (CmiSubKeyIndexSize - 1)] = Entry;
+    CmiSubKeyIndexCount++;
+    return;
+
+Disable:
+    DPRINT1("Out of memory for the subkey index, falling back to scanning\n");
+    CmiFreeSubKeyIndex();
+    CmiSubKeyIndexDisabled = TRUE;
+}
+
+static NTSTATUS
+CmiLookupSubKeyIndex(
+    IN PCMHIVE RegistryHive,
+    IN HCELL_INDEX ParentKeyCellOffset,
+    IN PCUNICODE_STRING SubKeyName,
+    IN BOOLEAN CaseInsensitive,
+    OUT PCM_KEY_NODE *pSubKeyCell,
+    OUT HCELL_INDEX *pBlockOffset)
+{
+    PCMI_SUBKEY_ENTRY Entry;
+    PCM_KEY_NODE CurSubKeyCell;
+    ULONG HashKey;
+
+    if (!CmiSubKeyIndex)
+        return STATUS_OBJECT_NAME_NOT_FOUND;
+
+    HashKey = CmiHashSubKey(RegistryHive, ParentKeyCellOffset, SubKeyName);
+    for (Entry = CmiSubKeyIndex[HashKey & (CmiSubKeyIndexSize - 1)]; Entry; Entry = Entry->Next)
+    {
+        if (Entry->HashKey != HashKey ||
+            Entry->RegistryHive != RegistryHive ||
+            Entry->ParentKeyCellOffset != ParentKeyCellOffset)
+        {
+            continue;
+        }
+
+        CurSubKeyCell = (PCM_KEY_NODE)HvGetCell(&RegistryHive->Hive, Entry->KeyCellOffset);
+        if (CmCompareKeyName(CurSubKeyCell, SubKeyName, CaseInsensitive))
+        {
+            *pSubKeyCell = CurSubKeyCell;
+            *pBlockOffset = Entry->KeyCellOffset;
+            return STATUS_SUCCESS;
+        }
+    }
+
+    return STATUS_OBJECT_NAME_NOT_FOUND;
+}
+
 NTSTATUS
 CmiAddSubKey(
     IN PCMHIVE RegistryHive,
@@ -359,6 +533,8 @@ CmiAddSubKey(
     KeQuerySystemTime(&ParentKeyCell->LastWriteTime);
     HvMarkCellDirty(&RegistryHive->Hive, ParentKeyCellOffset, FALSE);
 
+    CmiInsertSubKeyIndex(RegistryHive, ParentKeyCellOffset, SubKeyName, NKBOffset);
+
     *pBlockOffset = NKBOffset;
     return STATUS_SUCCESS;
 }
@@ -421,6 +597,17 @@ CmiScanForSubKey(
     *pSubKeyCell = NULL;
     CaseInsensitive = (Attributes & OBJ_CASE_INSENSITIVE) != 0;
 
+    /* The index knows about every subkey, unless it had to be dropped */
+    if (!CmiSubKeyIndexDisabled)
+    {
+        return CmiLookupSubKeyIndex(RegistryHive,
+                                    ParentKeyCellOffset,
+                                    SubKeyName,
+                                    CaseInsensitive,
+                                    pSubKeyCell,
+                                    pBlockOffset);
+    }
+
     for (Storage = Stable; Storage < HTYPE_COUNT; Storage++)
     {
         if (KeyCell->SubKeyLists[Storage] == HCELL_NIL)
@@ -39,6 +39,9 @@ CmiAddSubKey(
     OUT PCM_KEY_NODE *pSubKeyCell,
     OUT HCELL_INDEX *pBlockOffset);
 
+VOID
+CmiFreeSubKeyIndex(VOID);
+
 NTSTATUS
 CmiScanForSubKey(
     IN PCMHIVE RegistryHive,
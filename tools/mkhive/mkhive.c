@@ -27,6 +27,7 @@
 #include <limits.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 
 #include "mkhive.h"
 
@@ -46,10 +47,12 @@
 #define DIR_SEPARATOR_STRING "\\"
 #endif
 
+BOOL ShowTimings = FALSE;
 
 void usage (void)
 {
-    printf ("Usage: mkhive <dstdir> <inffiles>\n\n");
+    printf ("Usage: mkhive [-t] <dstdir> <inffiles>\n\n");
+    printf ("  -t       - print how long each import and hive write took\n");
     printf ("  dstdir   - binary hive files are created in this directory\n");
     printf ("  inffiles - inf files with full path\n");
 }
@@ -85,8 +88,16 @@ void convert_path(char *dst, char *src)
 int main (int argc, char *argv[])
 {
     char FileName[PATH_MAX];
+    clock_t Start;
     int i;
 
+    if ((argc > 1) && (strcmp (argv[1], "-t") == 0))
+    {
+        ShowTimings = TRUE;
+        argc--;
+        argv++;
+    }
+
     if (argc < 3)
     {
         usage ();
@@ -100,7 +111,13 @@ int main (int argc, char *argv[])
     for (i = 2; i < argc; i++)
     {
         convert_path (FileName, argv[i]);
+        Start = clock();
         ImportRegistryFile (FileName);
+        if (ShowTimings)
+        {
+            printf ("  Imported %s in %lu ms\n", FileName,
+                    (unsigned long)((clock() - Start) * 1000 / CLOCKS_PER_SEC));
+        }
     }
 
     convert_path (FileName, argv[1]);
@@ -125,6 +125,7 @@ RegOpenKeyW(
 #define HIVE_NO_FILE 2
 #define VERIFY_REGISTRY_HIVE(hive)
 extern LIST_ENTRY CmiHiveListHead;
+extern BOOL ShowTimings;
 #define ABS_VALUE(V) (((V) < 0) ? -(V) : (V))
 #define PAGED_CODE()
 
@@ -587,6 +587,7 @@ RegShutdownRegistry(VOID)
 {
     /* FIXME: clean up the complete hive */
 
+    CmiFreeSubKeyIndex();
     free(RootKey);
 }
 
@@ -1,5 +1,6 @@
 /*
- * Usage: rsym input-file output-file
+ * Usage: rsym [-s sources] input-file output-file
+ *        rsym [-s sources] [-j jobs] -l module-list
  *
  * There are two sources of information: the .stab/.stabstr
  * sections of the executable and the COFF symbol table. Most
@@ -27,6 +28,11 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <wchar.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
 
 #include "rsym.h"
 
@@ -126,6 +132,72 @@ CompareSymEntry(const PROSSYM_ENTRY SymEntry1, const PROSSYM_ENTRY SymEntry2)
     return 0;
 }
 
+/*
+ * Stable LSD radix sort of the symbol entries on their address, one byte
+ * per pass. Passes where every entry has the same byte are skipped, which
+ * in practice leaves two or three passes for a 32-bit image. Entries with
+ * equal addresses keep their relative order, which keeps the generated
+ * .rossym section reproducible (qsort gave no such guarantee).
+ */
+static void
+SortSymEntries(PROSSYM_ENTRY SymbolsBase, ULONG SymbolsCount)
+{
+    PROSSYM_ENTRY Temp, From, To, Swap;
+    ULONG Count[256];
+    ULONG Pass, i, Sum, Old;
+    unsigned Byte;
+
+    if (SymbolsCount < 2)
+    {
+        return;
+    }
+
+    Temp = malloc(SymbolsCount * sizeof(ROSSYM_ENTRY));
+    if (Temp == NULL)
+    {
+        qsort(SymbolsBase, SymbolsCount, sizeof(ROSSYM_ENTRY), (int (*)(const void *, const void *)) CompareSymEntry);
+        return;
+    }
+
+    From = SymbolsBase;
+    To = Temp;
+    for (Pass = 0; Pass < sizeof(TARGET_ULONG_PTR); Pass++)
+    {
+        memset(Count, 0, sizeof(Count));
+        for (i = 0; i < SymbolsCount; i++)
+        {
+            Count[(From[i].Address >> (Pass * 8)) & 0xff]++;
+        }
+
+        Byte = (From[0].Address >> (Pass * 8)) & 0xff;
+        if (Count[Byte] == SymbolsCount)
+        {
+            continue;
+        }
+
+        for (Sum = 0, i = 0; i < 256; i++)
+        {
+            Old = Count[i];
+            Count[i] = Sum;
+            Sum += Old;
+        }
+        for (i = 0; i < SymbolsCount; i++)
+        {
+            To[Count[(From[i].Address >> (Pass * 8)) & 0xff]++] = From[i];
+        }
+
+        Swap = From;
+        From = To;
+        To = Swap;
+    }
+
+    if (From != SymbolsBase)
+    {
+        memcpy(SymbolsBase, From, SymbolsCount * sizeof(ROSSYM_ENTRY));
+    }
+    free(Temp);
+}
+
 static int
 GetStabInfo(void *FileData, PIMAGE_FILE_HEADER PEFileHeader,
             PIMAGE_SECTION_HEADER PESectionHeaders,
@@ -350,7 +422,7 @@ ConvertStabs(ULONG *SymbolsCount, PROSSYM_ENTRY *SymbolsBase,
     }
     *SymbolsCount = (Current - *SymbolsBase + 1);
 
-    qsort(*SymbolsBase, *SymbolsCount, sizeof(ROSSYM_ENTRY), (int (*)(const void *, const void *)) CompareSymEntry);
+    SortSymEntries(*SymbolsBase, *SymbolsCount);
 
     StringHashTableFree(&StringHash);
 
@@ -441,7 +513,7 @@ ConvertCoffs(ULONG *SymbolsCount, PROSSYM_ENTRY *SymbolsBase,
     }
 
     *SymbolsCount = (Current - *SymbolsBase + 1);
-    qsort(*SymbolsBase, *SymbolsCount, sizeof(ROSSYM_ENTRY), (int (*)(const void *, const void *)) CompareSymEntry);
+    SortSymEntries(*SymbolsBase, *SymbolsCount);
 
     StringHashTableFree(&StringHash);
 
@@ -697,7 +769,7 @@ ConvertDbgHelp(void *process, DWORD module_base, char *SourcePath,
     free(strtab.LineEntryData);
     free(strtab.PathChop);
 
-    qsort(*SymbolsBase, *SymbolsCount, sizeof(ROSSYM_ENTRY), (int (*)(const void *, const void *))CompareSymEntry);
+    SortSymEntries(*SymbolsBase, *SymbolsCount);
 
     return 0;
 }
@@ -782,7 +854,7 @@ MergeStabsAndCoffs(ULONG *MergedSymbolCount, PROSSYM_ENTRY *MergedSymbols,
         }
     }
 
-    qsort(*MergedSymbols, *MergedSymbolCount, sizeof(ROSSYM_ENTRY), (int (*)(const void *, const void *)) CompareSymEntry);
+    SortSymEntries(*MergedSymbols, *MergedSymbolCount);
 
     return 0;
 }
@@ -891,8 +963,52 @@ GetSectionName(void *StringsBase, const BYTE *SectionTitle)
         return SectionTitle;
 }
 
+/*
+ * The output image is assembled in memory first, so that it can be
+ * compared against the existing output file and so that in-place runs
+ * never truncate the (mapped) input before it has been fully read.
+ */
+typedef struct _OUTPUT_BUFFER
+{
+    unsigned char *Data;
+    ULONG Length;
+    ULONG Allocated;
+} OUTPUT_BUFFER, *POUTPUT_BUFFER;
+
+static int
+WriteOutput(POUTPUT_BUFFER Output, ULONG Offset, const void *Data, ULONG Length)
+{
+    unsigned char *NewData;
+    ULONG NewAllocated;
+
+    if (Offset + Length > Output->Allocated)
+    {
+        NewAllocated = Output->Allocated ? Output->Allocated : 0x10000;
+        while (NewAllocated < Offset + Length)
+        {
+            NewAllocated *= 2;
+        }
+        NewData = realloc(Output->Data, NewAllocated);
+        if (NewData == NULL)
+        {
+            return 1;
+        }
+        memset(NewData + Output->Allocated, 0, NewAllocated - Output->Allocated);
+        Output->Data = NewData;
+        Output->Allocated = NewAllocated;
+    }
+
+    memcpy(Output->Data + Offset, Data, Length);
+    if (Output->Length < Offset + Length)
+    {
+        Output->Length = Offset + Length;
+    }
+
+    return 0;
+}
+
 static int
-CreateOutputFile(FILE *OutFile, void *InData,
+CreateOutputFile(POUTPUT_BUFFER OutFile, void *InData,
                  PIMAGE_DOS_HEADER InDosHeader, PIMAGE_FILE_HEADER InFileHeader,
                  PIMAGE_OPTIONAL_HEADER InOptHeader, PIMAGE_SECTION_HEADER InSectionHeaders,
                  ULONG RosSymLength, void *RosSymSection)
@@ -1155,9 +1271,9 @@ CreateOutputFile(FILE *OutFile, void *InData,
     CheckSum += Length;
     OutOptHeader->CheckSum = CheckSum;
 
-    if (fwrite(OutHeader, 1, StartOfRawData, OutFile) != StartOfRawData)
+    if (WriteOutput(OutFile, 0, OutHeader, StartOfRawData))
     {
-        perror("Error writing output header\n");
+        fprintf(stderr, "Error writing output header\n");
         free(OutHeader);
         return 1;
     }
@@ -1167,7 +1283,6 @@ CreateOutputFile(FILE *OutFile, void *InData,
         if (OutSectionHeaders[Section].SizeOfRawData != 0)
         {
             DWORD SizeOfRawData;
-            fseek(OutFile, OutSectionHeaders[Section].PointerToRawData, SEEK_SET);
             if (OutRelocSection == OutSectionHeaders + Section)
             {
                 Data = (void *) ProcessedRelocs;
@@ -1183,9 +1298,9 @@ CreateOutputFile(FILE *OutFile, void *InData,
                 Data = (void *) ((char *) InData + OutSectionHeaders[Section].PointerToRawData);
                 SizeOfRawData = OutSectionHeaders[Section].SizeOfRawData;
             }
-            if (fwrite(Data, 1, SizeOfRawData, OutFile) != SizeOfRawData)
+            if (WriteOutput(OutFile, OutSectionHeaders[Section].PointerToRawData, Data, SizeOfRawData))
             {
-                perror("Error writing section data\n");
+                fprintf(stderr, "Error writing section data\n");
                 free(PaddedRosSym);
                 free(OutHeader);
                 return 1;
@@ -1195,8 +1310,15 @@ CreateOutputFile(FILE *OutFile, void *InData,
 
     if (PaddedStringTable)
     {
-        fseek(OutFile, OutFileHeader->PointerToSymbolTable, SEEK_SET);
-        fwrite(PaddedStringTable, 1, PaddedStringTableLength, OutFile);
+        if (WriteOutput(OutFile, OutFileHeader->PointerToSymbolTable,
+                        PaddedStringTable, PaddedStringTableLength))
+        {
+            fprintf(stderr, "Error writing string table\n");
+            free(PaddedStringTable);
+            free(PaddedRosSym);
+            free(OutHeader);
+            return 1;
+        }
         free(PaddedStringTable);
     }
 
@@ -1209,7 +1331,28 @@ CreateOutputFile(FILE *OutFile, void *InData,
     return 0;
 }
 
-int main(int argc, char* argv[])
+static int
+OutputUnchanged(const char *FileName, POUTPUT_BUFFER Output)
+{
+    void *OldData;
+    size_t OldSize;
+    int Unchanged;
+
+    OldData = map_file(FileName, &OldSize);
+    if (OldData == NULL)
+    {
+        return 0;
+    }
+
+    Unchanged = OldSize == Output->Length &&
+                memcmp(OldData, Output->Data, Output->Length) == 0;
+    unmap_file(OldData, OldSize);
+
+    return Unchanged;
+}
+
+static int
+ProcessFile(char *path1, char *path2, char *SourcePath)
 {
     PSYMBOLFILE_HEADER SymbolFileHeader;
     PIMAGE_DOS_HEADER PEDosHeader;
@@ -1225,9 +1368,8 @@ int main(int argc, char* argv[])
     ULONG CoffsLength;
     void *CoffStringBase = NULL;
     ULONG CoffStringsLength;
-    char* path1;
-    char* path2;
     FILE* out;
+    OUTPUT_BUFFER Output;
     void *StringBase = NULL;
     ULONG StringsLength = 0;
     ULONG StabSymbolsCount = 0;
@@ -1244,68 +1386,29 @@ int main(int argc, char* argv[])
     void *file;
     char elfhdr[4] = { '\177', 'E', 'L', 'F' };
     BOOLEAN UseDbgHelp = FALSE;
-    int arg, argstate = 0;
-    char *SourcePath = NULL;
 
-    for (arg = 1; arg < argc; arg++)
-    {
-        switch (argstate)
-        {
-            default:
-                argstate = -1;
-                break;
-
-            case 0:
-                if (!strcmp(argv[arg], "-s"))
-                {
-                    argstate = 1;
-                }
-                else
-                {
-                    argstate = 2;
-                    path1 = convert_path(argv[arg]);
-                }
-            break;
-
-            case 1:
-                free(SourcePath);
-                SourcePath = strdup(argv[arg]);
-                argstate = 0;
-                break;
-
-            case 2:
-                path2 = convert_path(argv[arg]);
-                argstate = 3;
-                break;
-        }
-    }
-
-    if (argstate != 3)
-    {
-        fprintf(stderr, "Usage: rsym [-s <sources>] <input> <output>\n");
-        exit(1);
-    }
-
-    FileData = load_file(path1, &FileSize);
+    FileData = map_file(path1, &FileSize);
     if (!FileData)
     {
         fprintf(stderr, "An error occured loading '%s'\n", path1);
-        exit(1);
+        return 1;
     }
 
-    file = fopen(path1, "rb");
-
     /* Check if MZ header exists  */
     PEDosHeader = (PIMAGE_DOS_HEADER) FileData;
-    if (PEDosHeader->e_magic != IMAGE_DOS_MAGIC ||
+    if (FileSize < sizeof(IMAGE_DOS_HEADER) ||
+        PEDosHeader->e_magic != IMAGE_DOS_MAGIC ||
         PEDosHeader->e_lfanew == 0L)
     {
         /* Ignore elf */
-        if (!memcmp(PEDosHeader, elfhdr, sizeof(elfhdr)))
-            exit(0);
-        perror("Input file is not a PE image.\n");
-        free(FileData);
-        exit(1);
+        if (FileSize >= sizeof(elfhdr) && !memcmp(PEDosHeader, elfhdr, sizeof(elfhdr)))
+        {
+            unmap_file(FileData, FileSize);
+            return 0;
+        }
+        fprintf(stderr, "Input file '%s' is not a PE image.\n", path1);
+        unmap_file(FileData, FileSize);
+        return 1;
     }
 
     /* Locate PE file header  */
@@ -1328,8 +1431,8 @@ int main(int argc, char* argv[])
                     &StabStringsLength,
                     &StabStringBase))
     {
-        free(FileData);
-        exit(1);
+        unmap_file(FileData, FileSize);
+        return 1;
     }
 
     if (StabsLength == 0)
@@ -1341,6 +1444,9 @@ int main(int argc, char* argv[])
         SymSetOptions(0x10000 | 0x800000 | 0x40 | 0x10);
         SymInitialize(FileData, ".", 0);
 
+        /* The file handle is owned (and closed) by dbghelp */
+        file = fopen(path1, "rb");
+
         module_base = SymLoadModule(FileData, file, path1, path1, 0, FileSize) & 0xffffffff;
 
         if (ConvertDbgHelp(FileData,
@@ -1351,8 +1457,8 @@ int main(int argc, char* argv[])
                            &StringsLength,
                            &StringBase))
         {
-            free(FileData);
-            exit(1);
+            unmap_file(FileData, FileSize);
+            return 1;
         }
 
         UseDbgHelp = TRUE;
@@ -1368,8 +1474,8 @@ int main(int argc, char* argv[])
                     &CoffStringsLength,
                     &CoffStringBase))
     {
-        free(FileData);
-        exit(1);
+        unmap_file(FileData, FileSize);
+        return 1;
     }
 
     if (!UseDbgHelp)
@@ -1378,9 +1484,9 @@ int main(int argc, char* argv[])
                             (CoffsLength / sizeof(ROSSYM_ENTRY)) * (E_SYMNMLEN + 1));
         if (StringBase == NULL)
         {
-            free(FileData);
+            unmap_file(FileData, FileSize);
             fprintf(stderr, "Failed to allocate memory for strings table\n");
-            exit(1);
+            return 1;
         }
         /* Make offset 0 into an empty string */
         *((char *) StringBase) = '\0';
@@ -1399,9 +1505,9 @@ int main(int argc, char* argv[])
                          PESectionHeaders))
         {
             free(StringBase);
-            free(FileData);
+            unmap_file(FileData, FileSize);
             fprintf(stderr, "Failed to allocate memory for strings table\n");
-            exit(1);
+            return 1;
         }
     }
     else
@@ -1409,9 +1515,9 @@ int main(int argc, char* argv[])
         StringBase = realloc(StringBase, StringsLength + CoffStringsLength);
         if (!StringBase)
         {
-            free(FileData);
+            unmap_file(FileData, FileSize);
             fprintf(stderr, "Failed to allocate memory for strings table\n");
-            exit(1);
+            return 1;
         }
     }
 
@@ -1432,8 +1538,8 @@ int main(int argc, char* argv[])
             free(StabSymbols);
         }
         free(StringBase);
-        free(FileData);
-        exit(1);
+        unmap_file(FileData, FileSize);
+        return 1;
     }
 
     if (MergeStabsAndCoffs(&MergedSymbolsCount,
@@ -1452,8 +1558,8 @@ int main(int argc, char* argv[])
             free(StabSymbols);
         }
         free(StringBase);
-        free(FileData);
-        exit(1);
+        unmap_file(FileData, FileSize);
+        return 1;
     }
 
     if (CoffSymbols)
@@ -1480,9 +1586,9 @@ int main(int argc, char* argv[])
         {
             free(MergedSymbols);
             free(StringBase);
-            free(FileData);
+            unmap_file(FileData, FileSize);
             fprintf(stderr, "Unable to allocate memory for .rossym section\n");
-            exit(1);
+            return 1;
         }
         memset(RosSymSection, '\0', RosSymLength);
 
@@ -1505,16 +1611,9 @@ int main(int argc, char* argv[])
     }
 
     free(StringBase);
-    out = fopen(path2, "wb");
-    if (out == NULL)
-    {
-        perror("Cannot open output file");
-        free(RosSymSection);
-        free(FileData);
-        exit(1);
-    }
 
-    if (CreateOutputFile(out,
+    memset(&Output, 0, sizeof(Output));
+    if (CreateOutputFile(&Output,
                          FileData,
                          PEDosHeader,
                          PEFileHeader,
@@ -1523,23 +1622,311 @@ int main(int argc, char* argv[])
                          RosSymLength,
                          RosSymSection))
     {
-        fclose(out);
+        free(Output.Data);
         if (RosSymSection)
         {
             free(RosSymSection);
         }
-        free(FileData);
-        exit(1);
+        unmap_file(FileData, FileSize);
+        return 1;
     }
 
-    fclose(out);
     if (RosSymSection)
     {
         free(RosSymSection);
     }
-    free(FileData);
+    unmap_file(FileData, FileSize);
 
+    /* Leave the output (and its timestamp) alone if nothing changed */
+    if (OutputUnchanged(path2, &Output))
+    {
+        free(Output.Data);
+        return 0;
+    }
+
+    out = fopen(path2, "wb");
+    if (out == NULL)
+    {
+        perror("Cannot open output file");
+        free(Output.Data);
+        return 1;
+    }
+
+    if (fwrite(Output.Data, 1, Output.Length, out) != Output.Length)
+    {
+        perror("Error writing output file");
+        fclose(out);
+        free(Output.Data);
+        return 1;
+    }
+
+    fclose(out);
+    free(Output.Data);
+
+    return 0;
+}
+
+/*
+ * Run ProcessFile on every module of the list, with up to Jobs modules
+ * converted at the same time. Each module gets its own worker process:
+ * the dbghelp host library keeps global state and is not safe to use
+ * from several threads.
+ */
+static int
+ProcessFileList(ULONG Count, char **InFiles, char **OutFiles, char *SourcePath, int Jobs)
+{
+    ULONG Next;
+    int Failed = 0;
+#ifndef _WIN32
+    pid_t *Workers = NULL;
+    ULONG *WorkerFile = NULL;
+    pid_t Pid;
+    int Running = 0;
+    int Status, Slot;
+
+    if (Jobs > 1 && Count > 1)
+    {
+        Workers = calloc(Jobs, sizeof(pid_t));
+        WorkerFile = calloc(Jobs, sizeof(ULONG));
+        if (Workers == NULL || WorkerFile == NULL)
+        {
+            free(Workers);
+            free(WorkerFile);
+            Jobs = 1;
+        }
+    }
+    if (Jobs > 1 && Count > 1)
+    {
+        Next = 0;
+        while (Next < Count || Running > 0)
+        {
+            if (Next < Count && Running < Jobs)
+            {
+                for (Slot = 0; Workers[Slot] != 0; Slot++)
+                    ;
+
+                fflush(stdout);
+                fflush(stderr);
+                Pid = fork();
+                if (Pid == 0)
+                {
+                    _exit(ProcessFile(InFiles[Next], OutFiles[Next], SourcePath));
+                }
+                if (Pid < 0)
+                {
+                    /* Out of processes, do this one ourselves */
+                    if (ProcessFile(InFiles[Next], OutFiles[Next], SourcePath))
+                    {
+                        fprintf(stderr, "Failed to process '%s'\n", InFiles[Next]);
+                        Failed = 1;
+                    }
+                }
+                else
+                {
+                    Workers[Slot] = Pid;
+                    WorkerFile[Slot] = Next;
+                    Running++;
+                }
+                Next++;
+                continue;
+            }
+
+            Pid = wait(&Status);
+            if (Pid < 0)
+            {
+                perror("wait");
+                Failed = 1;
+                break;
+            }
+            for (Slot = 0; Slot < Jobs && Workers[Slot] != Pid; Slot++)
+                ;
+            if (Slot == Jobs)
+            {
+                continue;
+            }
+            if (!WIFEXITED(Status) || WEXITSTATUS(Status) != 0)
+            {
+                fprintf(stderr, "Failed to process '%s'\n", InFiles[WorkerFile[Slot]]);
+                Failed = 1;
+            }
+            Workers[Slot] = 0;
+            Running--;
+        }
+
+        free(Workers);
+        free(WorkerFile);
+        return Failed;
+    }
+#endif
+
+    for (Next = 0; Next < Count; Next++)
+    {
+        if (ProcessFile(InFiles[Next], OutFiles[Next], SourcePath))
+        {
+            fprintf(stderr, "Failed to process '%s'\n", InFiles[Next]);
+            Failed = 1;
+        }
+    }
+
+    return Failed;
+}
+
+/*
+ * Read a module list: one module per line, either "<input>" to convert
+ * the file in place or "<input>\t<output>". Empty lines are ignored.
+ */
+static int
+ReadFileList(const char *ListName, ULONG *Count, char ***InFiles, char ***OutFiles)
+{
+    FILE *List;
+    char Line[2 * MAX_PATH + 2];
+    char *Tab, *End;
+    char **NewIn, **NewOut;
+    ULONG Allocated = 0;
+
+    List = fopen(ListName, "r");
+    if (List == NULL)
+    {
+        perror("Cannot open module list");
+        return 1;
+    }
+
+    while (fgets(Line, sizeof(Line), List))
+    {
+        End = Line + strlen(Line);
+        while (End > Line && (End[-1] == '\n' || End[-1] == '\r'))
+        {
+            *--End = '\0';
+        }
+        if (Line[0] == '\0')
+        {
+            continue;
+        }
+
+        if (*Count == Allocated)
+        {
+            Allocated = Allocated ? Allocated * 2 : 64;
+            NewIn = realloc(*InFiles, Allocated * sizeof(char *));
+            if (NewIn != NULL)
+            {
+                *InFiles = NewIn;
+            }
+            NewOut = realloc(*OutFiles, Allocated * sizeof(char *));
+            if (NewOut != NULL)
+            {
+                *OutFiles = NewOut;
+            }
+            if (NewIn == NULL || NewOut == NULL)
+            {
+                fprintf(stderr, "Failed to allocate memory for module list\n");
+                fclose(List);
+                return 1;
+            }
+        }
+
+        Tab = strchr(Line, '\t');
+        if (Tab)
+        {
+            *Tab = '\0';
+            (*OutFiles)[*Count] = convert_path(Tab + 1);
+        }
+        else
+        {
+            (*OutFiles)[*Count] = convert_path(Line);
+        }
+        (*InFiles)[*Count] = convert_path(Line);
+        (*Count)++;
+    }
+
+    fclose(List);
     return 0;
 }
 
+static int
+GetProcessorCount(void)
+{
+#if !defined(_WIN32) && defined(_SC_NPROCESSORS_ONLN)
+    long Count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (Count > 0)
+    {
+        return (int)Count;
+    }
+#endif
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    char *SourcePath = NULL;
+    char *ListName = NULL;
+    char **InFiles = NULL;
+    char **OutFiles = NULL;
+    ULONG Count = 0;
+    int Jobs = 1;
+    int arg;
+
+    for (arg = 1; arg < argc; arg++)
+    {
+        if (!strcmp(argv[arg], "-s") && arg + 1 < argc)
+        {
+            free(SourcePath);
+            SourcePath = strdup(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "-j") && arg + 1 < argc)
+        {
+            Jobs = atoi(argv[++arg]);
+            if (Jobs <= 0)
+            {
+                Jobs = GetProcessorCount();
+            }
+        }
+        else if (!strcmp(argv[arg], "-l") && arg + 1 < argc)
+        {
+            ListName = argv[++arg];
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (ListName != NULL && arg == argc)
+    {
+        if (ReadFileList(ListName, &Count, &InFiles, &OutFiles))
+        {
+            exit(1);
+        }
+    }
+    else if (ListName == NULL && arg + 2 == argc)
+    {
+        InFiles = malloc(sizeof(char *));
+        OutFiles = malloc(sizeof(char *));
+        if (InFiles == NULL || OutFiles == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+        InFiles[0] = convert_path(argv[arg]);
+        OutFiles[0] = convert_path(argv[arg + 1]);
+        Count = 1;
+    }
+    else
+    {
+        fprintf(stderr, "Usage: rsym [-s <sources>] <input> <output>\n"
+                        "       rsym [-s <sources>] [-j <jobs>] -l <list>\n"
+                        "\n"
+                        "  -j <jobs>  convert up to <jobs> modules at once (0 = one per CPU)\n"
+                        "  -l <list>  read the modules from <list>, one \"<input>[<TAB><output>]\" per line\n");
+        exit(1);
+    }
+
+    if (Count == 1)
+    {
+        return ProcessFile(InFiles[0], OutFiles[0], SourcePath);
+    }
+
+    return ProcessFileList(Count, InFiles, OutFiles, SourcePath, Jobs);
+}
+
 /* EOF */
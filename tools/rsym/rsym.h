@@ -177,3 +177,9 @@ convert_path(const char* origpath);
 
 extern void*
 load_file ( const char* file_name, size_t* file_size );
+
+extern void*
+map_file ( const char* file_name, size_t* file_size );
+
+extern void
+unmap_file ( void* file_data, size_t file_size );
@@ -4,6 +4,13 @@
 #include <string.h>
 #include <stdlib.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "rsym.h"
 
 char*
@@ -60,3 +67,46 @@ load_file ( const char* file_name, size_t* file_size )
 	}
 	return FileData;
 }
+
+/*
+ * Map a file copy-on-write, so callers may patch the data in memory
+ * without touching the file. Falls back to load_file where mmap is
+ * not available.
+ */
+void*
+map_file ( const char* file_name, size_t* file_size )
+{
+#ifdef _WIN32
+	return load_file(file_name, file_size);
+#else
+	struct stat st;
+	void* FileData;
+	int fd;
+
+	fd = open(file_name, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return NULL;
+	}
+	*file_size = st.st_size;
+	FileData = mmap(NULL, *file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (FileData == MAP_FAILED)
+		return NULL;
+	return FileData;
+#endif
+}
+
+void
+unmap_file ( void* file_data, size_t file_size )
+{
+#ifdef _WIN32
+	free(file_data);
+#else
+	if (file_data != NULL)
+		munmap(file_data, file_size);
+#endif
+}
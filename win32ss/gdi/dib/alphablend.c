@@ -11,22 +11,57 @@
 #define NDEBUG
 #include <debug.h>
 
-typedef union
+/*
+ * Blends a row of unscaled 32bpp source pixels, already in the destination
+ * format, onto a 32bpp destination row.
+ */
+VOID
+DIB_32BPP_AlphaBlendRow(PULONG Dst, PULONG Src, ULONG Count,
+                        BLENDFUNCTION BlendFunc)
 {
-  ULONG ul;
-  struct
+  ULONG SrcPixel, Alpha, ConstAlpha = BlendFunc.SourceConstantAlpha;
+
+  if ((BlendFunc.AlphaFormat & AC_SRC_ALPHA) == 0)
   {
-    UCHAR red;
-    UCHAR green;
-    UCHAR blue;
-    UCHAR alpha;
-  } col;
-} NICEPIXEL32;
-
-static __inline UCHAR
-Clamp8(ULONG val)
-{
-  return (val > 255) ? 255 : (UCHAR)val;
+    /* Constant alpha only, the destination weight never changes */
+    Alpha = 255 - ConstAlpha;
+    while (Count--)
+    {
+      SrcPixel = DIB_Scale255(*Src++, ConstAlpha);
+      *Dst = DIB_AddSaturate8(DIB_Scale255(*Dst, Alpha), SrcPixel);
+      Dst++;
+    }
+  }
+  else if (ConstAlpha == 255)
+  {
+    /* Plain premultiplied source, what icons and layered windows use */
+    while (Count--)
+    {
+      SrcPixel = *Src++;
+      Alpha = SrcPixel >> 24;
+      if (Alpha == 255)
+      {
+        /* Opaque, the source wins */
+        *Dst = SrcPixel;
+      }
+      else if (SrcPixel != 0)
+      {
+        *Dst = DIB_AddSaturate8(DIB_Scale255(*Dst, 255 - Alpha), SrcPixel);
+      }
+      Dst++;
+    }
+  }
+  else
+  {
+    /* Premultiplied source faded by the constant alpha */
+    while (Count--)
+    {
+      SrcPixel = DIB_Scale255(*Src++, ConstAlpha);
+      Alpha = SrcPixel >> 24;
+      *Dst = DIB_AddSaturate8(DIB_Scale255(*Dst, 255 - Alpha), SrcPixel);
+      Dst++;
+    }
+  }
 }
 
 BOOLEAN
@@ -34,13 +69,13 @@ DIB_XXBPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
                      RECTL* SourceRect, CLIPOBJ* ClipRegion,
                      XLATEOBJ* ColorTranslation, BLENDOBJ* BlendObj)
 {
-  INT DstX, DstY, SrcX, SrcY;
+  INT DstX, DstY;
   BLENDFUNCTION BlendFunc;
-  register NICEPIXEL32 DstPixel32;
-  register NICEPIXEL32 SrcPixel32;
-  UCHAR Alpha, SrcBpp = BitsPerFormat(Source->iBitmapFormat);
+  ULONG DstPixel32, SrcPixel32, Alpha;
+  UCHAR SrcBpp = BitsPerFormat(Source->iBitmapFormat);
   EXLATEOBJ* pexlo;
   EXLATEOBJ exloSrcRGB, exloDstRGB, exloRGBSrc;
+  DIB_STEP StepX, StepY;
   PFN_DIB_PutPixel pfnDibPutPixel = DibFunctionsForBitmapFormat[Dest->iBitmapFormat].DIB_PutPixel;
 
   DPRINT("DIB_16BPP_AlphaBlend: srcRect: (%d,%d)-(%d,%d), dstRect: (%d,%d)-(%d,%d)\n",
@@ -76,42 +111,39 @@ DIB_XXBPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
     return FALSE;
   }
 
+  if (DestRect->right <= DestRect->left || DestRect->bottom <= DestRect->top)
+    return TRUE;
+
   pexlo = CONTAINING_RECORD(ColorTranslation, EXLATEOBJ, xlo);
   EXLATEOBJ_vInitialize(&exloSrcRGB, pexlo->ppalSrc, &gpalRGB, 0, 0, 0);
   EXLATEOBJ_vInitialize(&exloDstRGB, pexlo->ppalDst, &gpalRGB, 0, 0, 0);
   EXLATEOBJ_vInitialize(&exloRGBSrc, &gpalRGB, pexlo->ppalSrc, 0, 0, 0);
 
-  SrcY = SourceRect->top;
-  DstY = DestRect->top;
-  while ( DstY < DestRect->bottom )
+  DIB_StepInit(&StepY, SourceRect->top, SourceRect->bottom - SourceRect->top,
+               DestRect->bottom - DestRect->top);
+  for (DstY = DestRect->top; DstY < DestRect->bottom; DstY++)
   {
-    SrcX = SourceRect->left;
-    DstX = DestRect->left;
-    while(DstX < DestRect->right)
+    DIB_StepInit(&StepX, SourceRect->left, SourceRect->right - SourceRect->left,
+                 DestRect->right - DestRect->left);
+    for (DstX = DestRect->left; DstX < DestRect->right; DstX++)
     {
-      SrcPixel32.ul = DIB_GetSource(Source, SrcX, SrcY, &exloSrcRGB.xlo);
-      SrcPixel32.col.red = (SrcPixel32.col.red * BlendFunc.SourceConstantAlpha) / 255;
-      SrcPixel32.col.green = (SrcPixel32.col.green * BlendFunc.SourceConstantAlpha) / 255;
-      SrcPixel32.col.blue = (SrcPixel32.col.blue * BlendFunc.SourceConstantAlpha) / 255;
+      SrcPixel32 = DIB_GetSource(Source, StepX.Pos, StepY.Pos, &exloSrcRGB.xlo);
+      SrcPixel32 = DIB_Scale255(SrcPixel32, BlendFunc.SourceConstantAlpha);
 
       Alpha = ((BlendFunc.AlphaFormat & AC_SRC_ALPHA) != 0) ?
-           (SrcPixel32.col.alpha * BlendFunc.SourceConstantAlpha) / 255 :
-           BlendFunc.SourceConstantAlpha ;
-
-      DstPixel32.ul = DIB_GetSource(Dest, DstX, DstY, &exloDstRGB.xlo);
-      DstPixel32.col.red = Clamp8((DstPixel32.col.red * (255 - Alpha)) / 255 + SrcPixel32.col.red) ;
-      DstPixel32.col.green = Clamp8((DstPixel32.col.green * (255 - Alpha)) / 255 + SrcPixel32.col.green) ;
-      DstPixel32.col.blue = Clamp8((DstPixel32.col.blue * (255 - Alpha)) / 255 + SrcPixel32.col.blue) ;
-      DstPixel32.ul = XLATEOBJ_iXlate(&exloRGBSrc.xlo, DstPixel32.ul);
-      pfnDibPutPixel(Dest, DstX, DstY, XLATEOBJ_iXlate(ColorTranslation, DstPixel32.ul));
-
-      DstX++;
-      SrcX = SourceRect->left + ((DstX-DestRect->left)*(SourceRect->right - SourceRect->left))
-                                            /(DestRect->right-DestRect->left);
+           (SrcPixel32 >> 24) : BlendFunc.SourceConstantAlpha;
+
+      /* Only the color channels get blended */
+      DstPixel32 = DIB_GetSource(Dest, DstX, DstY, &exloDstRGB.xlo);
+      DstPixel32 = (DstPixel32 & 0xFF000000) |
+                   (DIB_AddSaturate8(DIB_Scale255(DstPixel32, 255 - Alpha),
+                                     SrcPixel32) & 0x00FFFFFF);
+      DstPixel32 = XLATEOBJ_iXlate(&exloRGBSrc.xlo, DstPixel32);
+      pfnDibPutPixel(Dest, DstX, DstY, XLATEOBJ_iXlate(ColorTranslation, DstPixel32));
+
+      DIB_StepNext(&StepX);
     }
-    DstY++;
-    SrcY = SourceRect->top + ((DstY-DestRect->top)*(SourceRect->bottom - SourceRect->top))
-                                            /(DestRect->bottom-DestRect->top);
+    DIB_StepNext(&StepY);
   }
 
   EXLATEOBJ_vCleanup(&exloDstRGB);
@@ -120,4 +152,3 @@ DIB_XXBPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
 
   return TRUE;
 }
-
@@ -126,6 +126,7 @@ BOOLEAN DIB_32BPP_AlphaBlend(SURFOBJ*, SURFOBJ*, RECTL*, RECTL*, CLIPOBJ*, XLATE
 BOOLEAN DIB_XXBPP_StretchBlt(SURFOBJ*,SURFOBJ*,SURFOBJ*,SURFOBJ*,RECTL*,RECTL*,POINTL*,BRUSHOBJ*,POINTL*,XLATEOBJ*,ROP4);
 BOOLEAN DIB_XXBPP_FloodFillSolid(SURFOBJ*, BRUSHOBJ*, RECTL*, POINTL*, ULONG, UINT);
 BOOLEAN DIB_XXBPP_AlphaBlend(SURFOBJ*, SURFOBJ*, RECTL*, RECTL*, CLIPOBJ*, XLATEOBJ*, BLENDOBJ*);
+VOID DIB_32BPP_AlphaBlendRow(PULONG, PULONG, ULONG, BLENDFUNCTION);
 
 extern unsigned char notmask[2];
 extern unsigned char altnotmask[2];
@@ -141,3 +142,69 @@ ULONG DIB_DoRop(ULONG Rop, ULONG Dest, ULONG Source, ULONG Pattern);
 #define DIB_GetSourceIndex(SourceSurf,sx,sy)                \
   DibFunctionsForBitmapFormat[SourceSurf->iBitmapFormat].   \
     DIB_GetPixel(SourceSurf, sx, sy)
+
+/*
+ * Steps a source coordinate along a stretched blit without dividing for
+ * every pixel. Pos always equals Start + (i * SrcSize) / DstSize.
+ */
+typedef struct
+{
+  LONG Pos;
+  LONG Quot;
+  LONG Rem;
+  LONG Err;
+  LONG Den;
+} DIB_STEP;
+
+static __inline VOID
+DIB_StepInit(DIB_STEP *Step, LONG Start, LONG SrcSize, LONG DstSize)
+{
+  Step->Pos = Start;
+  Step->Quot = SrcSize / DstSize;
+  Step->Rem = SrcSize % DstSize;
+  Step->Err = 0;
+  Step->Den = DstSize;
+}
+
+static __inline VOID
+DIB_StepNext(DIB_STEP *Step)
+{
+  Step->Pos += Step->Quot;
+  Step->Err += Step->Rem;
+  if (Step->Err >= Step->Den)
+  {
+    Step->Err -= Step->Den;
+    Step->Pos++;
+  }
+}
+
+/*
+ * Helpers working on all four 8 bit channels of a 32 bit pixel at once,
+ * two channels per 16 bit lane. They give the same results as doing
+ * (Channel * Scale) / 255 and Clamp8(A + B) on every channel separately.
+ */
+#define DIB_LANE_MASK 0x00FF00FF
+
+static __inline ULONG
+DIB_Scale255(ULONG Pixel, ULONG Scale)
+{
+  ULONG rb = (Pixel & DIB_LANE_MASK) * Scale;
+  ULONG ag = ((Pixel >> 8) & DIB_LANE_MASK) * Scale;
+
+  /* x / 255 == (x + 1 + (x >> 8)) >> 8 for every x up to 255 * 255 */
+  rb = ((rb + 0x00010001 + ((rb >> 8) & DIB_LANE_MASK)) >> 8) & DIB_LANE_MASK;
+  ag = ((ag + 0x00010001 + ((ag >> 8) & DIB_LANE_MASK)) >> 8) & DIB_LANE_MASK;
+  return rb | (ag << 8);
+}
+
+static __inline ULONG
+DIB_AddSaturate8(ULONG a, ULONG b)
+{
+  ULONG rb = (a & DIB_LANE_MASK) + (b & DIB_LANE_MASK);
+  ULONG ag = ((a >> 8) & DIB_LANE_MASK) + ((b >> 8) & DIB_LANE_MASK);
+
+  /* Turn the carry out of each channel into 0xFF */
+  rb |= ((rb >> 8) & 0x00010001) * 0xFF;
+  ag |= ((ag >> 8) & 0x00010001) * 0xFF;
+  return (rb & DIB_LANE_MASK) | ((ag & DIB_LANE_MASK) << 8);
+}
@@ -9,6 +9,7 @@
  */
 
 #include <win32k.h>
+#include "dibconv.h"
 
 #define NDEBUG
 #include <debug.h>
@@ -142,6 +143,8 @@ DIB_16BPP_BitBltSrcCopy(PBLTINFO BltInfo)
   LONG     i, j, sx, sy, xColor, f1;
   PBYTE    SourceBits, DestBits, SourceLine, DestLine;
   PBYTE    SourceBits_4BPP, SourceLine_4BPP;
+  PFN_XLATE pfnXlate;
+  ULONG    cPixels = BltInfo->DestRect.right - BltInfo->DestRect.left;
   DestBits = (PBYTE)BltInfo->DestSurface->pvScan0 + (BltInfo->DestRect.top * BltInfo->DestSurface->lDelta) + 2 * BltInfo->DestRect.left;
 
   switch(BltInfo->SourceSurface->iBitmapFormat)
@@ -368,6 +371,30 @@ DIB_16BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 
     DestLine = DestBits;
 
+    /* Convert BGR to 555 / 565 whole lines at a time */
+    pfnXlate = BltInfo->XlateSourceToDest ?
+      XLATEOBJ_pfnXlate(BltInfo->XlateSourceToDest) : NULL;
+    if (pfnXlate == EXLATEOBJ_iXlateBGRto555)
+    {
+      for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
+      {
+        DIB_vConvertLine32to555((PUSHORT)DestLine, (PULONG)SourceLine, cPixels);
+        SourceLine += BltInfo->SourceSurface->lDelta;
+        DestLine += BltInfo->DestSurface->lDelta;
+      }
+      break;
+    }
+    if (pfnXlate == EXLATEOBJ_iXlateBGRto565)
+    {
+      for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
+      {
+        DIB_vConvertLine32to565((PUSHORT)DestLine, (PULONG)SourceLine, cPixels);
+        SourceLine += BltInfo->SourceSurface->lDelta;
+        DestLine += BltInfo->DestSurface->lDelta;
+      }
+      break;
+    }
+
     for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
     {
       SourceBits = SourceLine;
@@ -577,12 +604,13 @@ DIB_16BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
                      RECTL* SourceRect, CLIPOBJ* ClipRegion,
                      XLATEOBJ* ColorTranslation, BLENDOBJ* BlendObj)
 {
-  INT DstX, DstY, SrcX, SrcY;
+  INT DstX, DstY;
   BLENDFUNCTION BlendFunc;
   NICEPIXEL32 SrcPixel32;
   UCHAR Alpha;
   EXLATEOBJ* pexlo;
   EXLATEOBJ exloSrcRGB;
+  DIB_STEP StepX, StepY;
 
   DPRINT("DIB_16BPP_AlphaBlend: srcRect: (%d,%d)-(%d,%d), dstRect: (%d,%d)-(%d,%d)\n",
     SourceRect->left, SourceRect->top, SourceRect->right, SourceRect->bottom,
@@ -617,6 +645,9 @@ DIB_16BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
     return FALSE;
   }
 
+  if (DestRect->right <= DestRect->left || DestRect->bottom <= DestRect->top)
+    return TRUE;
+
   pexlo = CONTAINING_RECORD(ColorTranslation, EXLATEOBJ, xlo);
   EXLATEOBJ_vInitialize(&exloSrcRGB, pexlo->ppalSrc, &gpalRGB, 0, 0, 0);
 
@@ -624,22 +655,19 @@ DIB_16BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
   {
       NICEPIXEL16_555 DstPixel16;
 
-      SrcY = SourceRect->top;
-      DstY = DestRect->top;
-      while ( DstY < DestRect->bottom )
+      DIB_StepInit(&StepY, SourceRect->top, SourceRect->bottom - SourceRect->top,
+                   DestRect->bottom - DestRect->top);
+      for (DstY = DestRect->top; DstY < DestRect->bottom; DstY++)
       {
-        SrcX = SourceRect->left;
-        DstX = DestRect->left;
-        while(DstX < DestRect->right)
+        DIB_StepInit(&StepX, SourceRect->left, SourceRect->right - SourceRect->left,
+                     DestRect->right - DestRect->left);
+        for (DstX = DestRect->left; DstX < DestRect->right; DstX++)
         {
-          SrcPixel32.ul = DIB_GetSource(Source, SrcX, SrcY, &exloSrcRGB.xlo);
-          SrcPixel32.col.red = (SrcPixel32.col.red * BlendFunc.SourceConstantAlpha) / 255;
-          SrcPixel32.col.green = (SrcPixel32.col.green * BlendFunc.SourceConstantAlpha) / 255;
-          SrcPixel32.col.blue = (SrcPixel32.col.blue * BlendFunc.SourceConstantAlpha) / 255;
+          SrcPixel32.ul = DIB_GetSource(Source, StepX.Pos, StepY.Pos, &exloSrcRGB.xlo);
+          SrcPixel32.ul = DIB_Scale255(SrcPixel32.ul, BlendFunc.SourceConstantAlpha);
 
           Alpha = ((BlendFunc.AlphaFormat & AC_SRC_ALPHA) != 0) ?
-               (SrcPixel32.col.alpha * BlendFunc.SourceConstantAlpha) / 255 :
-               BlendFunc.SourceConstantAlpha;
+               SrcPixel32.col.alpha : BlendFunc.SourceConstantAlpha;
 
           Alpha >>= 3;
 
@@ -656,13 +684,9 @@ DIB_16BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
 
           DIB_16BPP_PutPixel(Dest, DstX, DstY, DstPixel16.us);
 
-          DstX++;
-          SrcX = SourceRect->left + ((DstX-DestRect->left)*(SourceRect->right - SourceRect->left))
-                                                /(DestRect->right-DestRect->left);
+          DIB_StepNext(&StepX);
         }
-        DstY++;
-        SrcY = SourceRect->top + ((DstY-DestRect->top)*(SourceRect->bottom - SourceRect->top))
-                                                /(DestRect->bottom-DestRect->top);
+        DIB_StepNext(&StepY);
       }
   }
   else
@@ -670,22 +694,19 @@ DIB_16BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
       NICEPIXEL16_565 DstPixel16;
       UCHAR Alpha6, Alpha5;
 
-      SrcY = SourceRect->top;
-      DstY = DestRect->top;
-      while ( DstY < DestRect->bottom )
+      DIB_StepInit(&StepY, SourceRect->top, SourceRect->bottom - SourceRect->top,
+                   DestRect->bottom - DestRect->top);
+      for (DstY = DestRect->top; DstY < DestRect->bottom; DstY++)
       {
-        SrcX = SourceRect->left;
-        DstX = DestRect->left;
-        while(DstX < DestRect->right)
+        DIB_StepInit(&StepX, SourceRect->left, SourceRect->right - SourceRect->left,
+                     DestRect->right - DestRect->left);
+        for (DstX = DestRect->left; DstX < DestRect->right; DstX++)
         {
-          SrcPixel32.ul = DIB_GetSource(Source, SrcX, SrcY, &exloSrcRGB.xlo);
-          SrcPixel32.col.red = (SrcPixel32.col.red * BlendFunc.SourceConstantAlpha) / 255;
-          SrcPixel32.col.green = (SrcPixel32.col.green * BlendFunc.SourceConstantAlpha) / 255;
-          SrcPixel32.col.blue = (SrcPixel32.col.blue * BlendFunc.SourceConstantAlpha) / 255;
+          SrcPixel32.ul = DIB_GetSource(Source, StepX.Pos, StepY.Pos, &exloSrcRGB.xlo);
+          SrcPixel32.ul = DIB_Scale255(SrcPixel32.ul, BlendFunc.SourceConstantAlpha);
 
           Alpha = ((BlendFunc.AlphaFormat & AC_SRC_ALPHA) != 0) ?
-               (SrcPixel32.col.alpha * BlendFunc.SourceConstantAlpha) / 255 :
-               BlendFunc.SourceConstantAlpha;
+               SrcPixel32.col.alpha : BlendFunc.SourceConstantAlpha;
 
           Alpha6 = Alpha >> 2;
           Alpha5 = Alpha >> 3;
@@ -703,13 +724,9 @@ DIB_16BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
 
           DIB_16BPP_PutPixel(Dest, DstX, DstY, DstPixel16.us);
 
-          DstX++;
-          SrcX = SourceRect->left + ((DstX-DestRect->left)*(SourceRect->right - SourceRect->left))
-                                                /(DestRect->right-DestRect->left);
+          DIB_StepNext(&StepX);
         }
-        DstY++;
-        SrcY = SourceRect->top + ((DstY-DestRect->top)*(SourceRect->bottom - SourceRect->top))
-                                                /(DestRect->bottom-DestRect->top);
+        DIB_StepNext(&StepY);
       }
   }
 
@@ -9,6 +9,7 @@
  */
 
 #include <win32k.h>
+#include "dibconv.h"
 
 #define NDEBUG
 #include <debug.h>
@@ -53,6 +54,7 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
   PBYTE    SourceBits, DestBits, SourceLine, DestLine;
   PBYTE    SourceBits_4BPP, SourceLine_4BPP;
   PDWORD   Source32, Dest32;
+  ULONG    cPixels = BltInfo->DestRect.right - BltInfo->DestRect.left;
 
   DestBits = (PBYTE)BltInfo->DestSurface->pvScan0
     + (BltInfo->DestRect.top * BltInfo->DestSurface->lDelta)
@@ -115,6 +117,21 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
     SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + BltInfo->SourcePoint.x;
     DestLine = DestBits;
 
+    /* Look palette translations up directly, whole lines at a time */
+    if (BltInfo->XlateSourceToDest &&
+        XLATEOBJ_pfnXlate(BltInfo->XlateSourceToDest) == EXLATEOBJ_iXlateTable)
+    {
+      for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
+      {
+        DIB_vConvertLine8to32((PULONG)DestLine, SourceLine, cPixels,
+                              BltInfo->XlateSourceToDest->pulXlate,
+                              BltInfo->XlateSourceToDest->cEntries);
+        SourceLine += BltInfo->SourceSurface->lDelta;
+        DestLine += BltInfo->DestSurface->lDelta;
+      }
+      break;
+    }
+
     for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
     {
       SourceBits = SourceLine;
@@ -161,6 +178,19 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
       + 3 * BltInfo->SourcePoint.x;
     DestLine = DestBits;
 
+    /* Without translation, expand whole lines at a time */
+    if (NULL == BltInfo->XlateSourceToDest ||
+      0 != (BltInfo->XlateSourceToDest->flXlate & XO_TRIVIAL))
+    {
+      for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
+      {
+        DIB_vConvertLine24to32((PULONG)DestLine, SourceLine, cPixels);
+        SourceLine += BltInfo->SourceSurface->lDelta;
+        DestLine += BltInfo->DestSurface->lDelta;
+      }
+      break;
+    }
+
     for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
     {
       SourceBits = SourceLine;
@@ -325,32 +355,17 @@ DIB_32BPP_TransparentBlt(SURFOBJ *DestSurf, SURFOBJ *SourceSurf,
   return TRUE;
 }
 
-typedef union {
-  ULONG ul;
-  struct {
-    UCHAR red;
-    UCHAR green;
-    UCHAR blue;
-    UCHAR alpha;
-  } col;
-} NICEPIXEL32;
-
-static __inline UCHAR
-Clamp8(ULONG val)
-{
-  return (val > 255) ? 255 : (UCHAR)val;
-}
-
 BOOLEAN
 DIB_32BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
                      RECTL* SourceRect, CLIPOBJ* ClipRegion,
                      XLATEOBJ* ColorTranslation, BLENDOBJ* BlendObj)
 {
-  INT Rows, Cols, SrcX, SrcY;
-  register PULONG Dst;
+  LONG Rows, Cols, Chunk, i, DstWidth, SrcWidth;
+  PULONG Dst, SrcLine;
+  ULONG SrcBuffer[64], SrcAlphaFill;
   BLENDFUNCTION BlendFunc;
-  register NICEPIXEL32 DstPixel, SrcPixel;
-  UCHAR Alpha, SrcBpp;
+  DIB_STEP StepX, StepY;
+  BOOLEAN DirectSource;
 
   DPRINT("DIB_32BPP_AlphaBlend: srcRect: (%d,%d)-(%d,%d), dstRect: (%d,%d)-(%d,%d)\n",
     SourceRect->left, SourceRect->top, SourceRect->right, SourceRect->bottom,
@@ -379,40 +394,55 @@ DIB_32BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
     return FALSE;
   }
 
+  DstWidth = DestRect->right - DestRect->left;
+  SrcWidth = SourceRect->right - SourceRect->left;
+  Rows = DestRect->bottom - DestRect->top;
+  if (DstWidth <= 0 || Rows <= 0)
+    return TRUE;
+
+  /* Sources without alpha are opaque before the constant alpha applies */
+  SrcAlphaFill = (BitsPerFormat(Source->iBitmapFormat) == 32) ? 0 : 0xFF000000;
+
+  /* 32bpp sources needing no translation are read straight from the bits */
+  DirectSource = (Source->iBitmapFormat == BMF_32BPP) &&
+                 (!ColorTranslation || (ColorTranslation->flXlate & XO_TRIVIAL));
+
   Dst = (PULONG)((ULONG_PTR)Dest->pvScan0 + (DestRect->top * Dest->lDelta) +
     (DestRect->left << 2));
-  SrcBpp = BitsPerFormat(Source->iBitmapFormat);
 
-  Rows = 0;
-   SrcY = SourceRect->top;
-   while (++Rows <= DestRect->bottom - DestRect->top)
+  DIB_StepInit(&StepY, SourceRect->top, SourceRect->bottom - SourceRect->top, Rows);
+  while (Rows--)
   {
-    Cols = 0;
-    SrcX = SourceRect->left;
-    while (++Cols <= DestRect->right - DestRect->left)
+    SrcLine = (PULONG)((ULONG_PTR)Source->pvScan0 + (StepY.Pos * Source->lDelta));
+
+    if (DirectSource && SrcWidth == DstWidth)
     {
-      SrcPixel.ul = DIB_GetSource(Source, SrcX, SrcY, ColorTranslation);
-      SrcPixel.col.red = (SrcPixel.col.red * BlendFunc.SourceConstantAlpha) / 255;
-      SrcPixel.col.green = (SrcPixel.col.green * BlendFunc.SourceConstantAlpha)  / 255;
-      SrcPixel.col.blue = (SrcPixel.col.blue * BlendFunc.SourceConstantAlpha) / 255;
-      SrcPixel.col.alpha = (32 == SrcBpp) ?
-                        (SrcPixel.col.alpha * BlendFunc.SourceConstantAlpha) / 255 :
-                        BlendFunc.SourceConstantAlpha ;
-
-      Alpha = ((BlendFunc.AlphaFormat & AC_SRC_ALPHA) != 0) ?
-           SrcPixel.col.alpha : BlendFunc.SourceConstantAlpha ;
-
-      DstPixel.ul = *Dst;
-      DstPixel.col.red = Clamp8((DstPixel.col.red * (255 - Alpha)) / 255 + SrcPixel.col.red) ;
-      DstPixel.col.green = Clamp8((DstPixel.col.green * (255 - Alpha)) / 255 + SrcPixel.col.green) ;
-      DstPixel.col.blue = Clamp8((DstPixel.col.blue * (255 - Alpha)) / 255 + SrcPixel.col.blue) ;
-      DstPixel.col.alpha = Clamp8((DstPixel.col.alpha * (255 - Alpha)) / 255 + SrcPixel.col.alpha) ;
-      *Dst++ = DstPixel.ul;
-      SrcX = SourceRect->left + (Cols*(SourceRect->right - SourceRect->left))/(DestRect->right - DestRect->left);
+      /* Unscaled, blend the whole row in place */
+      DIB_32BPP_AlphaBlendRow(Dst, SrcLine + SourceRect->left, DstWidth, BlendFunc);
     }
-    Dst = (PULONG)((ULONG_PTR)Dest->pvScan0 + ((DestRect->top + Rows) * Dest->lDelta) +
-                (DestRect->left << 2));
-    SrcY = SourceRect->top + (Rows*(SourceRect->bottom - SourceRect->top))/(DestRect->bottom - DestRect->top);
+    else
+    {
+      /* Gather the stretched or translated source a chunk at a time */
+      DIB_StepInit(&StepX, SourceRect->left, SrcWidth, DstWidth);
+      for (Cols = 0; Cols < DstWidth; Cols += Chunk)
+      {
+        Chunk = min(DstWidth - Cols, (LONG)RTL_NUMBER_OF(SrcBuffer));
+        for (i = 0; i < Chunk; i++)
+        {
+          if (DirectSource)
+            SrcBuffer[i] = SrcLine[StepX.Pos];
+          else
+            SrcBuffer[i] = DIB_GetSource(Source, StepX.Pos, StepY.Pos, ColorTranslation) |
+                           SrcAlphaFill;
+          DIB_StepNext(&StepX);
+        }
+
+        DIB_32BPP_AlphaBlendRow(Dst + Cols, SrcBuffer, Chunk, BlendFunc);
+      }
+    }
+
+    Dst = (PULONG)((ULONG_PTR)Dst + Dest->lDelta);
+    DIB_StepNext(&StepY);
   }
 
   return TRUE;
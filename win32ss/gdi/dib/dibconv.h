@@ -0,0 +1,100 @@
+/*
+ * PROJECT:         Win32 subsystem
+ * LICENSE:         See COPYING in the top level directory
+ * FILE:            win32ss/gdi/dib/dibconv.h
+ * PURPOSE:         Line conversion routines for common SRCCOPY format pairs
+ */
+
+#pragma once
+
+/*
+ * The DIB blitters use these instead of calling XLATEOBJ_iXlate for every
+ * pixel. They only depend on the basic types, so that tools/dibbench can
+ * check them against the per pixel translation and time them on the host.
+ */
+
+FORCEINLINE
+VOID
+DIB_vConvertLine24to32(PULONG pulDest, PBYTE pjSource, ULONG cPixels)
+{
+#if defined(_M_IX86) || defined(_M_AMD64)
+  ULONG ul0, ul1, ul2;
+
+  /* Expand 4 pixels from 3 unaligned dwords at a time */
+  for (; cPixels >= 4; cPixels -= 4)
+  {
+    ul0 = ((ULONG UNALIGNED *)pjSource)[0];
+    ul1 = ((ULONG UNALIGNED *)pjSource)[1];
+    ul2 = ((ULONG UNALIGNED *)pjSource)[2];
+    pulDest[0] = ul0 & 0xFFFFFF;
+    pulDest[1] = (ul0 >> 24) | ((ul1 & 0xFFFF) << 8);
+    pulDest[2] = (ul1 >> 16) | ((ul2 & 0xFF) << 16);
+    pulDest[3] = ul2 >> 8;
+    pjSource += 12;
+    pulDest += 4;
+  }
+#endif
+
+  /* Handle the remaining pixels */
+  while (cPixels--)
+  {
+    *pulDest++ = pjSource[0] | (pjSource[1] << 8) | (pjSource[2] << 16);
+    pjSource += 3;
+  }
+}
+
+FORCEINLINE
+VOID
+DIB_vConvertLine8to32(PULONG pulDest, PBYTE pjSource, ULONG cPixels,
+                      PULONG pulXlate, ULONG cEntries)
+{
+  ULONG iIndex;
+
+  /* A full table can be indexed with any byte */
+  if (cEntries >= 256)
+  {
+    while (cPixels--) *pulDest++ = pulXlate[*pjSource++];
+    return;
+  }
+
+  /* Indices past the end map to 0, like EXLATEOBJ_iXlateTable does */
+  while (cPixels--)
+  {
+    iIndex = *pjSource++;
+    *pulDest++ = (iIndex < cEntries) ? pulXlate[iIndex] : 0;
+  }
+}
+
+FORCEINLINE
+VOID
+DIB_vConvertLine32to16(PUSHORT pusDest, PULONG pulSource, ULONG cPixels,
+                       ULONG ulRedShift, ULONG ulRedMask,
+                       ULONG ulGreenShift, ULONG ulGreenMask)
+{
+  ULONG ulColor;
+
+  /* Keep the upper bits of each BGR component */
+  while (cPixels--)
+  {
+    ulColor = *pulSource++;
+    *pusDest++ = (USHORT)(((ulColor >> ulRedShift) & ulRedMask) |
+                          ((ulColor >> ulGreenShift) & ulGreenMask) |
+                          ((ulColor >> 3) & 0x1F));
+  }
+}
+
+/* Same result as EXLATEOBJ_iXlateBGRto555 */
+FORCEINLINE
+VOID
+DIB_vConvertLine32to555(PUSHORT pusDest, PULONG pulSource, ULONG cPixels)
+{
+  DIB_vConvertLine32to16(pusDest, pulSource, cPixels, 9, 0x7C00, 6, 0x3E0);
+}
+
+/* Same result as EXLATEOBJ_iXlateBGRto565 */
+FORCEINLINE
+VOID
+DIB_vConvertLine32to565(PUSHORT pusDest, PULONG pulSource, ULONG cPixels)
+{
+  DIB_vConvertLine32to16(pusDest, pulSource, cPixels, 8, 0xF800, 5, 0x7E0);
+}
@@ -36,6 +36,70 @@ static const BYTE gajXlate6to8[64] =
 194,198,202,207,210,215,219,223,227,231,235,239,243,247,251,255};
 
 
+/* The inverse color cube is indexed by the upper 5 bits of each color
+   component. Every cell holds the last color that was looked up in it in
+   the low 24 bits and its palette index in the high 8 bits, so lookups
+   stay exact and only colors sharing a cell compete for it. An empty cell
+   holds a color that cannot map to it: black for every cell but the first,
+   which holds white instead. */
+#define INVERSE_CUBE_CELLS (1 << 15)
+
+/* The cube lives only as long as the translation, so it has to be cleared
+   again for every blit. Only build it once the blit did enough searches to
+   pay for clearing its 128 KB. */
+#define INVERSE_CUBE_THRESHOLD 4096
+
+static
+ULONG
+EXLATEOBJ_iNearestPaletteIndex(
+    _Inout_ PEXLATEOBJ pexlo,
+    _In_ ULONG iColor)
+{
+    ULONG iCell, ulEntry, iIndex;
+
+    /* Only the RGB part is relevant for the search */
+    iColor &= 0xFFFFFF;
+
+    if (!pexlo->pulInverse)
+    {
+        /* Build the cube once enough searches were done and the
+           palette indices fit into the cells */
+        if ((++pexlo->cSearches == INVERSE_CUBE_THRESHOLD) &&
+            (pexlo->ppalDst->NumColors <= 256))
+        {
+            pexlo->pulInverse = EngAllocMem(0,
+                                            INVERSE_CUBE_CELLS * sizeof(ULONG),
+                                            GDITAG_PXLATE);
+            if (pexlo->pulInverse)
+            {
+                RtlZeroMemory(pexlo->pulInverse,
+                              INVERSE_CUBE_CELLS * sizeof(ULONG));
+                pexlo->pulInverse[0] = 0xFFFFFF;
+            }
+        }
+
+        if (!pexlo->pulInverse)
+            return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    }
+
+    /* Calculate the cell from the 5 most significant bits of r, g and b */
+    iCell = ((iColor >> 3) & 0x1F) |
+            ((iColor >> 6) & 0x3E0) |
+            ((iColor >> 9) & 0x7C00);
+
+    /* Check if the cell holds this color */
+    ulEntry = pexlo->pulInverse[iCell];
+    if ((ulEntry & 0xFFFFFF) == iColor)
+        return ulEntry >> 24;
+
+    /* Search the palette and remember the result */
+    iIndex = PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    pexlo->pulInverse[iCell] = (iIndex << 24) | iColor;
+
+    return iIndex;
+}
+
+
 /** iXlate functions **********************************************************/
 
 _Post_satisfies_(return==iColor)
@@ -179,7 +243,7 @@ ULONG
 FASTCALL
 EXLATEOBJ_iXlateRGBtoPal(PEXLATEOBJ pexlo, ULONG iColor)
 {
-    return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    return EXLATEOBJ_iNearestPaletteIndex(pexlo, iColor);
 }
 
 _Function_class_(FN_XLATE)
@@ -252,7 +316,7 @@ EXLATEOBJ_iXlate555toPal(PEXLATEOBJ pexlo, ULONG iColor)
 {
     iColor = EXLATEOBJ_iXlate555toRGB(pexlo, iColor);
 
-    return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    return EXLATEOBJ_iNearestPaletteIndex(pexlo, iColor);
 }
 
 _Function_class_(FN_XLATE)
@@ -321,7 +385,7 @@ EXLATEOBJ_iXlate565toPal(EXLATEOBJ *pexlo, ULONG iColor)
 {
     iColor = EXLATEOBJ_iXlate565toRGB(pexlo, iColor);
 
-    return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    return EXLATEOBJ_iNearestPaletteIndex(pexlo, iColor);
 }
 
 _Function_class_(FN_XLATE)
@@ -347,7 +411,7 @@ EXLATEOBJ_iXlateBitfieldsToPal(PEXLATEOBJ pexlo, ULONG iColor)
     iColor = EXLATEOBJ_iXlateShiftAndMask(pexlo, iColor);
 
     /* Return nearest index */
-    return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    return EXLATEOBJ_iNearestPaletteIndex(pexlo, iColor);
 }
 
 
@@ -375,6 +439,8 @@ EXLATEOBJ_vInitialize(
     pexlo->xlo.pulXlate = pexlo->aulXlate;
     pexlo->pfnXlate = EXLATEOBJ_iXlateTrivial;
     pexlo->hColorTransform = NULL;
+    pexlo->pulInverse = NULL;
+    pexlo->cSearches = 0;
     pexlo->ppalSrc = ppalSrc;
     pexlo->ppalDst = ppalDst;
     pexlo->xlo.iSrcType = (USHORT)ppalSrc->flFlags;
@@ -654,6 +720,12 @@ EXLATEOBJ_vCleanup(
         EngFreeMem(pexlo->xlo.pulXlate);
     }
     pexlo->xlo.pulXlate = pexlo->aulXlate;
+
+    if (pexlo->pulInverse)
+    {
+        EngFreeMem(pexlo->pulInverse);
+        pexlo->pulInverse = NULL;
+    }
 }
 
 /** Public DDI Functions ******************************************************/
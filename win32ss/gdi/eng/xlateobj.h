@@ -28,6 +28,10 @@ typedef struct _EXLATEOBJ
 
     HANDLE hColorTransform;
 
+    /* Inverse color cube for translations to indexed palettes */
+    PULONG pulInverse;
+    ULONG cSearches;
+
     union
     {
         ULONG aulXlate[6];
@@ -45,6 +49,28 @@ typedef struct _EXLATEOBJ
 
 extern EXLATEOBJ gexloTrivial;
 
+/* The DIB blitters convert these inline instead of calling them per pixel */
+_Function_class_(FN_XLATE)
+ULONG
+FASTCALL
+EXLATEOBJ_iXlateTable(
+    _In_ PEXLATEOBJ pexlo,
+    _In_ ULONG iColor);
+
+_Function_class_(FN_XLATE)
+ULONG
+FASTCALL
+EXLATEOBJ_iXlateBGRto555(
+    _In_ PEXLATEOBJ pexlo,
+    _In_ ULONG iColor);
+
+_Function_class_(FN_XLATE)
+ULONG
+FASTCALL
+EXLATEOBJ_iXlateBGRto565(
+    _In_ PEXLATEOBJ pexlo,
+    _In_ ULONG iColor);
+
 _Notnull_
 FORCEINLINE
 PFN_XLATE
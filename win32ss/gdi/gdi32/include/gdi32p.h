@@ -41,6 +41,16 @@ typedef INT
 #define ROP_USES_SOURCE(Rop)   (((Rop) << 2 ^ Rop) & 0xCC0000)
 #define RCAST(_Type, _Value)   (*((_Type*)&_Value))
 
+/* Batched vs. direct drawing call statistics, plain increments are good
+   enough for these rough numbers */
+#if DBG
+extern LONG GdiBatchedCalls;
+extern LONG GdiDirectCalls;
+#define GDI_COUNT_CALL(Counter) ((Counter)++)
+#else
+#define GDI_COUNT_CALL(Counter)
+#endif
+
 
 /* TYPES *********************************************************************/
 
@@ -314,12 +324,13 @@ BOOL FASTCALL LoadTheSpoolerDrv(VOID);
 
 FORCEINLINE
 PVOID
-GdiAllocBatchCommand(
+GdiAllocBatchCommandEx(
     HDC hdc,
-    USHORT Cmd)
+    USHORT Cmd,
+    ULONG cjData)
 {
     PTEB pTeb;
-    USHORT cjSize;
+    ULONG cjSize;
     PGDIBATCHHDR pHdr;
 
     /* Get a pointer to the TEB */
@@ -328,21 +339,14 @@ GdiAllocBatchCommand(
     /* Check if we have a valid environment */
     if (!pTeb || !pTeb->Win32ThreadInfo) return NULL;
 
-    /* Do we use a DC? */
-    if (hdc)
-    {
-        /* If the batch DC is NULL, we set this one as the new one */
-        if (!pTeb->GdiTebBatch.HDC) pTeb->GdiTebBatch.HDC = hdc;
-
-        /* If not, check if the batch DC equal to our DC */
-        else if (pTeb->GdiTebBatch.HDC != hdc) return NULL;
-    }
+    /* Do we use a DC? Only one DC can be batched at a time */
+    if (hdc && pTeb->GdiTebBatch.HDC && (pTeb->GdiTebBatch.HDC != hdc)) return NULL;
 
     /* Get the size of the entry */
-    if      (Cmd == GdiBCPatBlt) cjSize = 0;
-    else if (Cmd == GdiBCPolyPatBlt) cjSize = 0;
-    else if (Cmd == GdiBCTextOut) cjSize = 0;
-    else if (Cmd == GdiBCExtTextOut) cjSize = 0;
+    if      (Cmd == GdiBCPatBlt) cjSize = sizeof(GDIBSPATBLT);
+    else if (Cmd == GdiBCPolyPatBlt) cjSize = FIELD_OFFSET(GDIBSPPATBLT, pRect);
+    else if (Cmd == GdiBCTextOut) cjSize = FIELD_OFFSET(GDIBSTEXTOUT, String);
+    else if (Cmd == GdiBCExtTextOut) cjSize = sizeof(GDIBSEXTTEXTOUT);
     else if (Cmd == GdiBCSetBrushOrg) cjSize = sizeof(GDIBSSETBRHORG);
     else if (Cmd == GdiBCExtSelClipRgn) cjSize = 0;
     else if (Cmd == GdiBCSelObj) cjSize = sizeof(GDIBSOBJECT);
@@ -353,6 +357,11 @@ GdiAllocBatchCommand(
     /* Unsupported operation */
     if (cjSize == 0) return NULL;
 
+    /* Add the variable part, the entry must fit into an empty buffer */
+    if (cjData > GDIBATCHBUFSIZE) return NULL;
+    cjSize = (cjSize + cjData + sizeof(ULONG_PTR) - 1) & ~(sizeof(ULONG_PTR) - 1);
+    if (cjSize > GDIBATCHBUFSIZE) return NULL;
+
     /* Check if the buffer is full */
     if ((pTeb->GdiBatchCount >= GDI_BatchLimit) ||
         ((pTeb->GdiTebBatch.Offset + cjSize) > GDIBATCHBUFSIZE))
@@ -362,6 +371,9 @@ GdiAllocBatchCommand(
         NtGdiFlush();
     }
 
+    /* The flush resets the batch DC, so set ours only now */
+    if (hdc) pTeb->GdiTebBatch.HDC = hdc;
+
     /* Get the head of the entry */
     pHdr = (PVOID)((PUCHAR)pTeb->GdiTebBatch.Buffer + pTeb->GdiTebBatch.Offset);
 
@@ -371,11 +383,20 @@ GdiAllocBatchCommand(
 
     /* Fill in the core fields */
     pHdr->Cmd = Cmd;
-    pHdr->Size = cjSize;
+    pHdr->Size = (SHORT)cjSize;
 
     return pHdr;
 }
 
+FORCEINLINE
+PVOID
+GdiAllocBatchCommand(
+    HDC hdc,
+    USHORT Cmd)
+{
+    return GdiAllocBatchCommandEx(hdc, Cmd, 0);
+}
+
 FORCEINLINE
 PDC_ATTR
 GdiGetDcAttr(HDC hdc)
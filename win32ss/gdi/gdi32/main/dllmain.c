@@ -4,6 +4,9 @@
 
 #include <precomp.h>
 
+#define NDEBUG
+#include <debug.h>
+
 extern HGDIOBJ stock_objects[];
 BOOL SetStockObjects = FALSE;
 PDEVCAPS GdiDevCaps = NULL;
@@ -57,6 +60,9 @@ VOID
 WINAPI
 GdiProcessShutdown(VOID)
 {
+#if DBG
+    DPRINT("%ld drawing calls batched, %ld direct\n", GdiBatchedCalls, GdiDirectCalls);
+#endif
     DeleteCriticalSection(&gcsClientObjLinks);
     RtlDeleteCriticalSection(&semLocal);
 }
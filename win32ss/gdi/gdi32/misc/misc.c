@@ -34,6 +34,11 @@ PGDI_TABLE_ENTRY GdiHandleTable = NULL;
 PGDI_SHARED_HANDLE_TABLE GdiSharedHandleTable = NULL;
 HANDLE CurrentProcessId = NULL;
 DWORD GDI_BatchLimit = 1;
+#if DBG
+/* Drawing calls queued in the TEB batch and those that went to win32k right away */
+LONG GdiBatchedCalls = 0;
+LONG GdiDirectCalls = 0;
+#endif
 extern PGDIHANDLECACHE GdiHandleCache;
 
 /*
@@ -456,9 +456,46 @@ PatBlt(
     _In_ INT nHeight,
     _In_ DWORD dwRop)
 {
+    PDC_ATTR pdcattr;
+    PGDIBSPATBLT pgO;
+
     HANDLE_METADC(BOOL, PatBlt, FALSE, hdc, nXLeft, nYLeft, nWidth, nHeight, dwRop);
 
-    /* FIXME some part need be done in user mode */
+    /* Get the DC attribute */
+    pdcattr = GdiGetDcAttr(hdc);
+
+    /* Try to batch it, unless the caller may look at the DIB section bits
+       right away. Rops with a source fail in win32k, let them go there. */
+    if (pdcattr &&
+        !(pdcattr->ulDirty_ & DC_DIBSECTION) &&
+        !ROP_USES_SOURCE(dwRop))
+    {
+        pgO = GdiAllocBatchCommand(hdc, GdiBCPatBlt);
+        if (pgO)
+        {
+            /* Capture the attributes, they can change before the flush */
+            pgO->nXLeft = nXLeft;
+            pgO->nYLeft = nYLeft;
+            pgO->nWidth = nWidth;
+            pgO->nHeight = nHeight;
+            pgO->dwRop = dwRop;
+            pgO->hbrush = pdcattr->hbrush;
+            pgO->crForegroundClr = pdcattr->crForegroundClr;
+            pgO->crBackgroundClr = pdcattr->crBackgroundClr;
+            pgO->crBrushClr = pdcattr->crBrushClr;
+            pgO->ulForegroundClr = pdcattr->ulForegroundClr;
+            pgO->ulBackgroundClr = pdcattr->ulBackgroundClr;
+            pgO->ulBrushClr = pdcattr->ulBrushClr;
+
+            /* Mode changes done in user mode have to flush this first */
+            pdcattr->ulDirty_ |= (DC_MODE_DIRTY|DC_FONTTEXT_DIRTY);
+
+            GDI_COUNT_CALL(GdiBatchedCalls);
+            return TRUE;
+        }
+    }
+
+    GDI_COUNT_CALL(GdiDirectCalls);
     return NtGdiPatBlt( hdc,  nXLeft,  nYLeft,  nWidth,  nHeight,  dwRop);
 }
 
@@ -474,6 +511,8 @@ PolyPatBlt(
     UINT i;
     BOOL bResult;
     HBRUSH hbrOld;
+    PDC_ATTR pdcattr;
+    PGDIBSPPATBLT pgO;
 
     /* Handle meta DCs */
     if ((GDI_HANDLE_GET_TYPE(hdc) == GDILoObjType_LO_METADC16_TYPE) ||
@@ -511,7 +550,39 @@ PolyPatBlt(
         return bResult;
     }
 
-    /* FIXME some part need be done in user mode */
+    /* Get the DC attribute */
+    pdcattr = GdiGetDcAttr(hdc);
+
+    /* Try to batch it, same rules as for PatBlt */
+    if (pdcattr &&
+        !(pdcattr->ulDirty_ & DC_DIBSECTION) &&
+        !ROP_USES_SOURCE(dwRop) &&
+        (nCount > 0) &&
+        (nCount <= GDIBATCHBUFSIZE / sizeof(PATRECT)))
+    {
+        pgO = GdiAllocBatchCommandEx(hdc, GdiBCPolyPatBlt, nCount * sizeof(PATRECT));
+        if (pgO)
+        {
+            /* POLYPATBLT and PATRECT have the same layout */
+            pgO->rop4 = dwRop;
+            pgO->Mode = dwMode;
+            pgO->Count = nCount;
+            pgO->crForegroundClr = pdcattr->crForegroundClr;
+            pgO->crBackgroundClr = pdcattr->crBackgroundClr;
+            pgO->crBrushClr = pdcattr->crBrushClr;
+            pgO->ulForegroundClr = pdcattr->ulForegroundClr;
+            pgO->ulBackgroundClr = pdcattr->ulBackgroundClr;
+            pgO->ulBrushClr = pdcattr->ulBrushClr;
+            RtlCopyMemory(pgO->pRect, pPoly, nCount * sizeof(PATRECT));
+
+            pdcattr->ulDirty_ |= (DC_MODE_DIRTY|DC_FONTTEXT_DIRTY);
+
+            GDI_COUNT_CALL(GdiBatchedCalls);
+            return TRUE;
+        }
+    }
+
+    GDI_COUNT_CALL(GdiDirectCalls);
     return NtGdiPolyPatBlt(hdc, dwRop, pPoly, nCount, dwMode);
 }
 
@@ -466,6 +466,8 @@ ExtTextOutW(
     _In_ UINT cwc,
     _In_reads_opt_(cwc) const INT *lpDx)
 {
+    PDC_ATTR pdcattr;
+
     HANDLE_METADC(BOOL,
                   ExtTextOut,
                   FALSE,
@@ -478,6 +480,77 @@ ExtTextOutW(
                   cwc,
                   lpDx);
 
+    /* Get the DC attribute */
+    pdcattr = GdiGetDcAttr(hdc);
+
+    /* Try to batch it. Not with a DIB section selected, where the caller may
+       look at the bits right away, and not when the current position must be
+       updated or the alignment is mirrored, which the batch cannot express. */
+    if (pdcattr &&
+        !(pdcattr->ulDirty_ & DC_DIBSECTION) &&
+        !(pdcattr->lTextAlign & TA_UPDATECP) &&
+        !(pdcattr->dwLayout & LAYOUT_RTL))
+    {
+        if ((cwc == 0) && lprc && (fuOptions & ETO_OPAQUE) &&
+            !(fuOptions & ~(ETO_OPAQUE | ETO_CLIPPED)))
+        {
+            PGDIBSEXTTEXTOUT pgO;
+
+            /* Just an opaque rectangle fill */
+            pgO = GdiAllocBatchCommand(hdc, GdiBCExtTextOut);
+            if (pgO)
+            {
+                pgO->Count = 0;
+                pgO->Options = fuOptions;
+                pgO->Rect = *lprc;
+                pgO->ulBackgroundClr = pdcattr->ulBackgroundClr;
+
+                pdcattr->ulDirty_ |= (DC_MODE_DIRTY|DC_FONTTEXT_DIRTY);
+
+                GDI_COUNT_CALL(GdiBatchedCalls);
+                return TRUE;
+            }
+        }
+        else if ((cwc > 0) && (cwc < GDIBATCHBUFSIZE / sizeof(WCHAR)) && lpString &&
+                 (lprc || !(fuOptions & (ETO_OPAQUE | ETO_CLIPPED))))
+        {
+            PGDIBSTEXTOUT pgO;
+            ULONG cjString, cjDx;
+
+            /* The Dx array follows the string */
+            cjString = (cwc * sizeof(WCHAR) + sizeof(INT) - 1) & ~(sizeof(INT) - 1);
+            cjDx = lpDx ? cwc * sizeof(INT) * (fuOptions & ETO_PDY ? 2 : 1) : 0;
+
+            pgO = GdiAllocBatchCommandEx(hdc, GdiBCTextOut, cjString + cjDx);
+            if (pgO)
+            {
+                /* Capture the attributes, they can change before the flush */
+                pgO->crForegroundClr = pdcattr->crForegroundClr;
+                pgO->crBackgroundClr = pdcattr->crBackgroundClr;
+                pgO->lmBkMode = pdcattr->lBkMode;
+                pgO->ulForegroundClr = pdcattr->ulForegroundClr;
+                pgO->ulBackgroundClr = pdcattr->ulBackgroundClr;
+                pgO->x = x;
+                pgO->y = y;
+                pgO->Options = fuOptions;
+                if (lprc) pgO->Rect = *lprc;
+                else RtlZeroMemory(&pgO->Rect, sizeof(RECT));
+                pgO->cbCount = cwc;
+                pgO->Size = cjDx;
+                pgO->hlfntNew = pdcattr->hlfntNew;
+                pgO->flTextAlign = pdcattr->flTextAlign;
+                RtlCopyMemory(pgO->String, lpString, cwc * sizeof(WCHAR));
+                if (lpDx) RtlCopyMemory((PCHAR)pgO->String + cjString, lpDx, cjDx);
+
+                pdcattr->ulDirty_ |= (DC_MODE_DIRTY|DC_FONTTEXT_DIRTY);
+
+                GDI_COUNT_CALL(GdiBatchedCalls);
+                return TRUE;
+            }
+        }
+    }
+
+    GDI_COUNT_CALL(GdiDirectCalls);
     return NtGdiExtTextOutW(hdc,
                             x,
                             y,
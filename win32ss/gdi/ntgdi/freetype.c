@@ -60,19 +60,53 @@ static BOOL RenderingEnabled = TRUE;
 #define IntUnLockFreeType \
   ExReleaseFastMutexUnsafeAndLeaveCriticalRegion(FreeTypeLock)
 
-#define MAX_FONT_CACHE 256
+/* The glyph cache is limited by the memory its bitmaps take, not by the
+   number of glyphs. The budget can be set in KB with the GlyphCacheSize
+   value of the GRE_Initialize key. A single face may use only a part of it,
+   so one large font cannot push all others out. */
+#define FONT_CACHE_DEFAULT_BUDGET   (512 * 1024)
+#define FONT_CACHE_MIN_BUDGET       (64 * 1024)
+#define FONT_CACHE_MAX_BUDGET       (16 * 1024 * 1024)
+#define FONT_CACHE_FACE_SHARE       2
+#define FONT_CACHE_HASH_SIZE        256
+
+/* Per face part of the glyph cache, hangs off FT_Face::generic.data */
+typedef struct _FONT_FACE_CACHE
+{
+    LIST_ENTRY ListEntry;
+    LIST_ENTRY EntryListHead;
+    FT_Face Face;
+    ULONG NumEntries;
+    ULONG cjUsed;
+    ULONG Hits;
+    ULONG Misses;
+    ULONG Evictions;
+} FONT_FACE_CACHE, *PFONT_FACE_CACHE;
 
 typedef struct _FONT_CACHE_ENTRY
 {
     LIST_ENTRY ListEntry;
+    LIST_ENTRY HashEntry;
+    LIST_ENTRY FaceEntry;
+    PFONT_FACE_CACHE FaceCache;
+    ULONG Hash;
+    ULONG cjSize;
     int GlyphIndex;
     FT_Face Face;
     FT_BitmapGlyph BitmapGlyph;
     int Height;
+    FT_Render_Mode RenderMode;
     MATRIX mxWorldToDevice;
 } FONT_CACHE_ENTRY, *PFONT_CACHE_ENTRY;
 static LIST_ENTRY FontCacheListHead;
+static LIST_ENTRY FontCacheHashTable[FONT_CACHE_HASH_SIZE];
+static LIST_ENTRY FontFaceCacheListHead;
 static UINT FontCacheNumEntries;
+static ULONG FontCacheBytes;
+static ULONG FontCacheBudget = FONT_CACHE_DEFAULT_BUDGET;
+static ULONG FontCacheHits;
+static ULONG FontCacheMisses;
+static ULONG FontCacheEvictions;
 
 static PWCHAR ElfScripts[32] =   /* These are in the order of the fsCsb[0] bits */
 {
@@ -147,10 +181,34 @@ BOOL FASTCALL
 InitFontSupport(VOID)
 {
     ULONG ulError;
+    NTSTATUS Status;
+    HKEY hKey;
+    DWORD dwValue;
+    ULONG i;
 
     InitializeListHead(&FontListHead);
     InitializeListHead(&FontCacheListHead);
+    InitializeListHead(&FontFaceCacheListHead);
+    for (i = 0; i < FONT_CACHE_HASH_SIZE; i++)
+    {
+        InitializeListHead(&FontCacheHashTable[i]);
+    }
     FontCacheNumEntries = 0;
+    FontCacheBytes = 0;
+
+    /* Read the glyph cache budget */
+    Status = RegOpenKey(L"\\REGISTRY\\MACHINE\\SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\GRE_Initialize", &hKey);
+    if (NT_SUCCESS(Status))
+    {
+        if (RegReadDWORD(hKey, L"GlyphCacheSize", &dwValue))
+        {
+            dwValue = min(dwValue, FONT_CACHE_MAX_BUDGET / 1024);
+            FontCacheBudget = max(dwValue * 1024, FONT_CACHE_MIN_BUDGET);
+        }
+        ZwClose(hKey);
+    }
+    DPRINT("Glyph cache budget is %lu bytes\n", FontCacheBudget);
+
     /* Fast Mutexes must be allocated from non paged pool */
     FontListLock = ExAllocatePoolWithTag(NonPagedPool, sizeof(FAST_MUTEX), TAG_INTERNAL_SYNC);
     ExInitializeFastMutex(FontListLock);
@@ -1360,36 +1418,113 @@ SameScaleMatrix(
             FLOATOBJ_Equal(&pmx1->efM22, &pmx2->efM22));
 }
 
+static
+ULONG
+IntGlyphCacheHash(
+    FT_Face Face,
+    INT GlyphIndex,
+    INT Height,
+    FT_Render_Mode RenderMode)
+{
+    ULONG Hash;
+
+    /* The transformation is left out, it is compared on lookup */
+    Hash = (ULONG)((ULONG_PTR)Face >> 4);
+    Hash = Hash * 31 + (ULONG)GlyphIndex;
+    Hash = Hash * 31 + (ULONG)Height;
+    Hash = Hash * 31 + (ULONG)RenderMode;
+    return Hash ^ (Hash >> 16);
+}
+
+static
+PFONT_FACE_CACHE
+IntGetFaceCache(FT_Face Face)
+{
+    PFONT_FACE_CACHE FaceCache = Face->generic.data;
+
+    if (FaceCache == NULL)
+    {
+        FaceCache = ExAllocatePoolWithTag(PagedPool, sizeof(FONT_FACE_CACHE), TAG_FONT);
+        if (FaceCache == NULL)
+        {
+            return NULL;
+        }
+
+        RtlZeroMemory(FaceCache, sizeof(FONT_FACE_CACHE));
+        InitializeListHead(&FaceCache->EntryListHead);
+        FaceCache->Face = Face;
+        InsertTailList(&FontFaceCacheListHead, &FaceCache->ListEntry);
+        Face->generic.data = FaceCache;
+    }
+
+    return FaceCache;
+}
+
+static
+VOID
+IntGlyphCacheRemoveEntry(PFONT_CACHE_ENTRY Entry)
+{
+    PFONT_FACE_CACHE FaceCache = Entry->FaceCache;
+
+    RemoveEntryList(&Entry->ListEntry);
+    RemoveEntryList(&Entry->HashEntry);
+    RemoveEntryList(&Entry->FaceEntry);
+
+    FaceCache->NumEntries--;
+    FaceCache->cjUsed -= Entry->cjSize;
+    FaceCache->Evictions++;
+    FontCacheNumEntries--;
+    FontCacheBytes -= Entry->cjSize;
+    FontCacheEvictions++;
+
+    FT_Done_Glyph((FT_Glyph)Entry->BitmapGlyph);
+    ExFreePoolWithTag(Entry, TAG_FONT);
+}
+
 FT_BitmapGlyph APIENTRY
 ftGdiGlyphCacheGet(
     FT_Face Face,
     INT GlyphIndex,
     INT Height,
+    FT_Render_Mode RenderMode,
     PMATRIX pmx)
 {
-    PLIST_ENTRY CurrentEntry;
+    PLIST_ENTRY BucketHead, CurrentEntry;
     PFONT_CACHE_ENTRY FontEntry;
+    PFONT_FACE_CACHE FaceCache;
+    ULONG Hash;
 
-    CurrentEntry = FontCacheListHead.Flink;
-    while (CurrentEntry != &FontCacheListHead)
+    Hash = IntGlyphCacheHash(Face, GlyphIndex, Height, RenderMode);
+    BucketHead = &FontCacheHashTable[Hash & (FONT_CACHE_HASH_SIZE - 1)];
+
+    for (CurrentEntry = BucketHead->Flink;
+         CurrentEntry != BucketHead;
+         CurrentEntry = CurrentEntry->Flink)
     {
-        FontEntry = (PFONT_CACHE_ENTRY)CurrentEntry;
-        if ((FontEntry->Face == Face) &&
+        FontEntry = CONTAINING_RECORD(CurrentEntry, FONT_CACHE_ENTRY, HashEntry);
+        if ((FontEntry->Hash == Hash) &&
+            (FontEntry->Face == Face) &&
             (FontEntry->GlyphIndex == GlyphIndex) &&
             (FontEntry->Height == Height) &&
+            (FontEntry->RenderMode == RenderMode) &&
             (SameScaleMatrix(&FontEntry->mxWorldToDevice, pmx)))
-            break;
-        CurrentEntry = CurrentEntry->Flink;
-    }
-
-    if (CurrentEntry == &FontCacheListHead)
-    {
-        return NULL;
+        {
+            /* Make it the most recently used glyph, globally and of its face */
+            RemoveEntryList(&FontEntry->ListEntry);
+            InsertHeadList(&FontCacheListHead, &FontEntry->ListEntry);
+            RemoveEntryList(&FontEntry->FaceEntry);
+            InsertHeadList(&FontEntry->FaceCache->EntryListHead, &FontEntry->FaceEntry);
+
+            FontEntry->FaceCache->Hits++;
+            FontCacheHits++;
+            return FontEntry->BitmapGlyph;
+        }
     }
 
-    RemoveEntryList(CurrentEntry);
-    InsertHeadList(&FontCacheListHead, CurrentEntry);
-    return FontEntry->BitmapGlyph;
+    FaceCache = Face->generic.data;
+    if (FaceCache) FaceCache->Misses++;
+    FontCacheMisses++;
+    return NULL;
 }
 
 FT_BitmapGlyph APIENTRY
@@ -1403,10 +1538,18 @@ ftGdiGlyphCacheSet(
 {
     FT_Glyph GlyphCopy;
     INT error;
-    PFONT_CACHE_ENTRY NewEntry;
+    PFONT_CACHE_ENTRY NewEntry, OldEntry;
+    PFONT_FACE_CACHE FaceCache;
     FT_Bitmap AlignedBitmap;
     FT_BitmapGlyph BitmapGlyph;
 
+    FaceCache = IntGetFaceCache(Face);
+    if (!FaceCache)
+    {
+        DPRINT1("Alloc failure caching glyph.\n");
+        return NULL;
+    }
+
     error = FT_Get_Glyph(GlyphSlot, &GlyphCopy);
     if (error)
     {
@@ -1447,21 +1590,82 @@ ftGdiGlyphCacheSet(
     NewEntry->Face = Face;
     NewEntry->BitmapGlyph = BitmapGlyph;
     NewEntry->Height = Height;
+    NewEntry->RenderMode = RenderMode;
     NewEntry->mxWorldToDevice = *pmx;
+    NewEntry->FaceCache = FaceCache;
+    NewEntry->Hash = IntGlyphCacheHash(Face, GlyphIndex, Height, RenderMode);
+
+    /* Account for the bitmap as well as for the bookkeeping */
+    NewEntry->cjSize = sizeof(FONT_CACHE_ENTRY) + sizeof(FT_BitmapGlyphRec) +
+                       abs(AlignedBitmap.pitch) * AlignedBitmap.rows;
 
     InsertHeadList(&FontCacheListHead, &NewEntry->ListEntry);
-    if (FontCacheNumEntries++ > MAX_FONT_CACHE)
+    InsertHeadList(&FontCacheHashTable[NewEntry->Hash & (FONT_CACHE_HASH_SIZE - 1)],
+                   &NewEntry->HashEntry);
+    InsertHeadList(&FaceCache->EntryListHead, &NewEntry->FaceEntry);
+    FaceCache->NumEntries++;
+    FaceCache->cjUsed += NewEntry->cjSize;
+    FontCacheNumEntries++;
+    FontCacheBytes += NewEntry->cjSize;
+
+    /* Keep the face within its share, dropping its own least used glyphs */
+    while (FaceCache->cjUsed > FontCacheBudget / FONT_CACHE_FACE_SHARE)
     {
-        NewEntry = (PFONT_CACHE_ENTRY)FontCacheListHead.Blink;
-        FT_Done_Glyph((FT_Glyph)NewEntry->BitmapGlyph);
-        RemoveTailList(&FontCacheListHead);
-        ExFreePoolWithTag(NewEntry, TAG_FONT);
-        FontCacheNumEntries--;
+        OldEntry = CONTAINING_RECORD(FaceCache->EntryListHead.Blink, FONT_CACHE_ENTRY, FaceEntry);
+        if (OldEntry == NewEntry) break;
+        IntGlyphCacheRemoveEntry(OldEntry);
+    }
+
+    /* Then the whole cache within the budget */
+    while (FontCacheBytes > FontCacheBudget)
+    {
+        OldEntry = CONTAINING_RECORD(FontCacheListHead.Blink, FONT_CACHE_ENTRY, ListEntry);
+        if (OldEntry == NewEntry) break;
+        IntGlyphCacheRemoveEntry(OldEntry);
     }
 
     return BitmapGlyph;
 }
 
+/*
+ * Print the glyph cache statistics, for the kernel debugger.
+ * Doesn't take the FreeType lock, the system is stopped anyway.
+ */
+VOID
+NTAPI
+ftGdiGlyphCacheDump(VOID)
+{
+    PLIST_ENTRY CurrentEntry;
+    PFONT_FACE_CACHE FaceCache;
+    ULONG ulTotal;
+
+    ulTotal = FontCacheHits + FontCacheMisses;
+    DbgPrint("Glyph cache: %lu glyphs, %lu of %lu bytes\n",
+             FontCacheNumEntries, FontCacheBytes, FontCacheBudget);
+    DbgPrint("%lu hits, %lu misses (%lu%% hits), %lu evictions\n\n",
+             FontCacheHits, FontCacheMisses,
+             ulTotal ? (ULONG)((ULONGLONG)FontCacheHits * 100 / ulTotal) : 0,
+             FontCacheEvictions);
+
+    DbgPrint("Face     Glyphs    Bytes     Hits   Misses  Evicted  Name\n");
+    DbgPrint("----------------------------------------------------------------\n");
+    for (CurrentEntry = FontFaceCacheListHead.Flink;
+         CurrentEntry != &FontFaceCacheListHead;
+         CurrentEntry = CurrentEntry->Flink)
+    {
+        FaceCache = CONTAINING_RECORD(CurrentEntry, FONT_FACE_CACHE, ListEntry);
+        DbgPrint("%p %6lu %8lu %8lu %8lu %8lu  %s %s\n",
+                 FaceCache->Face,
+                 FaceCache->NumEntries,
+                 FaceCache->cjUsed,
+                 FaceCache->Hits,
+                 FaceCache->Misses,
+                 FaceCache->Evictions,
+                 FaceCache->Face->family_name,
+                 FaceCache->Face->style_name);
+    }
+}
+
 
 static
 void
@@ -2282,6 +2486,7 @@ TextIntGetTextExtentPoint(PDC dc,
 
         if (!(realglyph = ftGdiGlyphCacheGet(face, glyph_index,
                                              TextObj->logfont.elfEnumLogfontEx.elfLogFont.lfHeight,
+                                             RenderMode,
                                              pmxWorldToDevice)))
         {
             error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
@@ -3524,6 +3729,7 @@ GreExtTextOutW(
 
             if (!(realglyph = ftGdiGlyphCacheGet(face, glyph_index,
                                                  TextObj->logfont.elfEnumLogfontEx.elfLogFont.lfHeight,
+                                                 RenderMode,
                                                  pmxWorldToDevice)))
             {
                 error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
@@ -3604,6 +3810,7 @@ GreExtTextOutW(
 
         if (!(realglyph = ftGdiGlyphCacheGet(face, glyph_index,
                                              TextObj->logfont.elfEnumLogfontEx.elfLogFont.lfHeight,
+                                             RenderMode,
                                              pmxWorldToDevice)))
         {
             error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
@@ -59,12 +59,82 @@ SynchonizeDriver(FLONG Flags)
   return;
 }
 
+//
+// DC attributes a batched drawing command brings along.
+//
+// gdi32 changes colors, brush, font, background mode and text alignment in
+// the shared DC_ATTR without calling win32k, so by the time the batch is
+// flushed they may no longer match what was current when the command was
+// queued. The command records them, they are swapped into the DC_ATTR while
+// it runs and the current values are put back afterwards.
+//
+typedef struct _GDIBATCHATTR
+{
+  ULONG ulDirty_;
+  HANDLE hbrush;
+  HANDLE hlfntNew;
+  COLORREF crForegroundClr;
+  ULONG ulForegroundClr;
+  COLORREF crBackgroundClr;
+  ULONG ulBackgroundClr;
+  COLORREF crBrushClr;
+  ULONG ulBrushClr;
+  BYTE jBkMode;
+  LONG lBkMode;
+  FLONG flTextAlign;
+  LONG lTextAlign;
+} GDIBATCHATTR, *PGDIBATCHATTR;
+
+static
+VOID
+FASTCALL
+GdiSaveBatchAttributes(PDC_ATTR pdcattr, PGDIBATCHATTR pSaved)
+{
+  pSaved->ulDirty_        = pdcattr->ulDirty_;
+  pSaved->hbrush          = pdcattr->hbrush;
+  pSaved->hlfntNew        = pdcattr->hlfntNew;
+  pSaved->crForegroundClr = pdcattr->crForegroundClr;
+  pSaved->ulForegroundClr = pdcattr->ulForegroundClr;
+  pSaved->crBackgroundClr = pdcattr->crBackgroundClr;
+  pSaved->ulBackgroundClr = pdcattr->ulBackgroundClr;
+  pSaved->crBrushClr      = pdcattr->crBrushClr;
+  pSaved->ulBrushClr      = pdcattr->ulBrushClr;
+  pSaved->jBkMode         = pdcattr->jBkMode;
+  pSaved->lBkMode         = pdcattr->lBkMode;
+  pSaved->flTextAlign     = pdcattr->flTextAlign;
+  pSaved->lTextAlign      = pdcattr->lTextAlign;
+}
+
+static
+VOID
+FASTCALL
+GdiRestoreBatchAttributes(PDC_ATTR pdcattr, PGDIBATCHATTR pSaved)
+{
+  pdcattr->hbrush          = pSaved->hbrush;
+  pdcattr->hlfntNew        = pSaved->hlfntNew;
+  pdcattr->crForegroundClr = pSaved->crForegroundClr;
+  pdcattr->ulForegroundClr = pSaved->ulForegroundClr;
+  pdcattr->crBackgroundClr = pSaved->crBackgroundClr;
+  pdcattr->ulBackgroundClr = pSaved->ulBackgroundClr;
+  pdcattr->crBrushClr      = pSaved->crBrushClr;
+  pdcattr->ulBrushClr      = pSaved->ulBrushClr;
+  pdcattr->jBkMode         = pSaved->jBkMode;
+  pdcattr->lBkMode         = pSaved->lBkMode;
+  pdcattr->flTextAlign     = pSaved->flTextAlign;
+  pdcattr->lTextAlign      = pSaved->lTextAlign;
+
+  // The realized brushes now belong to the batched attributes, have them
+  // rebuilt from the restored ones on the next use.
+  pdcattr->ulDirty_ = pSaved->ulDirty_ |
+                      DIRTY_FILL | DIRTY_TEXT | DIRTY_BACKGROUND | DC_BRUSH_DIRTY;
+}
+
 //
 // Process the batch.
 //
 ULONG
 FASTCALL
-GdiFlushUserBatch(PDC dc, PGDIBATCHHDR pHdr)
+GdiFlushUserBatch(PDC dc, PGDIBATCHHDR pHdr, ULONG cjLeft)
 {
   ULONG Cmd = 0, Size = 0;
   PDC_ATTR pdcattr = NULL;
@@ -86,19 +156,231 @@ GdiFlushUserBatch(PDC dc, PGDIBATCHHDR pHdr)
   }
   _SEH2_END;
 
+  /* The entry has to fit in what is left of the batch buffer */
+  if ((Size < sizeof(GDIBATCHHDR)) || (Size > cjLeft))
+  {
+     DPRINT1("WARNING! GdiBatch entry size %lu invalid!\n", Size);
+     return 0;
+  }
+
   switch(Cmd)
   {
      case GdiBCPatBlt:
+     {
+        PGDIBSPATBLT pgDPB;
+        GDIBATCHATTR Saved;
+        DWORD dwRop;
+
+        if (!dc || (Size < sizeof(GDIBSPATBLT))) break;
+        pgDPB = (PGDIBSPATBLT) pHdr;
+
+        /* Same rop handling as NtGdiPatBlt */
+        dwRop = pgDPB->dwRop & 0x00FF0000;
+        dwRop |= dwRop << 8;
+        if (ROP_USES_SOURCE(dwRop)) break;
+
+        /* Nothing to do for empty mem or info DCs */
+        if (dc->dclevel.pSurface == NULL) break;
+
+        GdiSaveBatchAttributes(pdcattr, &Saved);
+        pdcattr->hbrush          = pgDPB->hbrush;
+        pdcattr->crForegroundClr = pgDPB->crForegroundClr;
+        pdcattr->ulForegroundClr = pgDPB->ulForegroundClr;
+        pdcattr->crBackgroundClr = pgDPB->crBackgroundClr;
+        pdcattr->ulBackgroundClr = pgDPB->ulBackgroundClr;
+        pdcattr->crBrushClr      = pgDPB->crBrushClr;
+        pdcattr->ulBrushClr      = pgDPB->ulBrushClr;
+        pdcattr->ulDirty_ |= DIRTY_FILL | DC_BRUSH_DIRTY;
+
+        DC_vUpdateFillBrush(dc);
+        IntPatBlt(dc,
+                  pgDPB->nXLeft,
+                  pgDPB->nYLeft,
+                  pgDPB->nWidth,
+                  pgDPB->nHeight,
+                  dwRop,
+                  &dc->eboFill);
+
+        GdiRestoreBatchAttributes(pdcattr, &Saved);
         break;
+     }
 
      case GdiBCPolyPatBlt:
+     {
+        PGDIBSPPATBLT pgDPB;
+        GDIBATCHATTR Saved;
+        PPATRECT pRects;
+        ULONG cRects;
+        NTSTATUS Status = STATUS_SUCCESS;
+
+        if (!dc || (Size < FIELD_OFFSET(GDIBSPPATBLT, pRect))) break;
+        pgDPB = (PGDIBSPPATBLT) pHdr;
+
+        /* Other threads of the process can write to the batch, so capture
+           the count once and work on a copy of the rectangles */
+        cRects = pgDPB->Count;
+        if ((cRects == 0) ||
+            (cRects > (Size - FIELD_OFFSET(GDIBSPPATBLT, pRect)) / sizeof(PATRECT)))
+        {
+           DPRINT1("Invalid PolyPatBlt batch entry, %lu rects in %lu bytes\n", cRects, Size);
+           break;
+        }
+
+        pRects = ExAllocatePoolWithTag(PagedPool, cRects * sizeof(PATRECT), GDITAG_PLGBLT_DATA);
+        if (!pRects) break;
+
+        _SEH2_TRY
+        {
+           RtlCopyMemory(pRects, pgDPB->pRect, cRects * sizeof(PATRECT));
+        }
+        _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
+        {
+           Status = _SEH2_GetExceptionCode();
+        }
+        _SEH2_END;
+
+        if (!NT_SUCCESS(Status))
+        {
+           ExFreePoolWithTag(pRects, GDITAG_PLGBLT_DATA);
+           break;
+        }
+
+        /* The brushes are per rectangle, only the colors come from the DC */
+        GdiSaveBatchAttributes(pdcattr, &Saved);
+        pdcattr->crForegroundClr = pgDPB->crForegroundClr;
+        pdcattr->ulForegroundClr = pgDPB->ulForegroundClr;
+        pdcattr->crBackgroundClr = pgDPB->crBackgroundClr;
+        pdcattr->ulBackgroundClr = pgDPB->ulBackgroundClr;
+        pdcattr->crBrushClr      = pgDPB->crBrushClr;
+        pdcattr->ulBrushClr      = pgDPB->ulBrushClr;
+
+        /* The DC is locked already, the lock taken in there nests */
+        IntGdiPolyPatBlt(dc->BaseObject.hHmgr,
+                         pgDPB->rop4,
+                         pRects,
+                         cRects,
+                         pgDPB->Mode);
+
+        GdiRestoreBatchAttributes(pdcattr, &Saved);
+        ExFreePoolWithTag(pRects, GDITAG_PLGBLT_DATA);
         break;
+     }
 
      case GdiBCTextOut:
+     {
+        PGDIBSTEXTOUT pgO;
+        GDIBATCHATTR Saved;
+        ULONG cChars, cjString, cjDx;
+        UINT fuOptions;
+        RECTL Rect;
+        PVOID pvBuffer;
+        LPINT pDx = NULL;
+        NTSTATUS Status = STATUS_SUCCESS;
+
+        if (!dc || (Size < FIELD_OFFSET(GDIBSTEXTOUT, String))) break;
+        pgO = (PGDIBSTEXTOUT) pHdr;
+
+        /* Other threads of the process can write to the batch, so capture
+           the counts and options once and validate the captured values */
+        cChars = pgO->cbCount;
+        cjDx = pgO->Size;
+        fuOptions = pgO->Options;
+
+        /* The string, followed by the optional Dx array, has to be inside of the entry */
+        if ((cChars == 0) ||
+            (cChars > Size) ||
+            (cjDx > Size) ||
+            (FIELD_OFFSET(GDIBSTEXTOUT, String) +
+             ALIGN_UP_BY(cChars * sizeof(WCHAR), sizeof(INT)) + cjDx > Size) ||
+            (cjDx && (cjDx != cChars * sizeof(INT) * (fuOptions & ETO_PDY ? 2 : 1))))
+        {
+           DPRINT1("Invalid TextOut batch entry, %lu chars in %lu bytes\n", cChars, Size);
+           break;
+        }
+
+        /* Copy the string and the Dx array behind it */
+        cjString = ALIGN_UP_BY(cChars * sizeof(WCHAR), sizeof(INT));
+        pvBuffer = ExAllocatePoolWithTag(PagedPool, cjString + cjDx, GDITAG_TEXT);
+        if (!pvBuffer) break;
+
+        _SEH2_TRY
+        {
+           RtlCopyMemory(pvBuffer, pgO->String, cjString + cjDx);
+           Rect = *(PRECTL)&pgO->Rect;
+        }
+        _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
+        {
+           Status = _SEH2_GetExceptionCode();
+        }
+        _SEH2_END;
+
+        if (!NT_SUCCESS(Status))
+        {
+           ExFreePoolWithTag(pvBuffer, GDITAG_TEXT);
+           break;
+        }
+
+        if (cjDx) pDx = (LPINT)((PCHAR)pvBuffer + cjString);
+
+        GdiSaveBatchAttributes(pdcattr, &Saved);
+        pdcattr->hlfntNew        = pgO->hlfntNew;
+        pdcattr->crForegroundClr = pgO->crForegroundClr;
+        pdcattr->ulForegroundClr = pgO->ulForegroundClr;
+        pdcattr->crBackgroundClr = pgO->crBackgroundClr;
+        pdcattr->ulBackgroundClr = pgO->ulBackgroundClr;
+        pdcattr->lBkMode         = pgO->lmBkMode;
+        pdcattr->jBkMode         = (BYTE)pdcattr->lBkMode;
+        pdcattr->flTextAlign     = pgO->flTextAlign;
+        pdcattr->lTextAlign      = pdcattr->flTextAlign;
+        pdcattr->ulDirty_ |= DIRTY_TEXT | DIRTY_BACKGROUND;
+
+        /* GreExtTextOutW transforms the rectangle in place */
+        GreExtTextOutW(dc->BaseObject.hHmgr,
+                       pgO->x,
+                       pgO->y,
+                       fuOptions,
+                       &Rect,
+                       pvBuffer,
+                       cChars,
+                       pDx,
+                       0);
+
+        GdiRestoreBatchAttributes(pdcattr, &Saved);
+        ExFreePoolWithTag(pvBuffer, GDITAG_TEXT);
         break;
+     }
 
      case GdiBCExtTextOut:
+     {
+        PGDIBSEXTTEXTOUT pgO;
+        GDIBATCHATTR Saved;
+        RECTL Rect;
+
+        if (!dc || (Size < sizeof(GDIBSEXTTEXTOUT))) break;
+        pgO = (PGDIBSEXTTEXTOUT) pHdr;
+
+        /* Only the opaque rectangle fill, without a string, is batched */
+        if (pgO->Count != 0) break;
+        Rect = *(PRECTL)&pgO->Rect;
+
+        GdiSaveBatchAttributes(pdcattr, &Saved);
+        pdcattr->crBackgroundClr = pgO->ulBackgroundClr;
+        pdcattr->ulBackgroundClr = pgO->ulBackgroundClr;
+        pdcattr->ulDirty_ |= DIRTY_BACKGROUND;
+
+        GreExtTextOutW(dc->BaseObject.hHmgr,
+                       0,
+                       0,
+                       pgO->Options,
+                       &Rect,
+                       NULL,
+                       0,
+                       NULL,
+                       0);
+
+        GdiRestoreBatchAttributes(pdcattr, &Saved);
         break;
+     }
 
      case GdiBCSetBrushOrg:
      {
@@ -187,15 +469,18 @@ NtGdiFlushUserBatch(VOID)
        // No need to init anything, just go!
        for (; GdiBatchCount > 0; GdiBatchCount--)
        {
-           ULONG Size;
+           ULONG Size, cjLeft;
            // Process Gdi Batch!
-           Size = GdiFlushUserBatch(pDC, (PGDIBATCHHDR) pHdr);
+           cjLeft = GDIBATCHBUFSIZE - (ULONG)(pHdr - (PCHAR)&pTeb->GdiTebBatch.Buffer[0]);
+           Size = GdiFlushUserBatch(pDC, (PGDIBATCHHDR) pHdr, cjLeft);
            if (!Size) break;
            pHdr += Size;
        }
 
        if (pDC)
        {
+           // Batched drawing is done, gdi32 need not flush before changing modes.
+           pDC->pdcattr->ulDirty_ &= ~(DC_MODE_DIRTY|DC_FONTTEXT_DIRTY);
            DC_UnlockDc(pDC);
        }
 
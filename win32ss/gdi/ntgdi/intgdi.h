@@ -71,6 +71,24 @@ GreGradientFill(
     ULONG nMesh,
     ULONG ulMode);
 
+/* Blit functions */
+
+BOOL FASTCALL
+IntPatBlt(PDC pdc,
+          INT XLeft,
+          INT YLeft,
+          INT Width,
+          INT Height,
+          DWORD dwRop,
+          PEBRUSHOBJ pebo);
+
+BOOL FASTCALL
+IntGdiPolyPatBlt(HDC hDC,
+                 DWORD dwRop,
+                 PPATRECT pRects,
+                 INT cRects,
+                 ULONG Reserved);
+
 /* DC functions */
 
 HDC FASTCALL